@@ -2,18 +2,19 @@
 #pragma once
 
 #include <string>
-#include <cmath>    // ѧ
-#include <limits>   // ֵ
-#include <compare>  // C++20·Ƚ<=>
-#include <vector>   // ڴ洢ļȡAABB
+#include <cmath>    // 用于数学函数
+#include <limits>   // 用于数值极限
+#include <compare>  // 用于C++20的三路比较运算符<=>
+#include <vector>   // 用于存储从文件读取的AABB
+#include <algorithm> // 用于 std::min / std::max
 
-// 3DռеĵĽṹ
+// 代表3D空间中的点或向量的结构体
 struct Struct3D {
     float x = 0.0f;
     float y = 0.0f;
     float z = 0.0f;
 
-    // Է
+    // 重载运算符以方便进行向量运算
     Struct3D& operator+=(const Struct3D& other) {
         x += other.x; y += other.y; z += other.z;
         return *this;
@@ -31,10 +32,10 @@ struct Struct3D {
     Struct3D operator*(float scalar) const {
         return { x * scalar, y * scalar, z * scalar };
     }
-    // C++20·Ƚ
+    // C++20三路比较运算符
     auto operator<=>(const Struct3D&) const = default;
 
-    // Struct3DǷ㹻ӽ (ʤж)
+    // 检查两个Struct3D是否足够接近 (用于胜利条件判断)
     bool IsCloseTo(const Struct3D& other, float tolerance = 0.5f) const {
         return std::abs(x - other.x) < tolerance &&
             std::abs(y - other.y) < tolerance &&
@@ -42,25 +43,25 @@ struct Struct3D {
     }
 };
 
-// ҵ״̬
+// 代表玩家的物理状态
 class PlayerState {
 public:
-    Struct3D pos = { 0.0f, 0.5f, 0.0f }; // ʼλãԸڵ
-    Struct3D velocity = { 0.0f, 0.0f, 0.0f }; // ʼٶ
-    bool isInAir = true; // ʼ״̬Ϊڿ
-    bool hasWon = false; // Ƿʤ
+    Struct3D pos = { 0.0f, 0.5f, 0.0f }; // 初始位置，略高于地面
+    Struct3D velocity = { 0.0f, 0.0f, 0.0f }; // 初始速度
+    bool isInAir = true; // 初始状态视为在空中
+    bool hasWon = false; // 玩家是否已胜利
 };
 
-// ڵǰ֡ͼ
+// 代表玩家在当前帧的输入意图
 struct PlayerInputState {
     bool moveForward = false;
     bool moveBackward = false;
     bool moveLeft = false;
     bool moveRight = false;
-    bool jumpPressed = false; // Ծµһ֡Ϊ true
+    bool jumpPressed = false; // 仅在跳跃键被按下的那一帧为 true
 };
 
-// Ϸ
+// 游戏常量定义
 namespace GameConstants {
     constexpr float GRAVITY = 9.81f * 2.0f;
     constexpr float MOVE_SPEED = 5.0f;
@@ -70,17 +71,17 @@ namespace GameConstants {
     constexpr float PLAYER_HEIGHT = 1.0f;
     constexpr float PLAYER_WIDTH = 1.0f;
     constexpr float PLAYER_DEPTH = 1.0f;
-    const std::string DEFAULT_MAP_FILE = "map.txt"; // Ĭϵͼļ
+    const std::string DEFAULT_MAP_FILE = "map.txt"; // 默认地图文件名
 }
 
-// һΧеĽṹ
+// 代表一个轴对齐包围盒的结构体
 struct AABB {
     Struct3D min;
     Struct3D max;
     auto operator<=>(const AABB&) const = default;
 };
 
-// ĵͳߴ紴һ AABB
+// 辅助函数：根据中心点和尺寸创建一个 AABB
 inline AABB CreateAABB(const Struct3D& center, const Struct3D& size) {
     Struct3D halfSize = size * 0.5f;
     return {
@@ -89,7 +90,7 @@ inline AABB CreateAABB(const Struct3D& center, const Struct3D& size) {
     };
 }
 
-// ״̬ȡ䵱ǰAABB
+// 辅助函数：根据玩家状态获取其当前AABB
 inline AABB GetPlayerAABB(const PlayerState& state) {
     Struct3D playerCenter = {
         state.pos.x,
@@ -104,9 +105,21 @@ inline AABB GetPlayerAABB(const PlayerState& state) {
     return CreateAABB(playerCenter, playerSize);
 }
 
-// ¼˵ͼݽṹϰʤ
-struct MapData {
-    std::vector<AABB> obstacles;
-    Struct3D victoryPoint;
-    bool loadedSuccessfully = false;
-};
\ No newline at end of file
+// 辅助函数：两个 AABB 的并集包围盒
+inline AABB MergeAABB(const AABB& a, const AABB& b) {
+    return {
+        {std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)},
+        {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z)}
+    };
+}
+
+// 辅助函数：将 AABB 向各方向扩展 margin
+inline AABB ExpandAABB(const AABB& box, const Struct3D& margin) {
+    return { box.min - margin, box.max + margin };
+}
+
+// 辅助函数：outer 是否完全包含 inner
+inline bool ContainsAABB(const AABB& outer, const AABB& inner) {
+    return inner.min.x >= outer.min.x && inner.min.y >= outer.min.y && inner.min.z >= outer.min.z &&
+        inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
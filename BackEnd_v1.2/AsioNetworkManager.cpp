@@ -1,14 +1,84 @@
 #include "AsioNetworkManager.h"
 #include "GameHandler.h"
 #include "messages.pb.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#ifdef __linux__
+#include <unistd.h> // dup
+#endif
 
-// 캯ʵ
+namespace {
+    // io_uring 完成项的 user_data：发送为发送缓冲区下标，多发接收用这个标记
+    constexpr uint64_t URING_RECV_TAG = UINT64_MAX;
+    constexpr uint16_t URING_RECV_BUFFER_GROUP = 0;
+#ifdef __linux__
+    static_assert(sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in6) <= URING_RECV_HEADER_SPACE,
+        "io_uring receive buffers must fit the recvmsg header and source address");
+#endif
+
+    // 数据包十六进制转储的最大字节数，超出部分省略
+    constexpr size_t HEX_DUMP_MAX_BYTES = 64;
+
+    // 把 data 的前若干字节格式化为 "0a 1b ..."，写入 out（以'\0'结尾）
+    void FormatHexDump(std::span<const char> data, char* out, size_t outSize) {
+        static const char digits[] = "0123456789abcdef";
+        size_t length = 0;
+        for (size_t i = 0; i < data.size() && i < HEX_DUMP_MAX_BYTES && length + 4 <= outSize; ++i) {
+            unsigned char byte = static_cast<unsigned char>(data[i]);
+            out[length++] = digits[byte >> 4];
+            out[length++] = digits[byte & 0x0F];
+            out[length++] = ' ';
+        }
+        out[length] = '\0';
+    }
+
+    // 在 arena 上创建消息；旧版本 protobuf 的 Arena::Create 不会把 arena 传给消息，需要用 CreateMessage
+    template <typename Message>
+    Message* CreateArenaMessage(google::protobuf::Arena* arena) {
+#if GOOGLE_PROTOBUF_VERSION >= 4022000
+        return google::protobuf::Arena::Create<Message>(arena);
+#else
+        return google::protobuf::Arena::CreateMessage<Message>(arena);
+#endif
+    }
+
+    std::string EndpointString(const asio::ip::udp::endpoint& endpoint) {
+        return endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+    }
+}
+
+// 构造函数实现
 AsioNetworkManager::AsioNetworkManager(asio::io_context& io_context, short port, GameHandler& game_handler)
+    : AsioNetworkManager(io_context, port, std::vector<NetworkRoom>{ { 0, &game_handler } }) {
+}
+
+AsioNetworkManager::AsioNetworkManager(asio::io_context& io_context, short port, std::vector<NetworkRoom> rooms, bool reuse_port)
     : io_context_(io_context),
-    socket_(io_context), // ȹsocket
-    game_handler_(game_handler),
-    is_initialized_(false) // ʼΪδʼ
+    socket_(io_context), // 先构造socket，但不立即打开
+    rooms_(std::move(rooms)),
+    is_initialized_(false), // 初始为未初始化
+    room_session_counts_(rooms_.size()),
+    room_slots_(rooms_.size()),
+    joined_slots_(rooms_.size()),
+    broadcast_slots_(rooms_.size()),
+    client_codecs_(rooms_.size()),
+    room_quantization_(rooms_.size()),
+    broadcast_stats_(rooms_.size()),
+    session_sweep_timer_(io_context)
 {
+    if (rooms_.empty()) {
+        throw std::invalid_argument("AsioNetworkManager needs at least one room");
+    }
+    for (uint32_t i = 0; i < SEND_BUFFER_COUNT; ++i) {
+        free_send_buffers_[i] = i;
+    }
+    free_send_buffer_count_ = SEND_BUFFER_COUNT;
+
     asio::ip::udp::endpoint endpoint(asio::ip::udp::v4(), port);
     asio::error_code ec;
 
@@ -17,20 +87,32 @@ AsioNetworkManager::AsioNetworkManager(asio::io_context& io_context, short port,
         throw std::runtime_error("Failed to open UDP socket: " + ec.message());
     }
 
-    // SO_REUSEADDRѡʱõַ
-    // ڿͲԽ׶ηǳãԱ"Address already in use"
-    // ע⣺УǷҪѡȡھ
+    // 设置SO_REUSEADDR选项，允许快速重启服务器时重用地址
+    // 这对于开发和测试阶段非常有用，可以避免"Address already in use"错误
+    // 注意：在生产环境中，是否需要此选项取决于具体需求
     socket_.set_option(asio::socket_base::reuse_address(true), ec);
     if (ec) {
-        // ѡʧܣѡ¼棬һ
-        std::cerr << "[Network] Warning: Failed to set reuse_address option: " << ec.message() << std::endl;
+        // 如果设置选项失败，可以选择记录警告，但不一定是致命错误
+        LOG_WARN("[Network] Warning: Failed to set reuse_address option: %s", ec.message().c_str());
+    }
+
+    // SO_REUSEPORT：多个分片的套接字绑定同一端口，内核按客户端地址把数据报稳定地分给其中一个
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        socket_.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true), ec);
+        if (ec) {
+            throw std::runtime_error("Failed to set SO_REUSEPORT: " + ec.message());
+        }
+#else
+        throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+#endif
     }
 
 
     socket_.bind(endpoint, ec);
     if (ec) {
-        // ʧܣرsocket׳쳣
-        socket_.close(); // ȷsocketر
+        // 如果绑定失败，关闭socket并抛出异常
+        socket_.close(); // 确保socket被关闭
         if (ec == asio::error::address_in_use) {
             throw std::runtime_error("UDP Port " + std::to_string(port) + " is already in use.");
         }
@@ -39,42 +121,90 @@ AsioNetworkManager::AsioNetworkManager(asio::io_context& io_context, short port,
         }
     }
 
-    is_initialized_ = true; // ʼɹ
-    std::cout << "[Network] Asio UDP Socket created and successfully bound to port " << port << "." << std::endl;
+    // 套接字设为非阻塞：广播的同步发送（发送缓冲区池用尽时）在内核发送缓冲区满时立即返回 would_block 而不是阻塞主循环
+    // 只影响同步操作，异步收发不受影响
+    socket_.non_blocking(true, ec);
+    if (ec) {
+        LOG_WARN("[Network] Warning: Failed to make the socket non-blocking: %s", ec.message().c_str());
+    }
+
+    is_initialized_ = true; // 初始化成功
+    LOG_INFO("[Network] Asio UDP Socket created and successfully bound to port %d.", static_cast<int>(port));
 }
 
 
-// յԭʼ (˺л GameHandler)
-// ݽϷ߼
-void AsioNetworkManager::ProcessReceivedData(const std::string& data, const asio::ip::udp::endpoint& sender_endpoint) {
-    std::cout << "[Network] ProcessReceivedData ENTERED. Data length: " << data.length() << ", Received from: " << sender_endpoint << std::endl;
-    std::cout << "[Network] Raw data (hex): ";
-    for (size_t i = 0; i < data.length(); ++i) {
-        std::cout << std::hex << std::setw(2) << std::setfill('0') << (static_cast<int>(data[i]) & 0xFF) << " ";
+// 处理接收到的原始数据 (此函数将反序列化并调用 GameHandler)
+// 将网络层的数据接收与游戏逻辑处理解耦
+// data 直接指向接收缓冲区池中的数据报，只在本次调用期间有效
+void AsioNetworkManager::ProcessReceivedData(std::span<const char> data, const asio::ip::udp::endpoint& sender_endpoint) {
+    // 逐包日志只在 Debug 级别输出；关闭时只剩一次原子读取，参数（转储、端点字符串）都不会求值
+    if (LOG_ENABLED(LogLevel::Debug)) {
+        char hexDump[HEX_DUMP_MAX_BYTES * 3 + 1];
+        FormatHexDump(data, hexDump, sizeof(hexDump));
+        LOG_DEBUG_RATE(50, "[Network] Received %zu bytes from %s, raw data (hex): %s%s", data.size(),
+            EndpointString(sender_endpoint).c_str(), hexDump, data.size() > HEX_DUMP_MAX_BYTES ? "..." : "");
     }
-    std::cout << std::dec << std::endl; // ָʮ
-    std::cout << "[Network] ProcessReceivedData: Exiting safely (after basic cout)." << std::endl; // ˳
-    game_backend::ClientToServer client_msg; //  Protobuf Ϣ
-    std::cout << "[Network] Received " << data.length() << " bytes from " << sender_endpoint << std::endl;
-    
-    
-    // ԴӽյĶ (std::string) Ϣ
-    if (!client_msg.ParseFromString(data)) {
-        std::cerr << "[Network] Error: Failed to parse message from "
-            << sender_endpoint.address().to_string() << ":" << sender_endpoint.port() << std::endl;
+    // 创建 Protobuf 消息对象
+    // 消息分配在以 parse_arena_block_ 为初始块的栈上 Arena 中：oneof 子消息等也都落在这块内存里，
+    // 每个数据包的解析不产生堆分配；Arena 析构时整体丢弃
+    google::protobuf::ArenaOptions arena_options;
+    arena_options.initial_block = parse_arena_block_.data();
+    arena_options.initial_block_size = parse_arena_block_.size();
+    google::protobuf::Arena arena(arena_options);
+    auto& client_msg = *CreateArenaMessage<game_backend::ClientToServer>(&arena);
+
+    // 快照协议的数据包（差量快照的确认、编码请求）以 SNAPSHOT_PACKET_MAGIC 开头，不是 protobuf 消息
+    std::optional<uint32_t> snapshot_ack;
+    std::optional<StateCodec> codec_request;
+    if (IsSnapshotPacket(data)) {
+        snapshot_ack = ParseSnapshotAck(data);
+        if (!snapshot_ack) {
+            codec_request = ParseCodecRequest(data);
+        }
+        if (!snapshot_ack && !codec_request) {
+            LOG_ERROR_RATE(10, "[Network] Error: Malformed snapshot packet from %s", EndpointString(sender_endpoint).c_str());
+            return;
+        }
+    }
+    // 直接从接收缓冲区解析填充消息对象，不先复制成 std::string
+    else if (!client_msg.ParseFromArray(data.data(), static_cast<int>(data.size()))) {
+        LOG_ERROR_RATE(10, "[Network] Error: Failed to parse message from %s", EndpointString(sender_endpoint).c_str());
         return;
     }
     
-    // ɹ󣬿԰ȫΪ sender_endpoint һ¼Դ
-    last_valid_sender_endpoint_ = sender_endpoint;
+    // 成功解析后，可以安全地认为 sender_endpoint 是一个客户端：找到它的会话，第一次出现时新建
+    ClientSession* session = sessions_.Find(sender_endpoint);
+    if (session == nullptr) {
+        session = OpenSession(sender_endpoint);
+        if (session == nullptr) {
+            return;
+        }
+    }
+    session->lastReceiveTime = std::chrono::steady_clock::now();
+    ++session->packetsReceived;
+    session->bytesReceived += data.size();
+    received_packets_.store(received_packets_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
-    std::cout << "[Network] Parsed message successfully. DebugString: " << client_msg.DebugString() << std::endl;
+    if (snapshot_ack || codec_request) {
+        // 确认和编码请求交给模拟一侧：protobuf 客户端的第一次确认把它切换为差量快照
+        NetworkEvent event;
+        event.type = snapshot_ack ? NetworkEvent::Type::Ack : NetworkEvent::Type::CodecRequest;
+        event.room = session->room;
+        event.slot = session->playerSlot;
+        event.sequence = snapshot_ack.value_or(0);
+        event.codec = codec_request.value_or(StateCodec::Protobuf);
+        if (!DeliverEvent(event)) {
+            LOG_WARN_RATE(1, "[Network] Warning: Event queue full, dropped snapshot packet from session %u.", session->id);
+        }
+        return;
+    }
+
+    LOG_DEBUG_RATE(50, "[Network] Parsed message successfully: %s", client_msg.ShortDebugString().c_str());
     
-    //  'oneof' оϢ
+    // 检查 'oneof' 负载中具体是哪种消息类型
     if (client_msg.has_input()) {
         const game_backend::PlayerInput& input_payload = client_msg.input();
-        std::cout << "[Network] Message has input payload." << std::endl;
-        //  Protobuf ṹ תΪ ڲʹõ PlayerInputState ṹ
+        // 将 Protobuf 的输入结构 转换为 我们内部使用的 PlayerInputState 结构
         PlayerInputState input_state;
         input_state.moveForward = input_payload.move_forward();
         input_state.moveBackward = input_payload.move_backward();
@@ -82,84 +212,853 @@ void AsioNetworkManager::ProcessReceivedData(const std::string& data, const asio
         input_state.moveRight = input_payload.move_right();
         input_state.jumpPressed = input_payload.jump_pressed();
 
-        // ṹݴݸ GameHandler д
-        game_handler_.ProcessInput(input_state);
+        // 将结构化的输入数据传递给 GameHandler，作用于该客户端的玩家（网络线程模式下经事件队列转交）
+        NetworkEvent event;
+        event.type = NetworkEvent::Type::Input;
+        event.room = session->room;
+        event.slot = session->playerSlot;
+        event.input = input_state;
+        if (!DeliverEvent(event)) {
+            LOG_WARN_RATE(1, "[Network] Warning: Event queue full, dropped input from session %u.", session->id);
+        }
 
     }
     else if (client_msg.has_event()) {
         const game_backend::GameEvent& event_payload = client_msg.event();
-        std::cout << "[Network] Message has event payload: " << event_payload.type() << std::endl;
+        LOG_INFO("[Network] Message has event payload: %d", static_cast<int>(event_payload.type()));
     } else {
-        // յδ֪ĻյϢ
-        std::cerr << "[Network] Warning: Received unknown or empty message type from client "
-            << sender_endpoint.address().to_string() << ":" << sender_endpoint.port() << std::endl;
+        // 收到了未知的或空的消息类型
+        LOG_WARN_RATE(10, "[Network] Warning: Received unknown or empty message type from client %s",
+            EndpointString(sender_endpoint).c_str());
     }
 }
 
 void AsioNetworkManager::StartReceive() {
-    auto self = weak_from_this(); // ʹweak_ptrȷȫ
+#ifdef __linux__
+    if (uring_) {
+        StartUringReceive();
+        if (int result = uring_->Submit(); result < 0) {
+            LOG_ERROR("[Network] io_uring_enter error: %s", std::strerror(-result));
+        }
+        WaitUring();
+        return;
+    }
+    if (batched_io_) {
+        receive_pool_.assign(RECV_BATCH_SIZE * RECV_BUFFER_SIZE, 0);
+        StartBatchedReceive();
+        return;
+    }
+#endif
+    // 同时投递 receive_depth_ 个接收，各用池中的一个缓冲区和一个端点
+    receive_pool_.assign(receive_depth_ * RECV_BUFFER_SIZE, 0);
+    receive_endpoints_.assign(receive_depth_, asio::ip::udp::endpoint());
+    for (size_t slot = 0; slot < receive_depth_; ++slot) {
+        StartAsyncReceive(slot);
+    }
+}
+
+void AsioNetworkManager::StartAsyncReceive(size_t slot) {
+    auto self = weak_from_this(); // 使用weak_ptr确保安全
     socket_.async_receive_from(
-        asio::buffer(receive_buffer_),
-        remote_endpoint_,
-        [this, self](const asio::error_code& error, std::size_t bytes_transferred) {
-            if (auto shared_self = self.lock()) { // ǷȻ
-                HandleReceive(error, bytes_transferred);
+        asio::buffer(ReceiveBuffer(slot), RECV_BUFFER_SIZE),
+        receive_endpoints_[slot],
+        [this, self, slot](const asio::error_code& error, std::size_t bytes_transferred) {
+            if (auto shared_self = self.lock()) { // 检查对象是否仍然存在
+                HandleReceive(slot, error, bytes_transferred);
             }
         });
 }
 
+void AsioNetworkManager::SetReceiveDepth(size_t depth) {
+    receive_depth_ = std::clamp<size_t>(depth, 1, MAX_RECV_DEPTH);
+}
+
+size_t AsioNetworkManager::MemoryFootprint() const {
+    return sizeof(AsioNetworkManager) + receive_pool_.capacity() + receive_endpoints_.capacity() * sizeof(asio::ip::udp::endpoint);
+}
+
 void AsioNetworkManager::SendTo(const std::string& message, const asio::ip::udp::endpoint& target_endpoint) {
-    auto self = weak_from_this();
-    auto message_data = std::make_shared<std::string>(message); // ȷϢ첽ǰЧ
+    if (message.size() > SEND_BUFFER_SIZE) {
+        LOG_ERROR_RATE(1, "[Network] Error: Message of %zu bytes exceeds send buffer size %zu, dropped.", message.size(), SEND_BUFFER_SIZE);
+        return;
+    }
+    SendWith(target_endpoint, [&message](std::span<char> buffer) {
+        std::memcpy(buffer.data(), message.data(), message.size());
+        return message.size();
+    });
+}
 
-    socket_.async_send_to(
-        asio::buffer(*message_data),
-        target_endpoint,
-        [this, self, message_data](const asio::error_code& error, std::size_t /*bytes_transferred*/) {
+std::optional<uint32_t> AsioNetworkManager::AcquireSendBuffer() {
+    if (free_send_buffer_count_ == 0) {
+        // 在途发送过多（例如发送速度跟不上），丢弃本次数据报而不是分配新缓冲区
+        LOG_WARN_RATE(1, "[Network] Warning: All %zu send buffers in flight, dropping datagram.", SEND_BUFFER_COUNT);
+        return std::nullopt;
+    }
+    return free_send_buffers_[--free_send_buffer_count_];
+}
+
+void AsioNetworkManager::ReleaseSendBuffer(uint32_t index) {
+    free_send_buffers_[free_send_buffer_count_++] = index;
+}
+
+void AsioNetworkManager::SubmitSendBuffer(uint32_t index, size_t size, const asio::ip::udp::endpoint& target_endpoint) {
+#ifdef __linux__
+    if (uring_) {
+        // io_uring 模式：排进提交队列，FlushSends 时一次提交并归还缓冲区
+        send_endpoints_[index] = target_endpoint;
+        send_iovecs_[index] = { send_buffers_[index].data(), size };
+        msghdr& header = send_msgs_[index].msg_hdr;
+        header = {};
+        header.msg_name = send_endpoints_[index].data();
+        header.msg_namelen = static_cast<socklen_t>(send_endpoints_[index].size());
+        header.msg_iov = &send_iovecs_[index];
+        header.msg_iovlen = 1;
+        io_uring_sqe* sqe = uring_->GetSqe();
+        if (sqe == nullptr) {
+            FlushSends(); // 提交队列比发送缓冲区多得多，正常情况下不会发生
+            sqe = uring_->GetSqe();
+        }
+        if (sqe == nullptr) {
+            LOG_WARN_RATE(1, "[Network] Warning: io_uring submission queue full, dropping datagram.");
+            ReleaseSendBuffer(index);
+            return;
+        }
+        // MSG_DONTWAIT：缓冲区满时以 -EAGAIN 完成而不是挂起等待，提交返回时发送就已经结束；成功时不产生完成项
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = socket_.native_handle();
+        sqe->addr = reinterpret_cast<uint64_t>(&header);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_DONTWAIT;
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        sqe->user_data = index;
+        pending_sends_[pending_send_count_++] = index;
+        return;
+    }
+    if (batched_io_) {
+        // 批量模式：只登记到待发送队列，FlushSends 时一起发出
+        send_endpoints_[index] = target_endpoint;
+        send_iovecs_[index] = { send_buffers_[index].data(), size };
+        pending_sends_[pending_send_count_++] = index;
+        return;
+    }
+#endif
+    // 完成处理器：把缓冲区放回空闲链表，并让 asio 在该缓冲区附带的处理器内存中分配操作对象
+    struct SendCompletion {
+        using allocator_type = SendHandlerAllocator<char>;
+
+        AsioNetworkManager* manager;
+        std::weak_ptr<AsioNetworkManager> self;
+        uint32_t index;
+
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(manager->send_handler_memory_[index]);
+        }
+
+        void operator()(const asio::error_code& error, std::size_t /*bytes_transferred*/) const {
             if (auto shared_self = self.lock()) {
-                HandleSend(error);
+                manager->ReleaseSendBuffer(index); // 数据报已交给内核（或发送失败），缓冲区可以复用
+                manager->HandleSend(error);
             }
-        });
+        }
+    };
+
+    socket_.async_send_to(
+        asio::buffer(send_buffers_[index].data(), size),
+        target_endpoint,
+        SendCompletion{ this, weak_from_this(), index });
 }
 
 bool AsioNetworkManager::IsInitialized() const {
     return is_initialized_ && socket_.is_open();
 }
 
-std::optional<asio::ip::udp::endpoint> AsioNetworkManager::GetLastClientEndpoint() const {
-    return last_valid_sender_endpoint_;
+ClientSession* AsioNetworkManager::OpenSession(const asio::ip::udp::endpoint& endpoint) {
+    if (sessions_.Size() >= sessions_.Capacity()) {
+        LOG_WARN_RATE(1, "[Network] Warning: Session table full (%zu clients), ignoring %s",
+            sessions_.Capacity(), EndpointString(endpoint).c_str());
+        return nullptr;
+    }
+    // 分到会话最少的房间
+    uint32_t room = 0;
+    for (uint32_t r = 1; r < rooms_.size(); ++r) {
+        if (RoomSessionCount(r) < RoomSessionCount(room)) {
+            room = r;
+        }
+    }
+    // 分配槽位：主玩家槽位优先
+    RoomSlots& slots = room_slots_[room];
+    uint32_t slot;
+    if (!slots.primaryTaken) {
+        slot = GameHandler::PRIMARY_PLAYER_SLOT;
+    }
+    else if (!slots.freeSlots.empty()) {
+        slot = slots.freeSlots.back();
+    }
+    else {
+        slot = slots.nextSlot;
+    }
+    // 加入事件必须送达模拟，否则该客户端的输入和状态都无从对应；送不出去时本次不建立会话，客户端的下一个包会再试
+    NetworkEvent join;
+    join.type = NetworkEvent::Type::Join;
+    join.room = room;
+    join.slot = slot;
+    if (!DeliverEvent(join)) {
+        LOG_WARN_RATE(1, "[Network] Warning: Event queue full, deferring connection from %s", EndpointString(endpoint).c_str());
+        return nullptr;
+    }
+    if (slot == GameHandler::PRIMARY_PLAYER_SLOT) {
+        slots.primaryTaken = true;
+    }
+    else if (!slots.freeSlots.empty()) {
+        slots.freeSlots.pop_back();
+    }
+    else {
+        ++slots.nextSlot;
+    }
+    if (slots.endpoints.size() <= slot) {
+        slots.endpoints.resize(slot + 1);
+    }
+    slots.endpoints[slot] = endpoint;
+
+    ClientSession* session = sessions_.Insert(endpoint, slot);
+    session->room = room;
+    room_session_counts_[room].fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("[Network] Client %s connected as session %u (room %zu, player slot %u).",
+        EndpointString(endpoint).c_str(), session->id, rooms_[room].id, slot);
+    return session;
+}
+
+size_t AsioNetworkManager::ExpireIdleSessions(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration timeout) {
+    return sessions_.EraseIf(
+        [&](const ClientSession& session) {
+            if (now - session.lastReceiveTime <= timeout) {
+                return false;
+            }
+            // 离开事件送不出去（事件队列满）时保留会话，下次检查再试
+            NetworkEvent leave;
+            leave.type = NetworkEvent::Type::Leave;
+            leave.room = session.room;
+            leave.slot = session.playerSlot;
+            return DeliverEvent(leave);
+        },
+        [&](const ClientSession& session) {
+            LOG_INFO("[Network] Client %s (session %u) timed out after %llu packets (sent %llu states, %llu bytes).",
+                EndpointString(session.endpoint).c_str(), session.id, static_cast<unsigned long long>(session.packetsReceived),
+                static_cast<unsigned long long>(session.packetsSent), static_cast<unsigned long long>(session.bytesSent));
+            room_session_counts_[session.room].fetch_sub(1, std::memory_order_relaxed);
+            RoomSlots& slots = room_slots_[session.room];
+            slots.endpoints[session.playerSlot] = asio::ip::udp::endpoint();
+            if (session.playerSlot == GameHandler::PRIMARY_PLAYER_SLOT) {
+                slots.primaryTaken = false; // 主玩家槽位始终保留，交给下一个连接的客户端
+            }
+            else {
+                slots.freeSlots.push_back(session.playerSlot);
+            }
+        });
+}
+
+void AsioNetworkManager::StartSessionSweep() {
+    auto self = weak_from_this();
+    session_sweep_timer_.expires_after(std::chrono::seconds(1));
+    session_sweep_timer_.async_wait([this, self](const asio::error_code& error) {
+        auto shared_self = self.lock();
+        if (!shared_self || error == asio::error::operation_aborted) {
+            return;
+        }
+        ExpireIdleSessions(std::chrono::steady_clock::now(), CLIENT_SESSION_TIMEOUT);
+        StartSessionSweep();
+    });
+}
+
+void AsioNetworkManager::SetNetworkThread(bool enabled) {
+    if (enabled) {
+        inbound_events_ = std::make_unique<SpscQueue<NetworkEvent>>(NETWORK_EVENT_QUEUE_SIZE);
+        outbound_snapshots_ = std::make_unique<SpscQueue<StateSnapshot>>(SNAPSHOT_QUEUE_SIZE);
+    }
+    else {
+        inbound_events_.reset();
+        outbound_snapshots_.reset();
+    }
+}
+
+bool AsioNetworkManager::DeliverEvent(const NetworkEvent& event) {
+    if (inbound_events_) {
+        return inbound_events_->TryPush(event);
+    }
+    ApplyEvent(event);
+    return true;
+}
+
+void AsioNetworkManager::ApplyEvent(const NetworkEvent& event) {
+    GameHandler& game = *rooms_[event.room].game;
+    std::vector<uint32_t>& joined = joined_slots_[event.room];
+    switch (event.type) {
+    case NetworkEvent::Type::Join:
+        game.AddPlayerAt(event.slot);
+        joined.push_back(event.slot);
+        // 槽位可能被之前的客户端用过：广播进度从头开始，新客户端立即收到一次状态
+        if (broadcast_slots_[event.room].size() <= event.slot) {
+            broadcast_slots_[event.room].resize(event.slot + 1);
+        }
+        broadcast_slots_[event.room][event.slot] = BroadcastSlot{};
+        if (client_codecs_[event.room].size() <= event.slot) {
+            client_codecs_[event.room].resize(event.slot + 1);
+        }
+        client_codecs_[event.room][event.slot] = ClientCodec{};
+        break;
+    case NetworkEvent::Type::Leave:
+        game.RemovePlayer(event.slot); // 主玩家槽位不会被移除
+        joined.erase(std::remove(joined.begin(), joined.end(), event.slot), joined.end());
+        break;
+    case NetworkEvent::Type::Input:
+        game.ProcessInput(event.slot, event.input);
+        break;
+    case NetworkEvent::Type::Ack: {
+        ClientCodec& codec = client_codecs_[event.room][event.slot];
+        if (codec.codec == StateCodec::Protobuf) {
+            // 切换格式：把广播进度当作还没发过，立即发出第一份（完整）快照
+            codec = ClientCodec{};
+            codec.codec = StateCodec::Delta;
+            broadcast_slots_[event.room][event.slot].hasSent = false;
+        }
+        else if (codec.codec == StateCodec::Delta) {
+            codec.delta.Acknowledge(event.sequence);
+        }
+        break;
+    }
+    case NetworkEvent::Type::CodecRequest:
+        // 重新协商（包括再次请求同一种编码）都从头开始：差量快照从完整快照开始，量化编码重新附带量化框架
+        client_codecs_[event.room][event.slot] = ClientCodec{};
+        client_codecs_[event.room][event.slot].codec = event.codec;
+        broadcast_slots_[event.room][event.slot].hasSent = false;
+        break;
+    }
+}
+
+size_t AsioNetworkManager::DrainEvents() {
+    size_t applied = 0;
+    while (NetworkEvent* event = inbound_events_->Front()) {
+        ApplyEvent(*event);
+        inbound_events_->Pop();
+        ++applied;
+    }
+    return applied;
+}
+
+void AsioNetworkManager::BroadcastStates(std::chrono::steady_clock::time_point now) {
+    bool published = false;
+    for (uint32_t room = 0; room < rooms_.size(); ++room) {
+        const GameHandler& game = *rooms_[room].game;
+        BroadcastStats& stats = broadcast_stats_[room];
+        // 只统计有客户端到了发送时间的调用：主循环空转时每次调用都只是逐个比较发送时间
+        std::optional<std::chrono::steady_clock::time_point> start;
+        // 遍历期间不执行 io_context 上的处理器（见 SendState），加入、离开和输入都不会在这里改变房间
+        for (const uint32_t slot : joined_slots_[room]) {
+            const PlayerState state = game.GetPlayerState(slot);
+            const BroadcastScheduler::Decision decision = broadcast_scheduler_.Decide(broadcast_slots_[room][slot], state, now);
+            if (decision == BroadcastScheduler::Decision::Wait) {
+                continue;
+            }
+            if (!start) {
+                start = std::chrono::steady_clock::now();
+            }
+            if (decision == BroadcastScheduler::Decision::Unchanged) {
+                ++stats.skippedUnchanged;
+                continue;
+            }
+            const size_t size = outbound_snapshots_ ? PublishSnapshot(room, slot, state) : SendState(room, slot, state);
+            if (size == 0) {
+                continue; // 没有发出去：不记为已发送，下次调用再试
+            }
+            published = true;
+            broadcast_scheduler_.MarkSent(broadcast_slots_[room][slot], state, now);
+            ++stats.sent;
+            stats.eventSent += decision == BroadcastScheduler::Decision::Event;
+            const ClientCodec& codec = client_codecs_[room][slot];
+            stats.deltaSent += codec.codec == StateCodec::Delta && codec.delta.LastWasDelta();
+            stats.bytes += size;
+        }
+        if (start) {
+            stats.cpuUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - *start).count();
+        }
+    }
+
+    if (!outbound_snapshots_) {
+        // 批量模式下本次的数据报在这里用一次 sendmmsg 发出
+        FlushSends();
+        return;
+    }
+    if (!published) {
+        return;
+    }
+    // 唤醒网络线程。同一时刻最多只有一个尚未执行的 SendSnapshots，它使用固定的处理器内存，投递不分配
+    if (!snapshot_flush_posted_.exchange(true, std::memory_order_acq_rel)) {
+        struct SnapshotFlush {
+            using allocator_type = SendHandlerAllocator<char>;
+
+            AsioNetworkManager* manager;
+            std::weak_ptr<AsioNetworkManager> self;
+
+            allocator_type get_allocator() const noexcept {
+                return allocator_type(manager->snapshot_flush_memory_);
+            }
+
+            void operator()() const {
+                if (auto shared_self = self.lock()) {
+                    manager->SendSnapshots();
+                }
+            }
+        };
+        asio::post(io_context_, SnapshotFlush{ this, weak_from_this() });
+    }
+}
+
+BroadcastStats AsioNetworkManager::TakeBroadcastStats(size_t room) {
+    return std::exchange(broadcast_stats_[room], BroadcastStats{});
 }
 
-void AsioNetworkManager::HandleReceive(const asio::error_code& error, std::size_t transdBytes) {
+size_t AsioNetworkManager::WriteState(uint32_t room, uint32_t slot, const PlayerState& state, std::span<char> out) {
+    ClientCodec& codec = client_codecs_[room][slot];
+    switch (codec.codec) {
+    case StateCodec::Delta:
+        return codec.delta.Encode(state, out);
+    case StateCodec::Quantized: {
+        // 关卡范围变化时重新生成量化框架；客户端还没收到当前框架时随数据报附带
+        RoomQuantization& quantization = room_quantization_[room];
+        const AABB bounds = rooms_[room].game->LevelBounds();
+        if (quantization.bounds != bounds) {
+            quantization.frame = MakeQuantizationFrame(bounds);
+            quantization.id = quantization.bounds ? static_cast<uint8_t>(quantization.id + 1) : 0;
+            quantization.bounds = bounds;
+        }
+        const bool includeFrame = !codec.frameSent || codec.frameId != quantization.id;
+        // 只发送该客户端自己的玩家，与 protobuf 的 ServerToClient 相同
+        const QuantizedEntity entity{ slot, state };
+        const size_t size = EncodeQuantizedSnapshot(quantization.id, quantization.frame, includeFrame,
+            std::span<const QuantizedEntity>(&entity, 1), out);
+        if (size != 0 && includeFrame) {
+            codec.frameSent = true;
+            codec.frameId = quantization.id;
+        }
+        return size;
+    }
+    case StateCodec::Protobuf:
+        break;
+    }
+    return rooms_[room].game->SerializeStateTo(slot, out);
+}
+
+size_t AsioNetworkManager::SendState(uint32_t room, uint32_t slot, const PlayerState& state) {
+    const RoomSlots& slots = room_slots_[room];
+    if (slot >= slots.endpoints.size() || slots.endpoints[slot].port() == 0) {
+        return 0;
+    }
+    const asio::ip::udp::endpoint& endpoint = slots.endpoints[slot];
+    // 发送缓冲区用尽（客户端很多）时先发出已排队的数据报：批量和 io_uring 模式下缓冲区随之归还
+    if (FreeSendBufferCount() == 0) {
+        FlushSends();
+    }
+    size_t size = 0;
+    bool sent = false;
+    if (FreeSendBufferCount() == 0) {
+        // 异步模式下缓冲区要等发送完成处理器执行后才归还，而这里不能执行处理器：
+        // 序列化到溢出缓冲区后同步发送（套接字是非阻塞的，内核发送缓冲区满时丢弃，下次调用再试）
+        size = WriteState(room, slot, state, overflow_send_buffer_);
+        if (size != 0) {
+            asio::error_code error;
+            socket_.send_to(asio::buffer(overflow_send_buffer_.data(), size), endpoint, 0, error);
+            if (error == asio::error::would_block) {
+                LOG_WARN_RATE(1, "[Network] Warning: Socket send buffer full, dropped datagram.");
+                return 0;
+            }
+            sent = !error;
+        }
+    }
+    else {
+        sent = SendWith(endpoint, [&](std::span<char> buffer) {
+            size = WriteState(room, slot, state, buffer);
+            return size;
+        });
+    }
+    if (!sent) {
+        // 序列化失败或发送缓冲区用尽，打印警告
+        LOG_WARN_RATE(1, "[Network] Warning: Failed to send state to %s.", EndpointString(endpoint).c_str());
+        return 0;
+    }
+    if (ClientSession* session = sessions_.Find(endpoint)) {
+        ++session->packetsSent;
+        session->bytesSent += size;
+    }
+    return size;
+}
+
+size_t AsioNetworkManager::PublishSnapshot(uint32_t room, uint32_t slot, const PlayerState& state) {
+    StateSnapshot* snapshot = outbound_snapshots_->BeginPush();
+    if (snapshot == nullptr) {
+        // 网络线程跟不上：这些客户端的状态留到下次再发
+        LOG_WARN_RATE(1, "[Network] Warning: Snapshot queue full, delaying state updates.");
+        return 0;
+    }
+    snapshot->room = room;
+    snapshot->slot = slot;
+    snapshot->size = static_cast<uint32_t>(WriteState(room, slot, state, std::span<char>(snapshot->data)));
+    if (snapshot->size == 0) {
+        return 0;
+    }
+    outbound_snapshots_->EndPush();
+    return snapshot->size;
+}
+
+void AsioNetworkManager::SendSnapshots() {
+    // 先清除标记再取队列：之后发布的快照一定会再投递一次
+    snapshot_flush_posted_.store(false, std::memory_order_release);
+    while (StateSnapshot* snapshot = outbound_snapshots_->Front()) {
+        if (FreeSendBufferCount() == 0) {
+            FlushSends();
+            if (FreeSendBufferCount() == 0) {
+                // 逐包异步发送时缓冲区要等发送完成处理才归还：稍后再继续（完成处理已排在前面）
+                if (!snapshot_flush_posted_.exchange(true, std::memory_order_acq_rel)) {
+                    auto self = weak_from_this();
+                    asio::post(io_context_, [this, self] {
+                        if (auto shared_self = self.lock()) {
+                            SendSnapshots();
+                        }
+                    });
+                }
+                return;
+            }
+        }
+        const RoomSlots& slots = room_slots_[snapshot->room];
+        // 快照生成之后客户端可能已经离开：槽位已空闲时丢弃
+        if (snapshot->slot < slots.endpoints.size() && slots.endpoints[snapshot->slot].port() != 0) {
+            const asio::ip::udp::endpoint& endpoint = slots.endpoints[snapshot->slot];
+            bool sent = SendWith(endpoint, [snapshot](std::span<char> buffer) {
+                std::memcpy(buffer.data(), snapshot->data.data(), snapshot->size);
+                return static_cast<size_t>(snapshot->size);
+            });
+            if (sent) {
+                if (ClientSession* session = sessions_.Find(endpoint)) {
+                    ++session->packetsSent;
+                    session->bytesSent += snapshot->size;
+                }
+            }
+        }
+        outbound_snapshots_->Pop();
+    }
+    FlushSends();
+}
+
+void AsioNetworkManager::HandleReceive(size_t slot, const asio::error_code& error, std::size_t transdBytes) {
     if (!error || error == asio::error::message_size) {
-        if (transdBytes > 0 && transdBytes <= receive_buffer_.size()) { // ӱ߽
-            // ȷ transdBytes  receive_buffer_ ʵʴС
-            std::string received_message(receive_buffer_.data(), transdBytes);
-            std::cout << "[Network] HandleReceive: transdBytes = " << transdBytes << std::endl; // Դӡ
-            ProcessReceivedData(received_message, remote_endpoint_);
+        if (transdBytes > 0 && transdBytes <= RECV_BUFFER_SIZE) { // 增加边界检查
+            // 确保 transdBytes 不超过接收缓冲区的实际大小
+            // 直接把接收缓冲区中的数据报交给解析，不复制
+            ProcessReceivedData(std::span<const char>(ReceiveBuffer(slot), transdBytes), receive_endpoints_[slot]);
         }
         else {
-            std::cerr << "[Network] Warning: Received 0 bytes." << std::endl;
+            LOG_WARN_RATE(10, "[Network] Warning: Received 0 bytes.");
         }
-        StartReceive(); // һϢ
+        StartAsyncReceive(slot); // 在同一个缓冲区上继续接收下一个消息
     }
     else if (error == asio::error::operation_aborted) {
-        std::cout << "[Network] Receive operation cancelled (socket likely closed)." << std::endl;
+        LOG_INFO("[Network] Receive operation cancelled (socket likely closed).");
     }
     else {
-        std::cerr << "[Network] Receive error: " << error.message() << " (Code: " << error.value() << ")" << std::endl;
-        // ڷ󣬳Լ
-        //  connection_reset Ĵ󣬶UDP˵ͨԺԲ
+        LOG_ERROR_RATE(10, "[Network] Receive error: %s (Code: %d)", error.message().c_str(), error.value());
+        // 对于非致命错误，尝试继续接收
+        // 如果是像 connection_reset 这样的错误，对于UDP来说通常可以忽略并继续
         if (error != asio::error::connection_reset) {
-            // ͵Ĵ󣬿ҪӵĴ߼
-            // Ϊ˼ȻԼ
+            // 对于其他类型的错误，可能需要更复杂的处理逻辑
+            // 但为了简单起见，我们仍然尝试继续接收
         }
-        StartReceive();
+        StartAsyncReceive(slot);
     }
 }
 
 void AsioNetworkManager::HandleSend(const asio::error_code& error) {
     if (error && error != asio::error::operation_aborted) {
-        std::cerr << "[Network] Send error: " << error.message() << std::endl;
+        LOG_ERROR_RATE(10, "[Network] Send error: %s", error.message().c_str());
+    }
+}
+
+void AsioNetworkManager::SetBatchedIo(bool enabled) {
+#ifdef __linux__
+    batched_io_ = enabled;
+#else
+    if (enabled) {
+        LOG_WARN("[Network] Warning: Batched I/O (recvmmsg/sendmmsg) is only available on Linux, using async I/O.");
+    }
+#endif
+}
+
+bool AsioNetworkManager::SetIoUring(bool enabled) {
+#ifdef __linux__
+    if (!enabled) {
+        uring_wait_.reset();
+        uring_.reset();
+        return true;
+    }
+    try {
+        auto uring = std::make_unique<IoUring>(URING_QUEUE_DEPTH);
+        // 注册后内核直接写这块内存，之后不能再重新分配（StartReceive 在 io_uring 模式下不动接收缓冲区池）
+        receive_pool_.assign(URING_RECV_BUFFER_COUNT * URING_RECV_BUFFER_SIZE, 0);
+        uring->RegisterBufferRing(URING_RECV_BUFFER_GROUP, receive_pool_, static_cast<uint32_t>(URING_RECV_BUFFER_SIZE),
+            static_cast<uint32_t>(URING_RECV_BUFFER_COUNT));
+        // asio 的描述符对象析构时会关闭 fd，因此交给它一个副本
+        const int waitFd = ::dup(uring->Fd());
+        if (waitFd < 0) {
+            throw std::system_error(errno, std::generic_category(), "dup");
+        }
+        uring_wait_.emplace(io_context_, waitFd);
+        uring_ = std::move(uring);
+    }
+    catch (const std::exception& e) {
+        LOG_WARN("[Network] Warning: io_uring unavailable (%s), using %s I/O.", e.what(), batched_io_ ? "batched" : "async");
+        return false;
+    }
+    uring_recv_msg_ = {};
+    uring_recv_msg_.msg_namelen = static_cast<socklen_t>(remote_endpoint_.capacity());
+    return true;
+#else
+    if (enabled) {
+        LOG_WARN("[Network] Warning: io_uring is only available on Linux, using %s I/O.", batched_io_ ? "batched" : "async");
+    }
+    return !enabled;
+#endif
+}
+
+bool AsioNetworkManager::IsIoUring() const {
+#ifdef __linux__
+    return uring_ != nullptr;
+#else
+    return false;
+#endif
+}
+
+uint64_t AsioNetworkManager::IoUringEnterCount() const {
+#ifdef __linux__
+    return uring_ ? uring_->EnterCount() : 0;
+#else
+    return 0;
+#endif
+}
+
+#ifdef __linux__
+void AsioNetworkManager::StartUringReceive() {
+    io_uring_sqe* sqe = uring_->GetSqe();
+    if (sqe == nullptr) {
+        FlushSends();
+        sqe = uring_->GetSqe();
+    }
+    if (sqe == nullptr) {
+        LOG_ERROR("[Network] Error: io_uring submission queue full, receive not armed.");
+        return;
+    }
+    // 多发 recvmsg：一次提交持续产生完成项，每个数据报由内核从缓冲区组中挑一个缓冲区写入
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket_.native_handle();
+    sqe->addr = reinterpret_cast<uint64_t>(&uring_recv_msg_);
+    sqe->len = 1;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_RECV_BUFFER_GROUP;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = URING_RECV_TAG;
+}
+
+void AsioNetworkManager::WaitUring() {
+    auto self = weak_from_this();
+    uring_wait_->async_wait(asio::posix::descriptor_base::wait_read, [this, self](const asio::error_code& error) {
+        auto shared_self = self.lock();
+        if (!shared_self) {
+            return;
+        }
+        if (error == asio::error::operation_aborted) {
+            LOG_INFO("[Network] Receive operation cancelled (socket likely closed).");
+            return;
+        }
+        if (error) {
+            LOG_ERROR_RATE(10, "[Network] Receive error: %s (Code: %d)", error.message().c_str(), error.value());
+        }
+        else {
+            ReapUring();
+        }
+        WaitUring();
+    });
+}
+
+void AsioNetworkManager::ReapUring() {
+    bool rearm = false;
+    uring_->ForEachCompletion([&](const io_uring_cqe& cqe) {
+        if (cqe.user_data != URING_RECV_TAG) {
+            // 只有失败的发送才有完成项，缓冲区在提交时已经归还
+            if (cqe.res == -EAGAIN) {
+                LOG_WARN_RATE(1, "[Network] Warning: Socket send buffer full, dropped datagram.");
+            }
+            else {
+                LOG_ERROR_RATE(10, "[Network] Send error: %s", std::strerror(-cqe.res));
+            }
+            return;
+        }
+        // 没有 IORING_CQE_F_MORE 表示内核结束了这次多发接收（例如缓冲区暂时全部在用），处理完已到达的之后重新提交
+        if ((cqe.flags & IORING_CQE_F_MORE) == 0) {
+            rearm = true;
+        }
+        if (cqe.res < 0) {
+            if (cqe.res != -ENOBUFS) {
+                LOG_ERROR_RATE(10, "[Network] recvmsg error: %s (Code: %d)", std::strerror(-cqe.res), -cqe.res);
+            }
+            return;
+        }
+        if ((cqe.flags & IORING_CQE_F_BUFFER) == 0) {
+            return;
+        }
+        const uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        HandleUringDatagram(uring_->Buffer(bufferId), static_cast<size_t>(cqe.res));
+        uring_->RecycleBuffer(bufferId);
+    });
+    if (rearm) {
+        StartUringReceive();
+        FlushSends();
+    }
+}
+
+void AsioNetworkManager::HandleUringDatagram(const char* buffer, size_t size) {
+    const size_t headerSize = sizeof(io_uring_recvmsg_out) + uring_recv_msg_.msg_namelen;
+    if (size < headerSize) {
+        LOG_WARN_RATE(10, "[Network] Warning: Received 0 bytes.");
+        return;
+    }
+    io_uring_recvmsg_out out;
+    std::memcpy(&out, buffer, sizeof(out));
+    if (out.flags & MSG_TRUNC) {
+        LOG_WARN_RATE(10, "[Network] Warning: Dropped datagram larger than %zu bytes.", URING_RECV_BUFFER_SIZE - headerSize);
+        return;
+    }
+    const size_t payloadSize = std::min<size_t>(out.payloadlen, size - headerSize);
+    if (payloadSize == 0) {
+        LOG_WARN_RATE(10, "[Network] Warning: Received 0 bytes.");
+        return;
+    }
+    const size_t nameSize = std::min<size_t>(out.namelen, remote_endpoint_.capacity());
+    std::memcpy(remote_endpoint_.data(), buffer + sizeof(out), nameSize);
+    remote_endpoint_.resize(nameSize);
+    ProcessReceivedData(std::span<const char>(buffer + headerSize, payloadSize), remote_endpoint_);
+}
+
+void AsioNetworkManager::StartBatchedReceive() {
+    auto self = weak_from_this();
+    socket_.async_wait(asio::socket_base::wait_read, [this, self](const asio::error_code& error) {
+        auto shared_self = self.lock();
+        if (!shared_self) {
+            return;
+        }
+        if (error == asio::error::operation_aborted) {
+            LOG_INFO("[Network] Receive operation cancelled (socket likely closed).");
+            return;
+        }
+        if (error) {
+            LOG_ERROR_RATE(10, "[Network] Receive error: %s (Code: %d)", error.message().c_str(), error.value());
+        }
+        else {
+            DrainBatchedReceive();
+        }
+        StartBatchedReceive();
+    });
+}
+
+void AsioNetworkManager::DrainBatchedReceive() {
+    // 每次唤醒最多取这么多批，避免持续涌入的数据报饿死同一 io_context 上的其他处理；剩下的下次唤醒再取
+    constexpr int MAX_BATCHES_PER_WAKEUP = 8;
+    const int fd = socket_.native_handle();
+    for (int batch = 0; batch < MAX_BATCHES_PER_WAKEUP; ++batch) {
+        for (size_t i = 0; i < RECV_BATCH_SIZE; ++i) {
+            recv_iovecs_[i] = { ReceiveBuffer(i), RECV_BUFFER_SIZE };
+            msghdr& header = recv_msgs_[i].msg_hdr;
+            header = {};
+            header.msg_name = recv_endpoints_[i].data();
+            header.msg_namelen = static_cast<socklen_t>(recv_endpoints_[i].capacity());
+            header.msg_iov = &recv_iovecs_[i];
+            header.msg_iovlen = 1;
+        }
+        int received = ::recvmmsg(fd, recv_msgs_.data(), static_cast<unsigned int>(RECV_BATCH_SIZE), MSG_DONTWAIT, nullptr);
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNREFUSED) {
+                LOG_ERROR_RATE(10, "[Network] recvmmsg error: %s (Code: %d)", std::strerror(errno), errno);
+            }
+            return;
+        }
+        for (int i = 0; i < received; ++i) {
+            const mmsghdr& message = recv_msgs_[i];
+            if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+                LOG_WARN_RATE(10, "[Network] Warning: Dropped datagram larger than %zu bytes.", RECV_BUFFER_SIZE);
+                continue;
+            }
+            if (message.msg_len == 0) {
+                LOG_WARN_RATE(10, "[Network] Warning: Received 0 bytes.");
+                continue;
+            }
+            recv_endpoints_[i].resize(message.msg_hdr.msg_namelen);
+            ProcessReceivedData(std::span<const char>(ReceiveBuffer(i), message.msg_len), recv_endpoints_[i]);
+        }
+        if (static_cast<size_t>(received) < RECV_BATCH_SIZE) {
+            return; // 已取空
+        }
+    }
+}
+#endif
+
+void AsioNetworkManager::FlushSends() {
+#ifdef __linux__
+    if (uring_) {
+        // 本帧排队的全部发送（以及需要时重新提交的接收）只用这一次 io_uring_enter
+        if (int result = uring_->Submit(); result < 0) {
+            LOG_ERROR_RATE(10, "[Network] io_uring_enter error: %s", std::strerror(-result));
+            return; // 提交项还在队列中，下次再提交，缓冲区暂不归还
+        }
+        for (size_t i = 0; i < pending_send_count_; ++i) {
+            ReleaseSendBuffer(pending_sends_[i]);
+        }
+        pending_send_count_ = 0;
+        return;
+    }
+    if (pending_send_count_ == 0) {
+        return;
+    }
+    for (size_t i = 0; i < pending_send_count_; ++i) {
+        const uint32_t index = pending_sends_[i];
+        msghdr& header = send_msgs_[i].msg_hdr;
+        header = {};
+        header.msg_name = send_endpoints_[index].data();
+        header.msg_namelen = static_cast<socklen_t>(send_endpoints_[index].size());
+        header.msg_iov = &send_iovecs_[index];
+        header.msg_iovlen = 1;
+    }
+    const int fd = socket_.native_handle();
+    size_t offset = 0;
+    while (offset < pending_send_count_) {
+        int sent = ::sendmmsg(fd, send_msgs_.data() + offset, static_cast<unsigned int>(pending_send_count_ - offset), MSG_DONTWAIT);
+        if (sent >= 0) {
+            offset += static_cast<size_t>(sent);
+            if (sent == 0) {
+                break;
+            }
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // 发送缓冲区已满：丢弃本帧剩下的数据报，下一帧会发送新的状态
+            LOG_WARN_RATE(1, "[Network] Warning: Socket send buffer full, dropped %zu datagrams.", pending_send_count_ - offset);
+            break;
+        }
+        // 单个数据报发送失败（例如目标不可达）时跳过它，继续发送其余的
+        LOG_ERROR_RATE(10, "[Network] Send error: %s", std::strerror(errno));
+        ++offset;
+    }
+    for (size_t i = 0; i < pending_send_count_; ++i) {
+        ReleaseSendBuffer(pending_sends_[i]);
     }
+    pending_send_count_ = 0;
+#endif
 }
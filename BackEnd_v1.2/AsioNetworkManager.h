@@ -1,72 +1,372 @@
 // AsioNetwork.h
 #pragma once
 
-// ڰasioͷļ֮ǰASIO_STANDALONEʹö汾
+// 在包含asio头文件之前定义ASIO_STANDALONE，使用独立版本
 #define ASIO_STANDALONE
-#include <asio.hpp> // Asioͷļ
+#include <asio.hpp> // Asio头文件
+#include "ClientSessionTable.h"
+#include "BroadcastScheduler.h"
+#include "SnapshotDelta.h"
+#include "QuantizedCodec.h"
+#include "SpscQueue.h"
+#include "IoUring.h"
+#include "3DPos.h"    // PlayerInputState
 #include <iostream>
 #include <string>
 #include <vector>
 #include <functional>
 #include <array>
 #include <memory>
-#include <deque>      // Ϣ
-#include <optional>   // std::optional
+#include <atomic>
+#include <deque>      // 用于消息队列
+#include <optional>   // 用std::optional
+#include <span>       // 接收数据的字节视图
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#ifdef __linux__
+#include <sys/socket.h> // recvmmsg/sendmmsg
+#endif
 
-// ΪUDPİһĻС
-const int UDP_BUFFER_SIZE = 1048576; // ԸҪ
-// ǰGameHandler࣬еĺ֪
+// 解析单个数据包所用 Arena 的初始块大小，足以容纳 ClientToServer 及其子消息
+const size_t PARSE_ARENA_BLOCK_SIZE = 4096;
+// 发送缓冲区池：每个缓冲区能容纳一个不分片的UDP数据报（以太网MTU 1500 - IP头20 - UDP头8）
+const size_t SEND_BUFFER_SIZE = 1472;
+// 同时在途的发送数上限；池用尽时丢弃新的数据报（状态同步是不可靠的，下一帧会发送新状态）
+const size_t SEND_BUFFER_COUNT = 64;
+// 接收缓冲区池：每个缓冲区与发送缓冲区一样按 MTU 计算（客户端的输入不到 20 字节），更大的数据报被截断后丢弃
+const size_t RECV_BUFFER_SIZE = SEND_BUFFER_SIZE;
+// 异步接收模式下同时投递的接收数（--recv-depth），每个接收占用池中的一个缓冲区
+const size_t DEFAULT_RECV_DEPTH = 4;
+const size_t MAX_RECV_DEPTH = 64;
+// 批量接收时每次 recvmmsg 最多取出的数据报数，每个数据报占用池中的一个缓冲区
+const size_t RECV_BATCH_SIZE = 32;
+// io_uring 模式：提交队列长度，以及多发接收挑选的注册缓冲区（数量须为 2 的幂）
+// 内核在每个缓冲区开头写入 io_uring_recvmsg_out 头和来源地址，再写数据报，因此比 RECV_BUFFER_SIZE 多留出这部分空间
+const unsigned URING_QUEUE_DEPTH = 256;
+const size_t URING_RECV_BUFFER_COUNT = 64;
+const size_t URING_RECV_HEADER_SPACE = 64;
+const size_t URING_RECV_BUFFER_SIZE = RECV_BUFFER_SIZE + URING_RECV_HEADER_SPACE;
+// 客户端超过这么久没有发来消息就认为已经断开
+const auto CLIENT_SESSION_TIMEOUT = std::chrono::seconds(10);
+// 网络线程模式下 网络 -> 模拟 事件队列、模拟 -> 网络 状态快照队列的容量
+const size_t NETWORK_EVENT_QUEUE_SIZE = 8192;
+const size_t SNAPSHOT_QUEUE_SIZE = 4096;
+// 单个状态快照的最大字节数
+const size_t SNAPSHOT_MAX_SIZE = 128;
+// 每次异步发送时 asio 为操作对象申请的内存上限（超出时退回堆分配）
+const size_t SEND_HANDLER_MEMORY_SIZE = 256;
+// 前向声明GameHandler类，否则有的函数不知道有这个类
 class GameHandler;
 
-// ʹAsioUDPͨŵ
-// ̳ std::enable_shared_from_this Ա첽аȫع
+// 发送操作的处理器内存
+// asio 通过完成处理器关联的分配器为每次异步发送申请操作对象。在 io_context 线程之外投递（例如主循环里）时，
+// asio 自带的线程缓存用不上，每次发送都会堆分配，因此每个发送缓冲区附带一块固定内存给它用
+class SendHandlerMemory {
+public:
+    void* Allocate(size_t size) {
+        if (!in_use_ && size <= storage_.size()) {
+            in_use_ = true;
+            return storage_.data();
+        }
+        return ::operator new(size);
+    }
+
+    void Deallocate(void* pointer) {
+        if (pointer == storage_.data()) {
+            in_use_ = false;
+        }
+        else {
+            ::operator delete(pointer);
+        }
+    }
+
+private:
+    alignas(std::max_align_t) std::array<unsigned char, SEND_HANDLER_MEMORY_SIZE> storage_;
+    bool in_use_ = false;
+};
+
+// 把分配请求转给 SendHandlerMemory 的最小分配器
+template <typename T>
+class SendHandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit SendHandlerAllocator(SendHandlerMemory& memory) : memory_(&memory) {}
+    template <typename U>
+    SendHandlerAllocator(const SendHandlerAllocator<U>& other) noexcept : memory_(other.memory_) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(memory_->Allocate(sizeof(T) * count)); }
+    void deallocate(T* pointer, size_t /*count*/) { memory_->Deallocate(pointer); }
+
+    bool operator==(const SendHandlerAllocator& other) const noexcept { return memory_ == other.memory_; }
+    bool operator!=(const SendHandlerAllocator& other) const noexcept { return memory_ != other.memory_; }
+
+private:
+    template <typename> friend class SendHandlerAllocator;
+    SendHandlerMemory* memory_;
+};
+
+// 网络层交给模拟的事件：客户端加入/离开房间（槽位由网络层分配）、玩家输入、客户端对差量快照的确认，以及客户端选择状态编码
+struct NetworkEvent {
+    enum class Type : uint8_t { Join, Leave, Input, Ack, CodecRequest };
+    Type type = Type::Input;
+    uint32_t room = 0;
+    uint32_t slot = 0;
+    PlayerInputState input;
+    uint32_t sequence = 0;                   // Ack：确认的快照序号
+    StateCodec codec = StateCodec::Protobuf; // CodecRequest：客户端选择的编码
+};
+
+// 模拟线程序列化好的一个玩家的状态，由网络线程发给该玩家的客户端
+struct StateSnapshot {
+    uint32_t room = 0;
+    uint32_t slot = 0;
+    uint32_t size = 0;
+    std::array<char, SNAPSHOT_MAX_SIZE> data;
+};
+
+// 网络管理器服务的一个房间：房间编号只用于日志
+struct NetworkRoom {
+    size_t id = 0;
+    GameHandler* game = nullptr;
+};
+
+// 使用Asio进行UDP通信的网络管理器
+// 继承自 std::enable_shared_from_this 以便在异步操作中安全地管理自身生命周期
 class AsioNetworkManager : public std::enable_shared_from_this<AsioNetworkManager> {
 public:
-    // յϢ
-    // ΪյַͷͷĶ˵Ϣ
-    using MessageHandler = std::function<void(const std::string&, const asio::ip::udp::endpoint&)>;
-    // 캯: Ҫһio_contextͼĶ˿ںš
-    // θ¼ƻӶ˿ռ쳣ʾ޸˹캯
+    // 处理接收到的消息
+    // 参数为接收到的数据字符串和发送方的端点信息
+    using MessageHandler = std::function<void(std::span<const char>, const asio::ip::udp::endpoint&)>;
+    // 构造函数: 需要一个io_context和监听的端口号。
+    // 本次更新计划增加端口占用异常提示，于是修改了构造函数
     
-    // ҪһGameHandlerãڴյϢ
+    // 还需要一个GameHandler的引用，用于处理接收到的消息。
     AsioNetworkManager(asio::io_context& io_context, short port, GameHandler& game_handler);
+    // 一个套接字服务多个房间：新客户端被分到其中会话最少的房间，之后一直留在该房间
+    // reuse_port 为 true 时设置 SO_REUSEPORT，多个套接字可以绑定同一端口，由内核按地址四元组把客户端分给其中一个
+    AsioNetworkManager(asio::io_context& io_context, short port, std::vector<NetworkRoom> rooms, bool reuse_port = false);
 
-    // ɾ/ƶ캯͸ֵֹȨƬ
+    // 删除拷贝/移动构造函数和赋值运算符，防止对象所有权或切片问题
     AsioNetworkManager(const AsioNetworkManager&) = delete;
     AsioNetworkManager& operator=(const AsioNetworkManager&) = delete;
     AsioNetworkManager(AsioNetworkManager&&) = delete;
     AsioNetworkManager& operator=(AsioNetworkManager&&) = delete;
 
-    // 첽ѭʼϢ
+    // 启动异步接收循环：开始监听传入的消息
     void StartReceive();
 
-    // 첽ָĿͻ˶˵㷢Ϣ
+    // 异步地向指定的客户端端点发送消息（消息被复制到池中的发送缓冲区）
     void SendTo(const std::string& message, const asio::ip::udp::endpoint& target_endpoint);
-    // Ƿѳɹʼ (socketǷ)
+    // 从发送缓冲区池中取一个缓冲区，由 writer 直接把数据报写进去后异步发送，整个过程不分配内存
+    // writer 的签名为 size_t(std::span<char>)，返回写入的字节数，返回 0 表示放弃发送
+    // 返回是否投递了发送（池用尽或 writer 放弃时返回 false）
+    template <typename Writer>
+    bool SendWith(const asio::ip::udp::endpoint& target_endpoint, Writer&& writer);
+
+    // 异步接收模式下同时投递的接收数（默认 DEFAULT_RECV_DEPTH，限制在 1..MAX_RECV_DEPTH），需要在 StartReceive 之前调用
+    // 一次唤醒可以连续完成多个接收，处理一个数据报时其余的接收仍在等待，不再是收完一个才投递下一个
+    void SetReceiveDepth(size_t depth);
+    size_t ReceiveDepth() const { return receive_depth_; }
+    // 开关批量收发（默认关闭，只在 Linux 上可用），需要在 StartReceive 之前调用
+    // 开启后：套接字可读时用 recvmmsg 一次取出最多 RECV_BATCH_SIZE 个数据报，逐个交给同样的处理流程；
+    // SendTo/SendWith 只把数据报放进待发送队列，由 FlushSends 用一次 sendmmsg 发出
+    void SetBatchedIo(bool enabled);
+    bool IsBatchedIo() const { return batched_io_; }
+    // 开关 io_uring 收发（默认关闭，只在 Linux 上可用），需要在 StartReceive 之前调用；开启时优先于批量收发
+    // 接收是一个常驻的多发(multishot) recvmsg：内核把数据报连同来源地址直接写进注册的缓冲区，完成项从共享内存读取，
+    // 收包不再需要系统调用；发送与批量模式一样先排队，由 FlushSends 用一次 io_uring_enter 提交本帧的全部发送，
+    // 发送不等待（套接字缓冲区满时丢弃），成功的发送不产生完成项，提交返回时缓冲区就已经可以复用
+    // 内核不支持或被禁止（例如容器的 seccomp 策略）时返回 false，保持原来的收发方式
+    bool SetIoUring(bool enabled);
+    bool IsIoUring() const;
+    // io_uring 模式下 io_uring_enter 的调用次数
+    uint64_t IoUringEnterCount() const;
+    // 发出待发送队列中的全部数据报；主循环每帧发完状态后调用。非批量模式下数据报已各自异步发送，这里什么也不做
+    void FlushSends();
+    // 收到并成功解析的数据包总数（可以在任意线程读取）
+    uint64_t ReceivedPacketCount() const { return received_packets_.load(std::memory_order_relaxed); }
+    // 接收缓冲区池的大小（字节），按收发方式在 StartReceive（io_uring 模式下在 SetIoUring）时分配
+    size_t ReceivePoolBytes() const { return receive_pool_.size(); }
+    // 该套接字的网络层内存：管理器对象本身（发送缓冲区池等）与接收缓冲区池
+    size_t MemoryFootprint() const;
+    // 检查网络管理器是否已成功初始化 (看socket是否打开)
     bool IsInitialized() const;
-    std::optional<asio::ip::udp::endpoint> GetLastClientEndpoint() const;
+
+    // 独立网络线程模式（默认关闭），需要在 StartReceive 之前调用
+    // 开启后 io_context 由单独的网络线程运行：接收处理不再直接调用 GameHandler，而是把加入/离开/输入事件放进
+    // 网络 -> 模拟 的无锁队列，由模拟线程在每帧开始时用 DrainEvents 应用；模拟线程推进之后由 BroadcastStates
+    // 把各玩家状态序列化进 模拟 -> 网络 的无锁队列，网络线程取出后发送。会话表此时只能由网络线程访问
+    void SetNetworkThread(bool enabled);
+    bool IsNetworkThread() const { return inbound_events_ != nullptr; }
+    // 模拟线程：应用事件队列中的全部事件，返回应用的个数
+    size_t DrainEvents();
+
+    // 状态广播的目标频率（每个客户端每秒发送的状态数，默认 60）
+    void SetSendRate(float sendRate) { broadcast_scheduler_.SetSendRate(sendRate); }
+    // 模拟线程：按广播调度向到了发送时间、状态有变化或发生了事件的客户端发送状态
+    // 普通模式下直接发送（批量模式下最后一次 sendmmsg 发出）；网络线程模式下序列化进快照队列并唤醒网络线程
+    void BroadcastStates(std::chrono::steady_clock::time_point now);
+    // 模拟线程：取出第 room 个房间自上次调用以来的广播统计并清零
+    BroadcastStats TakeBroadcastStats(size_t room);
+
+    // 客户端会话：每个发送过有效消息的端点一个会话，对应房间内的一个玩家槽位
+    // 第一个客户端使用主玩家槽位，其余客户端各自新增一个玩家
+    ClientSessionTable& Sessions() { return sessions_; }
+    const ClientSessionTable& Sessions() const { return sessions_; }
+    // 会话所在房间的 GameHandler
+    GameHandler& SessionGame(const ClientSession& session) { return *rooms_[session.room].game; }
+    // 分到第 room 个房间的会话数（可以在任意线程读取）
+    size_t RoomSessionCount(size_t room) const { return room_session_counts_[room].load(std::memory_order_relaxed); }
+    // 移除超过 timeout 没有发来消息的会话并释放其玩家槽位，返回移除的个数
+    size_t ExpireIdleSessions(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration timeout);
+    // 每秒在 io_context 上检查一次，移除超过 CLIENT_SESSION_TIMEOUT 的会话
+    void StartSessionSweep();
+    // 当前空闲的发送缓冲区数；向大量客户端发送状态时用来判断是否需要先让已投递的发送完成
+    size_t FreeSendBufferCount() const { return free_send_buffer_count_; }
 
 private:
-    void ProcessReceivedData(const std::string&, const asio::ip::udp::endpoint&);
+    void ProcessReceivedData(std::span<const char> data, const asio::ip::udp::endpoint& sender_endpoint);
+    // 为新端点建立会话并分配玩家槽位；会话数已满时返回 nullptr
+    ClientSession* OpenSession(const asio::ip::udp::endpoint& endpoint);
+    // 把事件交给模拟：网络线程模式下放进事件队列（队列满时返回 false），否则立即应用
+    bool DeliverEvent(const NetworkEvent& event);
+    // 在模拟一侧应用事件
+    void ApplyEvent(const NetworkEvent& event);
+    // 把玩家状态编码成发给该客户端的数据报，格式为该客户端选择的编码（默认 protobuf ServerToClient）
+    size_t WriteState(uint32_t room, uint32_t slot, const PlayerState& state, std::span<char> out);
+    // 广播一个玩家的状态，返回状态字节数；发送失败或快照队列用尽时返回 0，下次调用再试
+    // 在 BroadcastStates 遍历 joined_slots_ 的过程中调用，不能执行 io_context 上的处理器（其中的离开事件会修改 joined_slots_）
+    size_t SendState(uint32_t room, uint32_t slot, const PlayerState& state);
+    size_t PublishSnapshot(uint32_t room, uint32_t slot, const PlayerState& state);
+    // 网络线程：发送快照队列中的全部快照
+    void SendSnapshots();
 
-    // 첽ղɺĴ
-    void HandleReceive(const asio::error_code& error, std::size_t transdBytes);
+    // 在接收缓冲区池的第 slot 个缓冲区上投递一个异步接收
+    void StartAsyncReceive(size_t slot);
+    // 异步接收操作完成后的处理函数，完成后在同一个缓冲区上重新投递
+    void HandleReceive(size_t slot, const asio::error_code& error, std::size_t transdBytes);
+    char* ReceiveBuffer(size_t slot) { return receive_pool_.data() + slot * RECV_BUFFER_SIZE; }
 
-    // 첽ͲɺĴ
+    // 异步发送操作完成后的处理函数
     void HandleSend(const asio::error_code& error);
 
-    // Asio ĺ I/O  (е main д io_context )
+    // 从空闲链表取一个发送缓冲区的下标；池用尽时返回 std::nullopt
+    std::optional<uint32_t> AcquireSendBuffer();
+    // 投递缓冲区 index 中前 size 字节的异步发送，完成处理函数把缓冲区放回空闲链表
+    void SubmitSendBuffer(uint32_t index, size_t size, const asio::ip::udp::endpoint& target_endpoint);
+    void ReleaseSendBuffer(uint32_t index);
+
+#ifdef __linux__
+    // 批量接收：等待套接字可读，然后用 recvmmsg 取空已到达的数据报
+    void StartBatchedReceive();
+    void DrainBatchedReceive();
+    // io_uring：提交（或在内核结束后重新提交）多发接收；等待环上的完成项；处理全部完成项
+    void StartUringReceive();
+    void WaitUring();
+    void ReapUring();
+    // 处理注册缓冲区中的一个数据报：io_uring_recvmsg_out 头、来源地址、负载
+    void HandleUringDatagram(const char* buffer, size_t size);
+#endif
+
+    // Asio 的核心 I/O 服务对象 (持有的是 main 函数中创建的 io_context 的引用)
     asio::io_context& io_context_;
-    // UDPͨŵsocket
+    // 用于UDP通信的socket对象
     asio::ip::udp::socket socket_;
-    // ڴ洢Ϣʱͻ˵Ķ˵Ϣ
+    // 用于存储接收消息时客户端的端点信息（io_uring 模式，来源地址从注册缓冲区中复制出来）
     asio::ip::udp::endpoint remote_endpoint_;
-    // ڽݵĹ̶С
-    std::array<char, UDP_BUFFER_SIZE> receive_buffer_;
-    // GameHandlerãڵ䴦յ
-    GameHandler& game_handler_;
-    // ǳʼǷɹĲֵ
+    // 接收缓冲区池：异步模式 receive_depth_ 个、批量模式 RECV_BATCH_SIZE 个 RECV_BUFFER_SIZE 字节的缓冲区，
+    // io_uring 模式为注册给内核的 URING_RECV_BUFFER_COUNT 个 URING_RECV_BUFFER_SIZE 字节的缓冲区
+    std::vector<char> receive_pool_;
+    // 异步模式下每个投递中的接收的来源端点
+    std::vector<asio::ip::udp::endpoint> receive_endpoints_;
+    size_t receive_depth_ = DEFAULT_RECV_DEPTH;
+    // 解析 Arena 的初始块，每个数据包复用，避免解析时分配堆内存
+    alignas(16) std::array<char, PARSE_ARENA_BLOCK_SIZE> parse_arena_block_;
+    // 发送缓冲区池与空闲链表。发送只在运行 io_context 的线程上投递和完成，因此不需要加锁
+    std::array<std::array<char, SEND_BUFFER_SIZE>, SEND_BUFFER_COUNT> send_buffers_;
+    std::array<SendHandlerMemory, SEND_BUFFER_COUNT> send_handler_memory_;
+    std::array<uint32_t, SEND_BUFFER_COUNT> free_send_buffers_;
+    size_t free_send_buffer_count_ = 0;
+    // 广播时发送缓冲区池用尽（异步模式下缓冲区要等发送完成处理器执行后才归还）时，状态序列化到这里同步发送
+    std::array<char, SEND_BUFFER_SIZE> overflow_send_buffer_;
+    // 批量收发
+    bool batched_io_ = false;
+#ifdef __linux__
+    std::array<mmsghdr, RECV_BATCH_SIZE> recv_msgs_;
+    std::array<iovec, RECV_BATCH_SIZE> recv_iovecs_;
+    std::array<asio::ip::udp::endpoint, RECV_BATCH_SIZE> recv_endpoints_;
+    // 待发送队列：按投递顺序存放发送缓冲区下标，目标端点按下标存放
+    std::array<mmsghdr, SEND_BUFFER_COUNT> send_msgs_;
+    std::array<iovec, SEND_BUFFER_COUNT> send_iovecs_;
+    std::array<asio::ip::udp::endpoint, SEND_BUFFER_COUNT> send_endpoints_;
+    std::array<uint32_t, SEND_BUFFER_COUNT> pending_sends_;
+    size_t pending_send_count_ = 0;
+    // io_uring 模式：环，以及让 asio 等待环上完成项的描述符（环的 fd 的副本）；发送复用上面按缓冲区下标存放的 msghdr 和待发送队列
+    std::unique_ptr<IoUring> uring_;
+    std::optional<asio::posix::stream_descriptor> uring_wait_;
+    msghdr uring_recv_msg_{}; // 多发接收的模板：只用到来源地址的长度
+#endif
+    // 只由接收所在的线程写入，其他线程（统计）只读
+    std::atomic<uint64_t> received_packets_{ 0 };
+    // 该套接字服务的各房间，用于调用其 GameHandler 处理接收到的数据；会话的 room 字段是这里的下标
+    std::vector<NetworkRoom> rooms_;
+    // 标记初始化是否成功的布尔值
     bool is_initialized_ = false;
-    // 洢һγɹյЧϢĿͻ˶˵
-    std::optional<asio::ip::udp::endpoint> last_valid_sender_endpoint_;
-};
\ No newline at end of file
+    // 端点 -> 会话，接收时 O(1) 查找输入属于哪个玩家，发送状态时遍历全部会话
+    ClientSessionTable sessions_;
+    // 每个房间的会话数
+    std::vector<std::atomic<size_t>> room_session_counts_;
+    // 网络层为每个房间分配玩家槽位：主玩家槽位优先，其余从空闲列表或递增计数中取
+    struct RoomSlots {
+        bool primaryTaken = false;
+        uint32_t nextSlot = 1; // 0 是主玩家槽位
+        std::vector<uint32_t> freeSlots;
+        std::vector<asio::ip::udp::endpoint> endpoints; // 槽位 -> 客户端端点，发送快照时使用；端口为 0 表示空闲
+    };
+    std::vector<RoomSlots> room_slots_;
+    // 一个客户端选择的状态编码及其编码状态
+    struct ClientCodec {
+        StateCodec codec = StateCodec::Protobuf;
+        DeltaSnapshotChannel delta; // Delta：已发送快照的历史
+        bool frameSent = false;     // Quantized：是否已经发过量化框架
+        uint8_t frameId = 0;        // Quantized：发给该客户端的量化框架编号
+    };
+    // 一个房间当前的量化框架：关卡范围变化（换图、热重载）时重新生成，编号随之递增
+    struct RoomQuantization {
+        std::optional<AABB> bounds;
+        QuantizationFrame frame;
+        uint8_t id = 0;
+    };
+    // 模拟一侧：每个房间中有客户端的槽位，以及各槽位的广播进度、状态编码和房间的量化框架、广播统计，只由应用事件的线程访问
+    std::vector<std::vector<uint32_t>> joined_slots_;
+    std::vector<std::vector<BroadcastSlot>> broadcast_slots_;
+    std::vector<std::vector<ClientCodec>> client_codecs_;
+    std::vector<RoomQuantization> room_quantization_;
+    std::vector<BroadcastStats> broadcast_stats_;
+    BroadcastScheduler broadcast_scheduler_;
+    asio::steady_timer session_sweep_timer_;
+
+    // 网络线程模式的两个队列，未开启时为空
+    std::unique_ptr<SpscQueue<NetworkEvent>> inbound_events_;
+    std::unique_ptr<SpscQueue<StateSnapshot>> outbound_snapshots_;
+    // 是否已投递了尚未执行的 SendSnapshots，保证同一时刻最多一个，使它可以使用固定的处理器内存
+    std::atomic<bool> snapshot_flush_posted_{ false };
+    SendHandlerMemory snapshot_flush_memory_;
+};
+
+template <typename Writer>
+bool AsioNetworkManager::SendWith(const asio::ip::udp::endpoint& target_endpoint, Writer&& writer) {
+    std::optional<uint32_t> index = AcquireSendBuffer();
+    if (!index) {
+        return false;
+    }
+    size_t size = writer(std::span<char>(send_buffers_[*index]));
+    if (size == 0 || size > SEND_BUFFER_SIZE) {
+        ReleaseSendBuffer(*index);
+        return false;
+    }
+    SubmitSendBuffer(*index, size, target_endpoint);
+    return true;
+}
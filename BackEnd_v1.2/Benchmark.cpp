@@ -0,0 +1,1615 @@
+// Benchmark.cpp
+// 独立的性能测试程序（不参与服务器构建），用法: Benchmark [测试名...]
+// 不带参数时运行全部测试
+
+#include "AsioNetworkManager.h"
+#include "BroadcastScheduler.h"
+#include "SnapshotDelta.h"
+#include "QuantizedCodec.h"
+#include "ClientSessionTable.h"
+#include "MapData.h"
+#include "MapLoader.h"
+#include "GameHandler.h"
+#include "PlayerBatch.h"
+#include "Room.h"
+#include "TickScheduler.h"
+#include "TickTimer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <dlfcn.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// 堆分配计数：替换全局 operator new/delete，只在 countAllocations 打开时计数
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // 替换后的 new/delete 成对使用 malloc/free
+#endif
+namespace {
+std::atomic<bool> countAllocations{ false };
+std::atomic<uint64_t> allocationCount{ 0 };
+}
+
+void* operator new(std::size_t size) {
+    if (countAllocations.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#ifdef __linux__
+// 系统调用计数：替换 libc 中收发与等待相关的包装函数（asio 直接调用它们），只统计打开了 countSyscalls 的线程
+// io_uring_enter 由 IoUring 自己计数
+namespace {
+thread_local bool countSyscalls = false;
+std::atomic<uint64_t> syscallCount{ 0 };
+
+template <typename Fn>
+Fn RealFunction(const char* name) {
+    return reinterpret_cast<Fn>(::dlsym(RTLD_NEXT, name));
+}
+
+void CountSyscall() {
+    if (countSyscalls) {
+        syscallCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+}
+
+extern "C" {
+ssize_t recvmsg(int fd, msghdr* message, int flags) {
+    static const auto real = RealFunction<ssize_t (*)(int, msghdr*, int)>("recvmsg");
+    CountSyscall();
+    return real(fd, message, flags);
+}
+ssize_t sendmsg(int fd, const msghdr* message, int flags) {
+    static const auto real = RealFunction<ssize_t (*)(int, const msghdr*, int)>("sendmsg");
+    CountSyscall();
+    return real(fd, message, flags);
+}
+ssize_t recvfrom(int fd, void* buffer, size_t size, int flags, sockaddr* address, socklen_t* addressSize) {
+    static const auto real = RealFunction<ssize_t (*)(int, void*, size_t, int, sockaddr*, socklen_t*)>("recvfrom");
+    CountSyscall();
+    return real(fd, buffer, size, flags, address, addressSize);
+}
+ssize_t sendto(int fd, const void* buffer, size_t size, int flags, const sockaddr* address, socklen_t addressSize) {
+    static const auto real = RealFunction<ssize_t (*)(int, const void*, size_t, int, const sockaddr*, socklen_t)>("sendto");
+    CountSyscall();
+    return real(fd, buffer, size, flags, address, addressSize);
+}
+int recvmmsg(int fd, mmsghdr* messages, unsigned int count, int flags, timespec* timeout) {
+    static const auto real = RealFunction<int (*)(int, mmsghdr*, unsigned int, int, timespec*)>("recvmmsg");
+    CountSyscall();
+    return real(fd, messages, count, flags, timeout);
+}
+int sendmmsg(int fd, mmsghdr* messages, unsigned int count, int flags) {
+    static const auto real = RealFunction<int (*)(int, mmsghdr*, unsigned int, int)>("sendmmsg");
+    CountSyscall();
+    return real(fd, messages, count, flags);
+}
+int epoll_wait(int fd, epoll_event* events, int count, int timeout) {
+    static const auto real = RealFunction<int (*)(int, epoll_event*, int, int)>("epoll_wait");
+    CountSyscall();
+    return real(fd, events, count, timeout);
+}
+ssize_t read(int fd, void* buffer, size_t size) {
+    static const auto real = RealFunction<ssize_t (*)(int, void*, size_t)>("read");
+    CountSyscall();
+    return real(fd, buffer, size);
+}
+ssize_t write(int fd, const void* buffer, size_t size) {
+    static const auto real = RealFunction<ssize_t (*)(int, const void*, size_t)>("write");
+    CountSyscall();
+    return real(fd, buffer, size);
+}
+}
+#endif
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+// 生成分布很不均匀的关卡：少数高塔上密集分布尖刺，其余是大片稀疏的平台
+std::vector<AABB> GenerateUnevenLevel(size_t obstacleCount, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<AABB> boxes;
+    boxes.reserve(obstacleCount);
+
+    const float worldSize = 50.0f + std::sqrt(static_cast<float>(obstacleCount)) * 4.0f;
+    const size_t towerCount = std::max<size_t>(1, obstacleCount / 2000);
+    std::vector<Struct3D> towers;
+    for (size_t i = 0; i < towerCount; ++i) {
+        towers.push_back({ unit(rng) * worldSize, 0.0f, unit(rng) * worldSize });
+    }
+
+    for (size_t i = 0; i < obstacleCount; ++i) {
+        if (unit(rng) < 0.8f) {
+            // 塔上的尖刺：集中在塔附近的小范围内，高度方向拉得很长
+            const Struct3D& t = towers[i % towerCount];
+            Struct3D c = { t.x + unit(rng) * 6.0f, unit(rng) * 200.0f, t.z + unit(rng) * 6.0f };
+            boxes.push_back(CreateAABB(c, { 0.3f, 0.3f, 0.3f }));
+        }
+        else {
+            // 稀疏平台：散布在整个世界中
+            Struct3D c = { unit(rng) * worldSize, unit(rng) * 20.0f, unit(rng) * worldSize };
+            boxes.push_back(CreateAABB(c, { 1.0f + unit(rng) * 4.0f, 0.5f, 1.0f + unit(rng) * 4.0f }));
+        }
+    }
+    return boxes;
+}
+
+// 返回每次调用 fn 的平均耗时（纳秒）
+double TimePerCall(size_t iterations, const std::function<void(size_t)>& fn) {
+    auto start = BenchClock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = BenchClock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+// 宽相位对比：线性遍历 / 均匀网格 / BVH，找出BVH超过线性遍历的交叉点
+void BenchBroadphase() {
+    std::cout << "[Bench] broadphase: ns per query (candidate query + narrow phase)" << std::endl;
+    std::printf("%10s %12s %12s %12s %10s\n", "obstacles", "linear", "grid", "bvh", "build(ms)");
+
+    size_t crossover = 0;
+    for (size_t n : { 8, 16, 32, 64, 128, 256, 512, 1024, 4096, 16384, 65536 }) {
+        MapData map;
+        map.obstacles = GenerateUnevenLevel(n, 1234);
+        auto buildStart = BenchClock::now();
+        BuildAccelerationStructures(map);
+        std::chrono::duration<double, std::milli> buildMs = BenchClock::now() - buildStart;
+
+        // 查询点一半落在障碍物附近，一半随机，模拟玩家的扫掠盒
+        std::mt19937 rng(99);
+        std::vector<AABB> queries;
+        for (size_t i = 0; i < 1024; ++i) {
+            const AABB& near = map.obstacles[rng() % map.obstacles.size()];
+            Struct3D c = near.min;
+            if (i % 2) {
+                c.x += static_cast<float>(rng() % 100) - 50.0f;
+                c.z += static_cast<float>(rng() % 100) - 50.0f;
+            }
+            queries.push_back(ExpandAABB(CreateAABB(c, { 1.0f, 1.0f, 1.0f }), { 1.0f, 1.0f, 1.0f }));
+        }
+
+        std::vector<uint32_t> candidates;
+        size_t hits = 0;
+        auto run = [&](BroadphaseMode mode) {
+            size_t iterations = std::max<size_t>(2048, 4'000'000 / n);
+            return TimePerCall(iterations, [&](size_t i) {
+                const AABB& q = queries[i % queries.size()];
+                QueryObstacleCandidates(map, mode, q, candidates);
+                for (uint32_t index : candidates) {
+                    const AABB& b = map.obstacles[index];
+                    hits += q.max.x > b.min.x && q.min.x < b.max.x &&
+                        q.max.y > b.min.y && q.min.y < b.max.y &&
+                        q.max.z > b.min.z && q.min.z < b.max.z;
+                }
+            });
+        };
+        double linearNs = run(BroadphaseMode::Linear);
+        double gridNs = run(BroadphaseMode::Grid);
+        double bvhNs = run(BroadphaseMode::Bvh);
+        if (crossover == 0 && bvhNs < linearNs) {
+            crossover = n;
+        }
+        std::printf("%10zu %12.1f %12.1f %12.1f %10.2f\n", n, linearNs, gridNs, bvhNs, buildMs.count());
+        if (hits == 0) {
+            std::cout << "[Bench] (no hits)" << std::endl; // 防止编译器把循环优化掉
+        }
+    }
+    std::cout << "[Bench] BVH beats the linear scan from " << crossover << " obstacles" << std::endl;
+}
+
+// 与 GameHandler::CheckAABBCollision 相同的逐个标量比较
+bool CheckAABBCollision(const AABB& a, const AABB& b) {
+    bool xOverlap = a.max.x > b.min.x && a.min.x < b.max.x;
+    bool yOverlap = a.max.y > b.min.y && a.min.y < b.max.y;
+    bool zOverlap = a.max.z > b.min.z && a.min.z < b.max.z;
+    return xOverlap && yOverlap && zOverlap;
+}
+
+// AABB重叠内核对比：AoS逐个标量比较 vs SoA存储上的各级SIMD内核
+void BenchSimdOverlap() {
+    std::cout << "[Bench] simd: full scan of obstacles, ns per obstacle (detected: "
+        << SimdLevelName(DetectSimdLevel()) << ")" << std::endl;
+    std::printf("%10s %12s %12s %12s %12s\n", "obstacles", "aos-scalar", "soa-scalar", "soa-sse2", "soa-avx2");
+
+    for (size_t n : { 64, 1024, 16384, 262144 }) {
+        std::vector<AABB> boxes = GenerateUnevenLevel(n, 77);
+        ObstacleSoA soa;
+        soa.Build(boxes);
+        std::mt19937 rng(5);
+        std::vector<AABB> queries;
+        for (size_t i = 0; i < 64; ++i) {
+            queries.push_back(ExpandAABB(boxes[rng() % n], { 0.5f, 0.5f, 0.5f }));
+        }
+
+        const size_t iterations = std::max<size_t>(16, 16'000'000 / n);
+        size_t expectedHits = 0;
+        double aosNs = TimePerCall(iterations, [&](size_t i) {
+            const AABB& q = queries[i % queries.size()];
+            for (const auto& box : boxes) {
+                expectedHits += CheckAABBCollision(q, box);
+            }
+        });
+
+        std::vector<uint32_t> hits;
+        double soaNs[3] = {};
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 }) {
+            if (static_cast<int>(level) > static_cast<int>(DetectSimdLevel())) {
+                continue;
+            }
+            size_t totalHits = 0;
+            soaNs[static_cast<int>(level)] = TimePerCall(iterations, [&](size_t i) {
+                hits.clear();
+                soa.Query(queries[i % queries.size()], hits, level);
+                totalHits += hits.size();
+            });
+            if (totalHits != expectedHits) {
+                std::cout << "[Bench] Error: " << SimdLevelName(level) << " kernel hit count mismatch ("
+                    << totalHits << " vs " << expectedHits << ")" << std::endl;
+            }
+        }
+        const double perObstacle = static_cast<double>(n);
+        std::printf("%10zu %12.3f %12.3f %12.3f %12.3f\n", n, aosNs / perObstacle,
+            soaNs[0] / perObstacle, soaNs[1] / perObstacle, soaNs[2] / perObstacle);
+    }
+}
+
+// 多玩家批量模拟：只跑 PlayerBatch 的移动/重力/地面内核，以及完整的 GameHandler::Update（含碰撞）
+// 完整模拟使用当前目录下的 map.txt
+void BenchPlayerBatch() {
+    std::cout << "[Bench] players: players per microsecond per tick" << std::endl;
+    std::printf("%10s %14s %14s\n", "players", "kernels", "full-update");
+
+    const float deltaTime = 1.0f / 60.0f;
+    for (size_t n : { 1, 16, 256, 1024, 4096 }) {
+        std::mt19937 rng(42);
+        auto randomInput = [&](size_t tick) {
+            PlayerInputState input;
+            input.moveForward = rng() % 2;
+            input.moveBackward = !input.moveForward && rng() % 4 == 0;
+            input.moveLeft = rng() % 3 == 0;
+            input.moveRight = !input.moveLeft && rng() % 3 == 0;
+            input.jumpPressed = tick % 30 == 0;
+            return input;
+        };
+
+        // 只包含逐玩家独立的向量化循环，碰撞结果视为全部未命中
+        PlayerBatch batch;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t slot = batch.Add();
+            batch.SetInput(slot, randomInput(0));
+        }
+        const size_t iterations = std::max<size_t>(64, 4'000'000 / n);
+        double kernelNs = TimePerCall(iterations, [&](size_t) {
+            batch.IntegrateMovement(deltaTime);
+            batch.ApplyGroundAndCommit();
+            batch.ClearFrameInputs();
+        });
+
+        GameHandler game;
+        while (game.PlayerCount() < n) {
+            game.AddPlayer();
+        }
+        std::vector<PlayerInputState> inputs;
+        for (size_t i = 0; i < 64; ++i) {
+            inputs.push_back(randomInput(i));
+        }
+        double updateNs = TimePerCall(std::max<size_t>(16, 400'000 / n), [&](size_t tick) {
+            for (uint32_t slot = 0; slot < n; ++slot) {
+                game.ProcessInput(slot, inputs[(slot + tick) % inputs.size()]);
+            }
+            game.Update(deltaTime);
+        });
+
+        const double playersPerUs = static_cast<double>(n) * 1000.0;
+        std::printf("%10zu %14.2f %14.2f\n", n, playersPerUs / kernelNs, playersPerUs / updateNs);
+    }
+}
+
+// 连续碰撞：玩家以 MAX_FALL_VELOCITY 落向一块 0.5 厚的平台，起始高度在一个步长内取多个相位
+// 开启连续碰撞时每种 tick 率下都必须停在平台顶面上；关闭时统计没有停在平台上的次数：
+// 平台中央只有步长超过 平台厚度 + 玩家高度 时才会穿过，平台边缘（玩家与平台水平重叠 0.25）
+// 只要一帧的下沉深度超过水平重叠，离散的重叠处理就会把玩家横向推出平台
+void BenchContinuousCollision() {
+    const std::string mapFile = (std::filesystem::temp_directory_path() / "iwanna_bench_slab.txt").string();
+    const float slabTop = 10.0f;
+    const float slabEdge = 5.0f;
+    {
+        std::ofstream out(mapFile);
+        out << "victory_point 100.0 0.5 100.0\n";
+        out << "obstacle_aabb " << -slabEdge << " " << slabTop - 0.5f << " " << -slabEdge << " "
+            << slabEdge << " " << slabTop << " " << slabEdge << "\n";
+    }
+    const float dropX[2] = { 0.0f, slabEdge + GameConstants::PLAYER_WIDTH * 0.5f - 0.25f }; // 中央、边缘
+
+    constexpr int PHASES = 64;
+    std::cout << "[Bench] ccd: falling at " << -GameConstants::MAX_FALL_VELOCITY << " units/s onto a 0.5-unit slab, "
+        << PHASES << " start phases per rate" << std::endl;
+    std::printf("%8s %8s %24s %24s\n", "rate(Hz)", "step", "ccd on landed c/e", "ccd off missed c/e");
+    bool ccdFailed = false;
+    for (float rate : { 60.0f, 30.0f, 25.0f, 20.0f, 15.0f, 10.0f }) {
+        const float deltaTime = 1.0f / rate;
+        const float step = -GameConstants::MAX_FALL_VELOCITY * deltaTime;
+        int landed[2][2] = {}; // [ccd 关/开][中央/边缘]
+        for (int ccd = 0; ccd < 2; ++ccd) {
+            GameHandler game(mapFile);
+            game.SetContinuousCollision(ccd == 1);
+            for (int where = 0; where < 2; ++where) {
+                for (int phase = 0; phase < PHASES; ++phase) {
+                    PlayerState start;
+                    start.pos = { dropX[where], slabTop + 0.01f + step * (phase + 0.5f) / PHASES, 0.0f };
+                    start.velocity = { 0.0f, GameConstants::MAX_FALL_VELOCITY, 0.0f };
+                    start.isInAir = true;
+                    game.SetPlayerState(GameHandler::PRIMARY_PLAYER_SLOT, start);
+                    for (int tick = 0; tick < static_cast<int>(rate) * 2; ++tick) {
+                        game.Update(deltaTime);
+                    }
+                    // 两秒后停在平台顶面（站在障碍物上时 isInAir 会逐帧交替，不作判断）
+                    const PlayerState end = game.GetPlayerState(GameHandler::PRIMARY_PLAYER_SLOT);
+                    landed[ccd][where] += std::abs(end.pos.y - slabTop) < 1e-3f;
+                }
+            }
+        }
+        std::printf("%8.0f %8.3f %15d/%-2d %2d/%-2d %15d/%-2d %2d/%-2d\n", rate, step,
+            landed[1][0], PHASES, landed[1][1], PHASES, PHASES - landed[0][0], PHASES, PHASES - landed[0][1], PHASES);
+        if (landed[1][0] != PHASES || landed[1][1] != PHASES) {
+            ccdFailed = true;
+            std::cout << "[Bench] Error: with continuous collision the player missed the slab at " << rate << " Hz" << std::endl;
+        }
+    }
+    if (!ccdFailed) {
+        std::cout << "[Bench] ccd: continuous collision landed on the slab at every rate and phase" << std::endl;
+    }
+    std::filesystem::remove(mapFile);
+}
+
+// 多房间调度：64个负载不均的房间（玩家数不同），线程数从1扩展到64
+// 每一轮推进所有房间一个固定步长，统计每轮耗时与房间逻辑帧耗时
+void BenchRoomScaling() {
+    const size_t roomCount = 64;
+    const float deltaTime = 1.0f / 60.0f;
+    std::vector<std::unique_ptr<Room>> rooms;
+    for (size_t i = 0; i < roomCount; ++i) {
+        auto room = std::make_unique<Room>(i, GameConstants::DEFAULT_MAP_FILE, deltaTime);
+        const size_t players = 32 + (i % 8) * 96;
+        while (room->Game().PlayerCount() < players) {
+            room->Game().AddPlayer();
+        }
+        PlayerInputState input;
+        input.moveForward = true;
+        for (uint32_t slot = 0; slot < players; ++slot) {
+            input.moveLeft = slot % 2;
+            room->Game().ProcessInput(slot, input);
+        }
+        rooms.push_back(std::move(room));
+    }
+
+    std::cout << "[Bench] rooms: " << roomCount << " rooms, ms per round (one tick of every room)" << std::endl;
+    std::printf("%10s %12s %10s %14s %14s\n", "threads", "round(ms)", "speedup", "room-avg(us)", "room-max(us)");
+    double singleThreadMs = 0.0;
+    for (size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+        TickScheduler scheduler(threads);
+        for (auto& room : rooms) {
+            room->ResetTickStats();
+        }
+        const size_t rounds = 200;
+        double roundNs = TimePerCall(rounds, [&](size_t) {
+            scheduler.RunBatch(rooms.size(), [&](size_t i) {
+                rooms[i]->Advance(deltaTime);
+            });
+        });
+        double averageUs = 0.0;
+        double maxUs = 0.0;
+        for (auto& room : rooms) {
+            averageUs += room->TickStats().averageTickUs / static_cast<double>(roomCount);
+            maxUs = std::max(maxUs, room->TickStats().maxTickUs);
+        }
+        const double roundMs = roundNs / 1e6;
+        if (threads == 1) {
+            singleThreadMs = roundMs;
+        }
+        std::printf("%10zu %12.3f %10.2f %14.1f %14.1f\n", threads, roundMs, singleThreadMs / roundMs, averageUs, maxUs);
+    }
+    std::cout << "[Bench] (hardware threads: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// 原先 GameHandler::LoadMapFromFile 的逐行解析（getline + istringstream + operator>>），作为对比基准
+bool LegacyParseTextMap(const std::string& filename, MapData& mapData) {
+    std::ifstream mapFile(filename);
+    std::string line;
+    if (!std::getline(mapFile, line)) {
+        return false;
+    }
+    std::istringstream header(line);
+    std::string type;
+    header >> type;
+    if (type != "victory_point") {
+        return false;
+    }
+    header >> mapData.victoryPoint.x >> mapData.victoryPoint.y >> mapData.victoryPoint.z;
+    while (std::getline(mapFile, line)) {
+        std::istringstream iss(line);
+        iss >> type;
+        if (type == "obstacle_aabb") {
+            AABB obstacle;
+            iss >> obstacle.min.x >> obstacle.min.y >> obstacle.min.z
+                >> obstacle.max.x >> obstacle.max.y >> obstacle.max.z;
+            mapData.obstacles.push_back(obstacle);
+        }
+    }
+    return true;
+}
+
+// 损坏或恶意构造的预编译地图：BVH节点数组不合法时 LoadCompiledMap 必须丢弃它并从障碍物重新构建，
+// 而不是在查询时越界访问或死循环
+void CheckCorruptCompiledMaps() {
+    MapData valid;
+    valid.victoryPoint = { 10.0f, 0.5f, 5.0f };
+    valid.obstacles = GenerateUnevenLevel(2000, 31);
+    BuildAccelerationStructures(valid);
+    const std::vector<BvhNode>& validNodes = valid.obstacleBvh.Nodes();
+    const std::vector<uint32_t>& validIndices = valid.obstacleBvh.PrimIndices();
+
+    struct CorruptCase {
+        const char* name;
+        std::function<void(std::vector<BvhNode>&, std::vector<uint32_t>&)> corrupt;
+    };
+    const std::vector<CorruptCase> cases = {
+        { "last node internal", [](std::vector<BvhNode>& nodes, std::vector<uint32_t>&) { nodes.back().count = 0; } },
+        { "root self-loop", [](std::vector<BvhNode>& nodes, std::vector<uint32_t>&) { nodes[0].leftOrFirst = 0; } },
+        { "back edge to root", [](std::vector<BvhNode>& nodes, std::vector<uint32_t>&) {
+            nodes[nodes[0].leftOrFirst].count = 0;
+            nodes[nodes[0].leftOrFirst].leftOrFirst = 0;
+        } },
+        { "shared subtree", [](std::vector<BvhNode>& nodes, std::vector<uint32_t>&) {
+            nodes[0].leftOrFirst = 2; // 根的右孩子指向左子树内部（节点 1 是内部节点），仍然只向后引用
+        } },
+        { "leaf range out of bounds", [](std::vector<BvhNode>& nodes, std::vector<uint32_t>& indices) {
+            nodes[1].leftOrFirst = static_cast<uint32_t>(indices.size());
+            nodes[1].count = 1;
+        } },
+        { "deeper than query stack", [](std::vector<BvhNode>& nodes, std::vector<uint32_t>& indices) {
+            // 左侧为一条 QUERY_STACK_SIZE + 8 个内部节点的链，每个内部节点的右孩子是一个叶子
+            const uint32_t depth = Bvh::QUERY_STACK_SIZE + 8;
+            const AABB everything = { { -1e6f, -1e6f, -1e6f }, { 1e6f, 1e6f, 1e6f } };
+            nodes.assign(depth * 2 + 1, BvhNode{ everything, 0, 1 });
+            for (uint32_t i = 0; i < depth; ++i) {
+                nodes[i] = { everything, depth + (depth - i), 0 };
+            }
+            indices.assign(1, 0);
+        } },
+    };
+
+    const std::string compiledFile = (std::filesystem::temp_directory_path() / "iwanna_bench_corrupt.iwmap").string();
+    std::cout << "[Bench] mapparse: corrupt compiled maps (BVH must be rebuilt)" << std::endl;
+    for (const CorruptCase& c : cases) {
+        std::vector<BvhNode> nodes = validNodes;
+        std::vector<uint32_t> indices = validIndices;
+        c.corrupt(nodes, indices);
+        MapData corrupt = valid;
+        corrupt.obstacleBvh.Assign(std::move(nodes), std::move(indices));
+        WriteCompiledMap(corrupt, compiledFile);
+
+        MapData loaded = LoadCompiledMap(compiledFile);
+        const std::vector<BvhNode>& loadedNodes = loaded.obstacleBvh.Nodes();
+        const bool rebuilt = loaded.loadedSuccessfully && loadedNodes.size() == validNodes.size() &&
+            std::memcmp(loadedNodes.data(), validNodes.data(), validNodes.size() * sizeof(BvhNode)) == 0;
+        std::printf("%34s %10s\n", c.name, rebuilt ? "rebuilt" : "FAILED");
+        if (!rebuilt) {
+            std::cout << "[Bench] Error: corrupt BVH (" << c.name << ") was not rejected" << std::endl;
+        }
+    }
+    std::filesystem::remove(compiledFile);
+}
+
+// 文本地图解析：生成100万个障碍物的地图文件，对比原解析器与 from_chars 解析器
+void BenchMapParse() {
+    const size_t obstacleCount = 1'000'000;
+    const std::string textFile = (std::filesystem::temp_directory_path() / "iwanna_bench_map.txt").string();
+    {
+        std::ofstream out(textFile);
+        out << "victory_point 10.0 0.5 5.0\n";
+        out << "# generated by Benchmark\n";
+        char line[160];
+        for (const AABB& box : GenerateUnevenLevel(obstacleCount, 2024)) {
+            std::snprintf(line, sizeof(line), "obstacle_aabb %.4f %.4f %.4f %.4f %.4f %.4f\n",
+                box.min.x, box.min.y, box.min.z, box.max.x, box.max.y, box.max.z);
+            out << line;
+        }
+    }
+    const double fileMb = static_cast<double>(std::filesystem::file_size(textFile)) / (1024.0 * 1024.0);
+    std::cout << "[Bench] mapparse: " << obstacleCount << " obstacles, " << fileMb << " MB text" << std::endl;
+
+    auto timeMs = [](const std::function<void()>& fn) {
+        auto start = BenchClock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed = BenchClock::now() - start;
+        return elapsed.count();
+    };
+
+    MapData legacy;
+    double legacyMs = timeMs([&] { LegacyParseTextMap(textFile, legacy); });
+
+    MapData parsed;
+    double parseMs = timeMs([&] {
+        std::ifstream in(textFile, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        ParseTextMap(text, parsed);
+    });
+    if (parsed.obstacles != legacy.obstacles || parsed.victoryPoint != legacy.victoryPoint) {
+        std::cout << "[Bench] Error: from_chars parser result differs from the legacy parser" << std::endl;
+    }
+
+    MapData loaded;
+    double loadMs = timeMs([&] { loaded = LoadTextMap(textFile); });
+    const std::string compiledFile = CompiledMapPath(textFile);
+    WriteCompiledMap(loaded, compiledFile);
+    MapData compiled;
+    double compiledMs = timeMs([&] { compiled = LoadCompiledMap(compiledFile); });
+
+    std::printf("%34s %10.1f ms\n", "legacy istringstream parse", legacyMs);
+    std::printf("%34s %10.1f ms (%.1fx)\n", "from_chars parse", parseMs, legacyMs / parseMs);
+    std::printf("%34s %10.1f ms\n", "LoadTextMap (parse + build)", loadMs);
+    std::printf("%34s %10.1f ms\n", "LoadCompiledMap", compiledMs);
+
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(compiledFile);
+
+    CheckCorruptCompiledMaps();
+}
+
+// 接收路径：通过回环地址向 AsioNetworkManager 发送输入包，统计每个包处理过程中的堆分配次数
+// 除了测量耗时，也用来验证接收路径（接收完成 -> 解析 -> ProcessInput -> 重新投递接收）不分配内存
+void BenchReceivePath() {
+    constexpr short port = 12999;
+    asio::io_context io;
+    GameHandler game;
+    auto network = std::make_shared<AsioNetworkManager>(io, port, game);
+    network->StartReceive();
+
+    asio::ip::udp::socket client(io, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+    const asio::ip::udp::endpoint server(asio::ip::address_v4::loopback(), port);
+    game_backend::ClientToServer message;
+    message.mutable_input()->set_move_forward(true);
+    message.mutable_input()->set_jump_pressed(true);
+    const std::string packet = message.SerializeAsString();
+
+    // 每次发送一个包，run_one 执行对应的接收完成处理
+    auto receiveOne = [&] {
+        client.send_to(asio::buffer(packet), server);
+        io.run_one();
+    };
+    for (int i = 0; i < 100; ++i) {
+        receiveOne(); // 预热：asio 的处理器内存回收、protobuf 的一次性初始化等
+    }
+
+    const size_t packets = 20000;
+    allocationCount = 0;
+    countAllocations = true;
+    double nsPerPacket = TimePerCall(packets, [&](size_t) { receiveOne(); });
+    countAllocations = false;
+    const double allocationsPerPacket = static_cast<double>(allocationCount.load()) / static_cast<double>(packets);
+
+    std::cout << "[Bench] recv: " << packets << " input packets over loopback" << std::endl;
+    std::printf("%24s %10.1f\n", "ns per packet", nsPerPacket);
+    std::printf("%24s %10.3f\n", "heap allocs per packet", allocationsPerPacket);
+    if (allocationCount.load() != 0) {
+        std::cout << "[Bench] Error: receive path allocated " << allocationCount.load() << " times" << std::endl;
+    }
+}
+
+// 发送路径：把状态直接序列化到发送缓冲区池并通过回环地址发送，统计每个数据报的堆分配次数
+void BenchSendPath() {
+    constexpr short port = 12998;
+    asio::io_context io;
+    GameHandler game;
+    auto network = std::make_shared<AsioNetworkManager>(io, port, game);
+
+    asio::ip::udp::socket client(io, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+    const asio::ip::udp::endpoint clientEndpoint(asio::ip::address_v4::loopback(), client.local_endpoint().port());
+    std::array<char, SEND_BUFFER_SIZE> received;
+    asio::ip::udp::endpoint sender;
+
+    // 每次序列化并投递一个数据报，run 执行完所有发送完成处理（把缓冲区放回池中）后返回，然后客户端同步收下
+    // 这里没有挂起的接收，io_context 每次因没有任务而停止，需要 restart
+    auto sendOne = [&] {
+        network->SendWith(clientEndpoint, [&game](std::span<char> buffer) { return game.SerializeStateTo(buffer); });
+        io.restart();
+        io.run();
+        client.receive_from(asio::buffer(received), sender);
+    };
+    for (int i = 0; i < 100; ++i) {
+        sendOne(); // 预热：状态消息的子消息、asio 的处理器内存回收等
+    }
+
+    const size_t datagrams = 20000;
+    allocationCount = 0;
+    countAllocations = true;
+    double nsPerDatagram = TimePerCall(datagrams, [&](size_t) { sendOne(); });
+    countAllocations = false;
+    const double allocationsPerDatagram = static_cast<double>(allocationCount.load()) / static_cast<double>(datagrams);
+
+    std::cout << "[Bench] send: " << datagrams << " state datagrams over loopback" << std::endl;
+    std::printf("%24s %10.1f\n", "ns per datagram", nsPerDatagram);
+    std::printf("%24s %10.3f\n", "heap allocs per datagram", allocationsPerDatagram);
+    if (allocationCount.load() != 0) {
+        std::cout << "[Bench] Error: send path allocated " << allocationCount.load() << " times" << std::endl;
+    }
+}
+
+// protobuf 每帧的消息处理：每个客户端解析一个 ClientToServer 输入、序列化一个 ServerToClient 状态
+// 对比每次新建消息并序列化成 std::string（GetStateDataForNetwork）与栈上 Arena 解析 + 复用状态消息直接写入缓冲区，
+// 再在回环地址上跑完整的一帧（接收 -> 推进 -> 广播）验证每帧不分配内存
+void BenchProtobufTick() {
+    constexpr size_t clients = 32;
+    constexpr size_t ticks = 2000;
+    constexpr float dt = 1.0f / 60.0f;
+    std::cout << "[Bench] protobuf: " << clients << " clients, one input parsed and one state serialized per client per tick" << std::endl;
+    std::printf("%34s %14s %16s\n", "path", "ns per client", "heap allocs/tick");
+
+    game_backend::ClientToServer message;
+    message.mutable_input()->set_move_forward(true);
+    message.mutable_input()->set_jump_pressed(true);
+    const std::string packet = message.SerializeAsString();
+
+    GameHandler game;
+    for (uint32_t slot = 1; slot < clients; ++slot) {
+        game.AddPlayerAt(slot);
+    }
+    size_t stateBytes = 0;
+    auto processInput = [&](uint32_t slot, const game_backend::ClientToServer& parsed) {
+        PlayerInputState input;
+        input.moveForward = parsed.input().move_forward();
+        input.jumpPressed = parsed.input().jump_pressed();
+        game.ProcessInput(slot, input);
+    };
+    auto runTicks = [&](const char* label, const std::function<void(uint32_t)>& perClient) {
+        for (uint32_t slot = 0; slot < clients; ++slot) {
+            perClient(slot); // 预热：复用消息的子消息在第一次填充时创建
+        }
+        allocationCount = 0;
+        countAllocations = true;
+        const double nsPerTick = TimePerCall(ticks, [&](size_t) {
+            for (uint32_t slot = 0; slot < clients; ++slot) {
+                perClient(slot);
+            }
+        });
+        countAllocations = false;
+        if (stateBytes == 0) {
+            std::cout << "[Bench] Error: no state serialized" << std::endl;
+        }
+        std::printf("%34s %14.1f %16.2f\n", label, nsPerTick / clients, static_cast<double>(allocationCount.load()) / ticks);
+    };
+
+    runTicks("new message + std::string", [&](uint32_t slot) {
+        game_backend::ClientToServer parsed;
+        parsed.ParseFromArray(packet.data(), static_cast<int>(packet.size()));
+        processInput(slot, parsed);
+        std::optional<std::string> state = game.GetStateDataForNetwork(slot);
+        stateBytes += state ? state->size() : 0;
+    });
+
+    alignas(16) std::array<char, PARSE_ARENA_BLOCK_SIZE> arenaBlock;
+    std::array<char, SEND_BUFFER_SIZE> buffer;
+    runTicks("arena + reused message + buffer", [&](uint32_t slot) {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = arenaBlock.data();
+        options.initial_block_size = arenaBlock.size();
+        google::protobuf::Arena arena(options);
+#if GOOGLE_PROTOBUF_VERSION >= 4022000
+        auto& parsed = *google::protobuf::Arena::Create<game_backend::ClientToServer>(&arena);
+#else
+        auto& parsed = *google::protobuf::Arena::CreateMessage<game_backend::ClientToServer>(&arena);
+#endif
+        parsed.ParseFromArray(packet.data(), static_cast<int>(packet.size()));
+        processInput(slot, parsed);
+        stateBytes += game.SerializeStateTo(slot, buffer);
+    });
+
+    // 完整的一帧：客户端各发一个输入，服务器 poll 接收、推进、按 1000 Hz 广播（每帧都发），客户端收下状态
+    // 只统计服务器一侧的分配
+    constexpr short port = 12989;
+    asio::io_context io;
+    GameHandler roomGame;
+    auto network = std::make_shared<AsioNetworkManager>(io, port, roomGame);
+    network->SetSendRate(1000.0f);
+    network->StartReceive();
+    const asio::ip::udp::endpoint server(asio::ip::address_v4::loopback(), port);
+    std::vector<asio::ip::udp::socket> sockets;
+    for (size_t i = 0; i < clients; ++i) {
+        sockets.emplace_back(io, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+        sockets.back().non_blocking(true);
+    }
+    game_backend::ClientToServer backward;
+    backward.mutable_input()->set_move_backward(true);
+    const std::string backwardPacket = backward.SerializeAsString();
+    std::array<char, SEND_BUFFER_SIZE> received;
+    asio::ip::udp::endpoint sender;
+    uint64_t states = 0;
+    uint64_t allocations = 0;
+    auto now = BenchClock::now();
+    const size_t warmupTicks = 100;
+    for (size_t tick = 0; tick < warmupTicks + ticks; ++tick) {
+        // 来回走动，状态每帧都在变化
+        const std::string& input = (tick / 30) % 2 == 0 ? packet : backwardPacket;
+        for (auto& socket : sockets) {
+            socket.send_to(asio::buffer(input), server);
+        }
+        now += std::chrono::microseconds(16667);
+        allocationCount = 0;
+        countAllocations = tick >= warmupTicks;
+        io.poll();
+        roomGame.Update(dt);
+        network->BroadcastStates(now);
+        io.poll();
+        countAllocations = false;
+        allocations += allocationCount.load();
+        for (auto& socket : sockets) {
+            asio::error_code error;
+            while (socket.receive_from(asio::buffer(received), sender, 0, error) > 0 && !error) {
+                states += tick >= warmupTicks;
+            }
+        }
+    }
+    std::printf("%34s %14s %16.2f\n", "full tick over loopback", "-", static_cast<double>(allocations) / ticks);
+    std::cout << "[Bench] protobuf: " << static_cast<double>(states) / ticks << " states received per tick" << std::endl;
+    if (allocations != 0) {
+        std::cout << "[Bench] Error: protobuf tick path allocated " << allocations << " times" << std::endl;
+    }
+}
+
+// 批量收发对比：逐包异步收发 与 recvmmsg/sendmmsg 批量收发，回环地址上的每秒数据包数
+// 客户端每轮先发出一批输入包（不计时），再计时服务器把它们全部处理完；发送方向计时服务器投递并发出一批状态
+void BenchBatchedIo() {
+    constexpr size_t burst = 64; // 每轮数据包数，保持在套接字缓冲区容量之内
+    constexpr size_t rounds = 2000;
+    std::cout << "[Bench] batchio: " << burst << "-packet bursts over loopback, packets per second" << std::endl;
+    std::printf("%10s %14s %14s\n", "mode", "recv pps", "send pps");
+
+    game_backend::ClientToServer message;
+    message.mutable_input()->set_move_forward(true);
+    const std::string packet = message.SerializeAsString();
+
+    for (bool batched : { false, true }) {
+        const short port = batched ? 12996 : 12995;
+        asio::io_context io;
+        GameHandler game;
+        auto network = std::make_shared<AsioNetworkManager>(io, port, game);
+        network->SetBatchedIo(batched);
+        network->StartReceive();
+        asio::ip::udp::socket client(io, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+        const asio::ip::udp::endpoint server(asio::ip::address_v4::loopback(), port);
+
+        std::chrono::duration<double> receiveTime{ 0 };
+        for (size_t round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < burst; ++i) {
+                client.send_to(asio::buffer(packet), server);
+            }
+            const uint64_t target = network->ReceivedPacketCount() + burst;
+            auto start = BenchClock::now();
+            while (network->ReceivedPacketCount() < target) {
+                io.run_one();
+            }
+            receiveTime += BenchClock::now() - start;
+        }
+
+        // 发送方向另用一个不接收的管理器，这样 io_context 在发送完成处理执行完后就会停止
+        asio::io_context sendIo;
+        auto sender = std::make_shared<AsioNetworkManager>(sendIo, static_cast<short>(port + 10), game);
+        sender->SetBatchedIo(batched);
+        const asio::ip::udp::endpoint clientEndpoint(asio::ip::address_v4::loopback(), client.local_endpoint().port());
+        std::array<char, SEND_BUFFER_SIZE> received;
+        asio::ip::udp::endpoint from;
+        std::chrono::duration<double> sendTime{ 0 };
+        for (size_t round = 0; round < rounds; ++round) {
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < burst; ++i) {
+                sender->SendWith(clientEndpoint, [&game](std::span<char> buffer) { return game.SerializeStateTo(buffer); });
+            }
+            sender->FlushSends();
+            sendIo.restart();
+            sendIo.run();
+            sendTime += BenchClock::now() - start;
+            for (size_t i = 0; i < burst; ++i) {
+                client.receive_from(asio::buffer(received), from);
+            }
+        }
+
+        const double packets = static_cast<double>(burst * rounds);
+        std::printf("%10s %14.0f %14.0f\n", batched ? "batched" : "async", packets / receiveTime.count(), packets / sendTime.count());
+    }
+}
+
+// 接收缓冲区池：每种收发方式下每个套接字的网络层内存，以及回环地址上的接收速率
+// 客户端线程不停地发送输入包（在途的包数限制在套接字缓冲区容量之内），服务器线程事件驱动地处理，统计每秒处理的数据包数
+void BenchReceivePool() {
+    constexpr size_t packets = 200000;
+    constexpr uint64_t inFlight = 64;
+    std::cout << "[Bench] recvpool: " << packets << " input packets over loopback, network memory per socket and received packets per second" << std::endl;
+    std::printf("%16s %14s %16s %14s\n", "mode", "memory KiB", "recv pool KiB", "recv pps");
+
+    game_backend::ClientToServer message;
+    message.mutable_input()->set_move_forward(true);
+    const std::string packet = message.SerializeAsString();
+
+    struct Mode {
+        const char* label;
+        size_t depth;
+        bool batched;
+        bool uring;
+    };
+    const Mode modes[] = {
+        { "async depth 1", 1, false, false },
+        { "async depth 4", 4, false, false },
+        { "async depth 16", 16, false, false },
+        { "batched", 1, true, false },
+        { "io_uring", 1, false, true },
+    };
+    short port = 12970;
+    for (const Mode& mode : modes) {
+        asio::io_context io;
+        GameHandler game;
+        auto network = std::make_shared<AsioNetworkManager>(io, ++port, game);
+        network->SetReceiveDepth(mode.depth);
+        network->SetBatchedIo(mode.batched);
+        if (mode.uring && !network->SetIoUring(true)) {
+            std::printf("%16s %14s\n", mode.label, "unavailable");
+            continue;
+        }
+        network->StartReceive();
+
+        std::atomic<bool> done{ false };
+        std::thread clientThread([&] {
+            asio::io_context clientIo;
+            asio::ip::udp::socket client(clientIo, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+            const asio::ip::udp::endpoint server(asio::ip::address_v4::loopback(), port);
+            for (uint64_t sent = 0; sent < packets; ++sent) {
+                while (sent >= network->ReceivedPacketCount() + inFlight) {
+                    std::this_thread::yield();
+                }
+                client.send_to(asio::buffer(packet), server);
+            }
+            done = true;
+        });
+
+        auto start = BenchClock::now();
+        while (network->ReceivedPacketCount() < packets) {
+            // 客户端发完之后 100 毫秒还没有新数据报：有包丢失，不再等待
+            if (io.run_one_for(std::chrono::milliseconds(100)) == 0 && done) {
+                break;
+            }
+        }
+        const std::chrono::duration<double> elapsed = BenchClock::now() - start;
+        clientThread.join();
+        std::printf("%16s %14.1f %16.1f %14.0f\n", mode.label, network->MemoryFootprint() / 1024.0,
+            network->ReceivePoolBytes() / 1024.0, network->ReceivedPacketCount() / elapsed.count());
+    }
+}
+
+#ifdef __linux__
+// io_uring 收发对比：客户端线程每轮从各自的套接字发一个编码请求（服务器立即回一份状态），统计服务器线程每个数据包（收+发）的系统调用数
+// 和客户端看到的往返延迟。服务器线程按事件驱动的方式运行：阻塞等到有事件，执行全部就绪的处理，然后广播状态
+void BenchIoUring() {
+    constexpr size_t clients = 16;
+    constexpr size_t rounds = 3000;
+    constexpr size_t warmupRounds = 10; // 建立会话
+    std::cout << "[Bench] uring: " << clients << " clients over loopback, " << rounds
+        << " rounds of one request/state per client; server-thread syscalls per packet (in + out), round-trip latency (us)" << std::endl;
+    std::printf("%10s %16s %14s %10s %10s %10s %8s\n", "mode", "syscalls/packet", "enter/round", "p50", "p99", "p99.9", "lost");
+
+    std::array<char, 8> request;
+    const size_t requestSize = EncodeCodecRequest(StateCodec::Protobuf, request);
+
+    enum class Mode { Async, Batched, Uring };
+    for (Mode mode : { Mode::Async, Mode::Batched, Mode::Uring }) {
+        const short port = static_cast<short>(12983 + static_cast<int>(mode));
+        const char* label = mode == Mode::Uring ? "io_uring" : (mode == Mode::Batched ? "batched" : "async");
+        asio::io_context io;
+        GameHandler game;
+        auto network = std::make_shared<AsioNetworkManager>(io, port, game);
+        network->SetBatchedIo(mode == Mode::Batched);
+        if (mode == Mode::Uring && !network->SetIoUring(true)) {
+            std::printf("%10s %16s\n", label, "unavailable");
+            continue;
+        }
+        network->SetSendRate(1.0f); // 只测事件触发的回复：编码请求让该客户端立即收到一份状态
+        network->StartReceive();
+
+        std::atomic<bool> done{ false };
+        std::vector<double> latencyUs;
+        latencyUs.reserve(clients * rounds);
+        size_t lost = 0;
+        std::thread clientThread([&] {
+            sockaddr_in server{};
+            server.sin_family = AF_INET;
+            server.sin_port = htons(static_cast<uint16_t>(port));
+            server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            std::vector<int> sockets;
+            for (size_t i = 0; i < clients; ++i) {
+                const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+                timeval timeout{ 0, 200000 };
+                ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                sockets.push_back(fd);
+            }
+            std::array<char, SEND_BUFFER_SIZE> received;
+            std::vector<BenchClock::time_point> sendTimes(clients);
+            for (size_t round = 0; round < warmupRounds + rounds; ++round) {
+                for (size_t i = 0; i < clients; ++i) {
+                    // 丢掉按频率发来的状态，只等本轮请求的回复
+                    while (::recv(sockets[i], received.data(), received.size(), MSG_DONTWAIT) > 0) {
+                    }
+                    sendTimes[i] = BenchClock::now();
+                    ::sendto(sockets[i], request.data(), requestSize, 0, reinterpret_cast<const sockaddr*>(&server), sizeof(server));
+                }
+                for (size_t i = 0; i < clients; ++i) {
+                    const bool measured = round >= warmupRounds;
+                    if (::recv(sockets[i], received.data(), received.size(), 0) <= 0) {
+                        lost += measured;
+                    }
+                    else if (measured) {
+                        latencyUs.push_back(std::chrono::duration<double, std::micro>(BenchClock::now() - sendTimes[i]).count());
+                    }
+                }
+            }
+            for (int fd : sockets) {
+                ::close(fd);
+            }
+            done = true;
+        });
+
+        // 服务器线程：只统计测量轮次中的系统调用（按收到的包数判断预热已经结束）
+        const uint64_t warmupPackets = clients * warmupRounds;
+        uint64_t syscallsAtStart = 0;
+        uint64_t entersAtStart = 0;
+        uint64_t packetsAtStart = 0;
+        bool measuring = false;
+        countSyscalls = true;
+        while (!done.load(std::memory_order_relaxed)) {
+            io.run_one_for(std::chrono::milliseconds(5));
+            io.poll();
+            network->BroadcastStates(BenchClock::now());
+            if (!measuring && network->ReceivedPacketCount() >= warmupPackets) {
+                measuring = true;
+                syscallsAtStart = syscallCount.load();
+                entersAtStart = network->IoUringEnterCount();
+                packetsAtStart = network->ReceivedPacketCount();
+            }
+        }
+        countSyscalls = false;
+        clientThread.join();
+        const uint64_t enters = network->IoUringEnterCount() - entersAtStart;
+        const uint64_t syscalls = syscallCount.load() - syscallsAtStart + enters;
+        const uint64_t packetsIn = network->ReceivedPacketCount() - packetsAtStart;
+
+        std::sort(latencyUs.begin(), latencyUs.end());
+        auto percentile = [&](double p) {
+            return latencyUs.empty() ? 0.0 : latencyUs[std::min(latencyUs.size() - 1, static_cast<size_t>(p * latencyUs.size()))];
+        };
+        std::printf("%10s %16.2f %14.2f %10.1f %10.1f %10.1f %8zu\n", label, static_cast<double>(syscalls) / (2.0 * packetsIn),
+            static_cast<double>(enters) / rounds, percentile(0.5), percentile(0.99), percentile(0.999), lost);
+    }
+}
+#endif
+
+// 主循环节拍：原来的 poll + sleep_for(1ms) 循环、按绝对截止时间由定时器唤醒的循环、定时器 + 截止时间前自旋的循环（可绑定核心）
+// 分别在空闲（没有客户端）和有负载（一个客户端每毫秒发一个输入）时运行，统计主循环线程的 CPU 占用和帧开始延迟
+// 帧开始延迟 = 实际执行第 k 次逻辑帧的时间 - (开始时间 + k × 步长)；每种循环在单独的线程上运行，绑定核心不影响之后的测试
+void BenchTickLoop() {
+    constexpr double seconds = 3.0;
+    const float deltaTime = 1.0f / 60.0f;
+    const auto period = std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(deltaTime));
+    std::cout << "[Bench] tickloop: " << seconds << " s per run at 60 Hz, main-loop thread CPU and tick start lateness (us)" << std::endl;
+    std::printf("%18s %8s %8s %8s %10s %10s %10s\n", "loop", "load", "CPU %", "ticks", "p50", "p99", "max");
+
+    game_backend::ClientToServer message;
+    message.mutable_input()->set_move_forward(true);
+    const std::string packet = message.SerializeAsString();
+
+    struct Loop {
+        const char* label;
+        bool timer;
+        TickPacerMode pacer;
+        std::chrono::microseconds spinWindow;
+        bool pin;
+    };
+    const Loop loops[] = {
+        { "poll+sleep1ms", false, TickPacerMode::Timer, std::chrono::microseconds(0), false },
+        { "timer", true, TickPacerMode::Timer, std::chrono::microseconds(0), false },
+        { "spin 100us", true, TickPacerMode::Spin, std::chrono::microseconds(100), false },
+        { "spin 250us", true, TickPacerMode::Spin, std::chrono::microseconds(250), false },
+        { "spin 250us pinned", true, TickPacerMode::Spin, std::chrono::microseconds(250), true },
+    };
+    // 绑定到最后一个核心
+    const int pinCpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1;
+    short port = 12950;
+    std::vector<std::string> histograms;
+    for (const Loop& loopConfig : loops) {
+        for (bool loaded : { false, true }) {
+            asio::io_context io;
+            Room room(0, GameConstants::DEFAULT_MAP_FILE, deltaTime);
+            auto network = std::make_shared<AsioNetworkManager>(io, ++port, room.Game());
+            network->StartReceive();
+
+            std::atomic<bool> done{ false };
+            std::thread clientThread([&] {
+                if (!loaded) {
+                    return;
+                }
+                asio::io_context clientIo;
+                asio::ip::udp::socket client(clientIo, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+                client.non_blocking(true);
+                const asio::ip::udp::endpoint server(asio::ip::address_v4::loopback(), port);
+                std::array<char, SEND_BUFFER_SIZE> received;
+                asio::ip::udp::endpoint from;
+                while (!done.load(std::memory_order_relaxed)) {
+                    client.send_to(asio::buffer(packet), server);
+                    asio::error_code error;
+                    while (client.receive_from(asio::buffer(received), from, 0, error) > 0 && !error) {
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+
+            std::vector<double> latenessUs;
+            TickJitterHistogram histogram;
+            auto recordTick = [&](BenchClock::duration lateness) {
+                latenessUs.push_back(std::chrono::duration<double, std::micro>(lateness).count());
+                histogram.Record(lateness);
+            };
+            double cpuSeconds = 0.0;
+            double wallSeconds = 0.0;
+            std::thread loopThread([&] {
+                if (loopConfig.pin && !PinCurrentThreadToCpu(pinCpu)) {
+                    std::cout << "[Bench] tickloop: failed to pin to CPU " << pinCpu << std::endl;
+                }
+                const auto start = BenchClock::now();
+                const auto end = start + std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(seconds));
+                const auto cpuStart = ThreadCpuTime();
+                if (!loopConfig.timer) {
+                    // 原来的主循环：按经过的真实时间累加，逻辑帧在累加器满一个步长后的第一次循环中执行
+                    auto lastUpdate = std::chrono::high_resolution_clock::now();
+                    uint64_t tick = 0;
+                    while (BenchClock::now() < end) {
+                        auto current = std::chrono::high_resolution_clock::now();
+                        std::chrono::duration<float> frame = current - lastUpdate;
+                        lastUpdate = current;
+                        io.poll();
+                        const uint64_t before = room.TickStats().tickCount;
+                        room.Advance(std::min(frame.count(), 0.25f));
+                        const auto now = BenchClock::now();
+                        for (uint64_t i = before; i < room.TickStats().tickCount; ++i) {
+                            recordTick(now - (start + period * static_cast<int64_t>(++tick)));
+                        }
+                        network->BroadcastStates(now);
+                        std::chrono::duration<float> loop = std::chrono::high_resolution_clock::now() - current;
+                        if (room.Accumulator() < deltaTime / 2.0f && loop.count() < deltaTime / 2.0f) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                    }
+                }
+                else {
+                    TickTimer timer(io, loopConfig.pacer, loopConfig.spinWindow);
+                    TickDeadlines deadlines(period, start);
+                    while (deadlines.Next() < end) {
+                        const auto deadline = deadlines.Next();
+                        timer.WaitUntil(deadline);
+                        const auto now = BenchClock::now();
+                        recordTick(now - deadline);
+                        const TickDeadlines::TickStart tick = deadlines.Start(now);
+                        io.poll();
+                        room.Advance(static_cast<float>(tick.ticks) * deltaTime);
+                        network->BroadcastStates(now);
+                    }
+                }
+                cpuSeconds = std::chrono::duration<double>(ThreadCpuTime() - cpuStart).count();
+                wallSeconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+            });
+            loopThread.join();
+            done = true;
+            clientThread.join();
+
+            std::sort(latenessUs.begin(), latenessUs.end());
+            auto percentile = [&](double p) {
+                return latenessUs.empty() ? 0.0 : latenessUs[std::min(latenessUs.size() - 1, static_cast<size_t>(p * latenessUs.size()))];
+            };
+            const char* label = loopConfig.label;
+            std::printf("%18s %8s %8.1f %8zu %10.1f %10.1f %10.1f\n", label, loaded ? "1 kHz" : "idle", cpuSeconds * 100.0 / wallSeconds,
+                latenessUs.size(), percentile(0.5), percentile(0.99), latenessUs.empty() ? 0.0 : latenessUs.back());
+            histograms.push_back(std::string(label) + (loaded ? ", 1 kHz: " : ", idle: ") + histogram.Format());
+        }
+    }
+    for (const std::string& line : histograms) {
+        std::cout << "[Bench] tickloop histogram " << line << std::endl;
+    }
+}
+
+// 客户端会话表：满载（MAX_CLIENT_SESSIONS 个客户端）时的查找耗时，以及客户端不断进出之后查找是否仍然正确
+void BenchSessionTable() {
+    std::mt19937 rng(1234);
+    auto randomEndpoint = [&] {
+        return asio::ip::udp::endpoint(asio::ip::address_v4(static_cast<uint32_t>(rng())), static_cast<unsigned short>(1024 + rng() % 60000));
+    };
+
+    ClientSessionTable table;
+    std::vector<asio::ip::udp::endpoint> endpoints;
+    while (endpoints.size() < table.Capacity()) {
+        asio::ip::udp::endpoint endpoint = randomEndpoint();
+        if (table.Insert(endpoint, static_cast<uint32_t>(endpoints.size()))) {
+            endpoints.push_back(endpoint);
+        }
+    }
+
+    // 客户端进出：随机删掉一个再加入一个新的，重复多轮
+    std::vector<uint32_t> slots(endpoints.size());
+    for (uint32_t i = 0; i < slots.size(); ++i) {
+        slots[i] = i;
+    }
+    for (size_t round = 0; round < 100000; ++round) {
+        size_t victim = rng() % endpoints.size();
+        table.Erase(endpoints[victim]);
+        asio::ip::udp::endpoint endpoint = randomEndpoint();
+        while (table.Find(endpoint) != nullptr) {
+            endpoint = randomEndpoint();
+        }
+        table.Insert(endpoint, slots[victim]);
+        endpoints[victim] = endpoint;
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        const ClientSession* session = table.Find(endpoints[i]);
+        mismatches += session == nullptr || session->playerSlot != slots[i];
+    }
+
+    size_t hits = 0;
+    double hitNs = TimePerCall(1000000, [&](size_t i) {
+        hits += table.Find(endpoints[(i * 2654435761u) % endpoints.size()]) != nullptr;
+    });
+    double missNs = TimePerCall(1000000, [&](size_t) {
+        hits += table.Find(randomEndpoint()) != nullptr;
+    });
+
+    std::cout << "[Bench] sessions: " << table.Size() << " clients after 100000 join/leave rounds" << std::endl;
+    std::printf("%24s %10.1f\n", "ns per lookup (hit)", hitNs);
+    std::printf("%24s %10.1f (includes endpoint generation)\n", "ns per lookup (miss)", missNs);
+    if (mismatches != 0 || table.Size() != endpoints.size()) {
+        std::cout << "[Bench] Error: session table lost " << mismatches << " clients" << std::endl;
+    }
+}
+
+// 网络线程对逻辑帧抖动的影响：后台线程以突发方式向服务器狂发输入包，同时按固定间隔推进一个房间，
+// 记录每帧在逻辑线程上花费的时间（处理网络事件 + 推进 + 发送/交出状态）的分布
+// inline: 逻辑线程自己 poll io_context 并发送状态（原先的主循环）；thread: 网络线程运行 io_context，逻辑线程只读写 SPSC 队列
+// 网络线程需要有自己的核心才能体现效果；单核机器上它只会抢占逻辑线程
+void BenchNetworkThread() {
+    constexpr size_t clients = 32;
+    constexpr size_t burstPerClient = 16;          // 每次突发每个客户端发出的包数
+    constexpr auto burstInterval = std::chrono::milliseconds(5);
+    constexpr size_t ticks = 1000;
+    constexpr auto tickInterval = std::chrono::milliseconds(2);
+    constexpr float dt = 1.0f / 60.0f;
+    std::cout << "[Bench] netthread: " << clients << " clients bursting " << clients * burstPerClient
+        << " packets every " << burstInterval.count() << " ms, per-tick time on the tick thread (us)" << std::endl;
+    std::printf("%10s %10s %10s %10s %10s %12s\n", "mode", "p50", "p99", "p99.9", "max", "states sent");
+
+    game_backend::ClientToServer message;
+    message.mutable_input()->set_move_forward(true);
+    const std::string packet = message.SerializeAsString();
+
+    for (bool threaded : { false, true }) {
+        const short port = threaded ? 12994 : 12993;
+        asio::io_context io;
+        GameHandler game;
+        auto network = std::make_shared<AsioNetworkManager>(io, port, game);
+        network->SetNetworkThread(threaded);
+        network->StartReceive();
+
+        std::atomic<bool> running{ true };
+        std::thread blaster([&] {
+            asio::io_context clientIo;
+            std::vector<asio::ip::udp::socket> sockets;
+            for (size_t i = 0; i < clients; ++i) {
+                sockets.emplace_back(clientIo, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+            }
+            const asio::ip::udp::endpoint server(asio::ip::address_v4::loopback(), port);
+            while (running.load(std::memory_order_relaxed)) {
+                for (auto& socket : sockets) {
+                    for (size_t i = 0; i < burstPerClient; ++i) {
+                        asio::error_code error;
+                        socket.send_to(asio::buffer(packet), server, 0, error);
+                    }
+                }
+                std::this_thread::sleep_for(burstInterval);
+            }
+        });
+        std::optional<std::thread> networkThread;
+        if (threaded) {
+            networkThread.emplace([&io] {
+                auto work = asio::make_work_guard(io);
+                io.run();
+            });
+        }
+
+        uint64_t statesSent = 0;
+        std::vector<double> tickUs;
+        tickUs.reserve(ticks);
+        auto nextTick = BenchClock::now();
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            std::this_thread::sleep_until(nextTick);
+            nextTick += tickInterval;
+            auto start = BenchClock::now();
+            if (threaded) {
+                network->DrainEvents();
+            }
+            else {
+                io.poll();
+            }
+            game.Update(dt);
+            network->BroadcastStates(BenchClock::now());
+            std::chrono::duration<double, std::micro> elapsed = BenchClock::now() - start;
+            tickUs.push_back(elapsed.count());
+        }
+
+        running = false;
+        blaster.join();
+        if (networkThread) {
+            io.stop();
+            networkThread->join();
+        }
+        network->Sessions().ForEach([&](ClientSession& session) { statesSent += session.packetsSent; });
+        std::sort(tickUs.begin(), tickUs.end());
+        auto percentile = [&](double p) { return tickUs[std::min(tickUs.size() - 1, static_cast<size_t>(p * tickUs.size()))]; };
+        std::printf("%10s %10.1f %10.1f %10.1f %10.1f %12llu\n", threaded ? "thread" : "inline",
+            percentile(0.5), percentile(0.99), percentile(0.999), tickUs.back(), static_cast<unsigned long long>(statesSent));
+    }
+}
+
+// 状态广播调度：1 kHz 的主循环、60 Hz 的模拟，一半玩家一直在移动、一半站着不动，
+// 对比每次循环都发送（原先的主循环）与不同 --send-rate 下每个客户端每秒收到的状态数和带宽
+void BenchBroadcast() {
+    constexpr uint32_t players = 64;
+    constexpr int seconds = 10;
+    constexpr int loopRate = 1000;
+    constexpr float dt = 1.0f / 60.0f;
+    std::cout << "[Bench] broadcast: " << players << " clients (half moving, half idle), " << loopRate
+        << " Hz loop, 60 Hz simulation, per client" << std::endl;
+    std::printf("%14s %12s %12s %12s %14s\n", "send rate", "states/s", "KB/s", "skipped/s", "ns per check");
+
+    for (float sendRate : { 0.0f, 60.0f, 30.0f, 20.0f }) {
+        GameHandler game;
+        for (uint32_t i = 1; i < players; ++i) {
+            game.AddPlayer();
+        }
+        // 移动的玩家每半秒换一次方向，来回走动，不会被障碍物挡住停下
+        PlayerInputState forward;
+        forward.moveForward = true;
+        PlayerInputState backward;
+        backward.moveBackward = true;
+        uint64_t ticks = 0;
+        BroadcastScheduler scheduler(sendRate > 0.0f ? sendRate : 60.0f);
+        std::vector<BroadcastSlot> slots(players);
+        std::array<char, SEND_BUFFER_SIZE> buffer;
+        uint64_t sent = 0;
+        uint64_t bytes = 0;
+        uint64_t skipped = 0;
+        uint64_t checks = 0;
+        std::chrono::duration<double, std::nano> checkTime{ 0 };
+
+        // 模拟时间：不睡眠，直接按循环间隔推进时间点
+        const auto begin = BenchClock::time_point{};
+        float accumulator = 0.0f;
+        for (int loop = 0; loop < seconds * loopRate; ++loop) {
+            const auto now = begin + std::chrono::microseconds(1000000LL * loop / loopRate);
+            accumulator += 1.0f / loopRate;
+            while (accumulator >= dt) {
+                for (uint32_t slot = 0; slot < players; slot += 2) {
+                    game.ProcessInput(slot, (ticks / 30) % 2 == 0 ? forward : backward);
+                }
+                game.Update(dt);
+                ++ticks;
+                accumulator -= dt;
+            }
+            auto start = BenchClock::now();
+            for (uint32_t slot = 0; slot < players; ++slot) {
+                const PlayerState state = game.GetPlayerState(slot);
+                BroadcastScheduler::Decision decision = sendRate > 0.0f
+                    ? scheduler.Decide(slots[slot], state, now)
+                    : BroadcastScheduler::Decision::Send;
+                ++checks;
+                if (decision == BroadcastScheduler::Decision::Unchanged) {
+                    ++skipped;
+                }
+                if (decision == BroadcastScheduler::Decision::Send || decision == BroadcastScheduler::Decision::Event) {
+                    scheduler.MarkSent(slots[slot], state, now);
+                    bytes += game.SerializeStateTo(slot, buffer);
+                    ++sent;
+                }
+            }
+            checkTime += BenchClock::now() - start;
+        }
+
+        const double perClientSecond = static_cast<double>(players) * seconds;
+        char label[32];
+        std::snprintf(label, sizeof(label), sendRate > 0.0f ? "%.0f Hz" : "every loop", sendRate);
+        std::printf("%14s %12.1f %12.2f %12.1f %14.1f\n", label, sent / perClientSecond, bytes / 1024.0 / perClientSecond,
+            skipped / perClientSecond, checkTime.count() / static_cast<double>(checks));
+    }
+}
+
+// 差量快照带宽：一个来回走动的玩家以 60 Hz 发送状态，快照和确认各自按丢包率随机丢失，确认晚 RTT 个快照到达服务器
+// 对比每份快照的平均字节数（protobuf 完整状态 / 差量快照），并用参考解码器验证客户端得到的状态与服务器发出的逐位一致
+void BenchDeltaSnapshots() {
+    constexpr size_t snapshots = 60 * 60;  // 一分钟
+    constexpr size_t rttSnapshots = 6;     // 100 ms 往返
+    constexpr float dt = 1.0f / 60.0f;
+    std::cout << "[Bench] delta: " << snapshots << " snapshots at 60 Hz, ack RTT " << rttSnapshots
+        << " snapshots, bytes per snapshot" << std::endl;
+    std::printf("%8s %10s %10s %10s %10s %12s\n", "loss", "protobuf", "delta", "saved", "full %", "mismatches");
+
+    for (double loss : { 0.0, 0.01, 0.05, 0.10, 0.25, 0.50 }) {
+        GameHandler game;
+        PlayerInputState forward;
+        forward.moveForward = true;
+        PlayerInputState backward;
+        backward.moveBackward = true;
+        PlayerInputState jump;
+        jump.jumpPressed = true;
+
+        DeltaSnapshotChannel channel;
+        DeltaSnapshotReceiver receiver;
+        std::mt19937 rng(42);
+        std::bernoulli_distribution lost(loss);
+        std::vector<std::pair<size_t, uint32_t>> acksInFlight; // (到达服务器的快照编号, 确认的序号)
+        std::array<char, SEND_BUFFER_SIZE> buffer;
+        uint64_t protobufBytes = 0;
+        uint64_t deltaBytes = 0;
+        size_t fullCount = 0;
+        size_t mismatches = 0;
+
+        for (size_t i = 0; i < snapshots; ++i) {
+            // 走走停停：每秒中一半时间来回走动、偶尔起跳，另一半时间站着不动
+            const size_t second = i / 60;
+            if (i % 60 < 30) {
+                game.ProcessInput(second % 2 == 0 ? forward : backward);
+                if (i % 20 == 0) {
+                    game.ProcessInput(jump);
+                }
+            }
+            else {
+                game.ProcessInput(PlayerInputState{});
+            }
+            game.Update(dt);
+
+            // 服务器收到此前到达的确认
+            for (auto it = acksInFlight.begin(); it != acksInFlight.end();) {
+                if (it->first <= i) {
+                    channel.Acknowledge(it->second);
+                    it = acksInFlight.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+
+            const PlayerState state = game.GetPlayerState(GameHandler::PRIMARY_PLAYER_SLOT);
+            protobufBytes += game.SerializeStateTo(buffer);
+            const size_t size = channel.Encode(state, buffer);
+            deltaBytes += size;
+            fullCount += !channel.LastWasDelta();
+            if (lost(rng)) {
+                continue;
+            }
+            uint32_t sequence = 0;
+            std::optional<PlayerState> decoded = receiver.Decode(std::span<const char>(buffer.data(), size), sequence);
+            if (!decoded || decoded->pos != state.pos || decoded->velocity != state.velocity ||
+                decoded->isInAir != state.isInAir || decoded->hasWon != state.hasWon) {
+                ++mismatches;
+                continue;
+            }
+            if (!lost(rng)) {
+                acksInFlight.emplace_back(i + rttSnapshots, sequence);
+            }
+        }
+
+        const double protobufAvg = static_cast<double>(protobufBytes) / snapshots;
+        const double deltaAvg = static_cast<double>(deltaBytes) / snapshots;
+        std::printf("%7.0f%% %10.1f %10.1f %9.0f%% %9.1f%% %12zu\n", loss * 100.0, protobufAvg, deltaAvg,
+            100.0 * (1.0 - deltaAvg / protobufAvg), 100.0 * fullCount / snapshots, mismatches);
+        if (mismatches != 0) {
+            std::cout << "[Bench] Error: " << mismatches << " delta snapshots decoded incorrectly" << std::endl;
+        }
+    }
+}
+
+// 量化编码：录制一个来回走动、起跳的玩家一分钟的状态，每个实体取轨迹上不同的位置
+// 对比每个实体的字节数（protobuf 每个实体一个 ServerToClient 数据报，量化编码多个实体打包进一个数据报），
+// 编码/解码吞吐，以及解码后的最大量化误差
+void BenchQuantizedCodec() {
+    constexpr size_t snapshots = 60 * 60;
+    constexpr float dt = 1.0f / 60.0f;
+    GameHandler game;
+    PlayerInputState forward;
+    forward.moveForward = true;
+    PlayerInputState backward;
+    backward.moveBackward = true;
+    PlayerInputState jump;
+    jump.jumpPressed = true;
+    std::vector<PlayerState> trajectory;
+    trajectory.reserve(snapshots);
+    uint64_t protobufBytes = 0;
+    std::array<char, SEND_BUFFER_SIZE> protobufBuffer;
+    for (size_t i = 0; i < snapshots; ++i) {
+        const size_t second = i / 60;
+        game.ProcessInput(i % 60 < 45 ? (second % 2 == 0 ? forward : backward) : PlayerInputState{});
+        if (i % 40 == 0) {
+            game.ProcessInput(jump);
+        }
+        game.Update(dt);
+        trajectory.push_back(game.GetPlayerState(GameHandler::PRIMARY_PLAYER_SLOT));
+        protobufBytes += game.SerializeStateTo(protobufBuffer);
+    }
+    const double protobufPerEntity = static_cast<double>(protobufBytes) / snapshots;
+
+    // protobuf 基线的编码/解码耗时（每个实体一个 ServerToClient）
+    const size_t protobufSize = game.SerializeStateTo(protobufBuffer);
+    constexpr size_t protobufIterations = 200000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < protobufIterations; ++i) {
+        game.SerializeStateTo(protobufBuffer);
+    }
+    const double protobufEncodeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / protobufIterations;
+    game_backend::ServerToClient parsed;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < protobufIterations; ++i) {
+        parsed.ParseFromArray(protobufBuffer.data(), static_cast<int>(protobufSize));
+    }
+    const double protobufDecodeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / protobufIterations;
+
+    const AABB bounds = game.LevelBounds();
+    const QuantizationFrame frame = MakeQuantizationFrame(bounds);
+    std::cout << "[Bench] quantized: " << snapshots << " recorded states, position bits " << int(frame.positionBits[0]) << "/"
+        << int(frame.positionBits[1]) << "/" << int(frame.positionBits[2]) << ", velocity bits " << int(frame.velocityBits) << std::endl;
+    std::printf("%10s %14s %14s %10s %12s %12s %12s %12s\n", "entities", "protobuf B/ent", "quant B/ent", "saved",
+        "enc ns/ent", "dec ns/ent", "max pos err", "max vel err");
+    std::printf("%10s %14.1f %14s %10s %12.1f %12.1f %12s %12s\n", "protobuf", protobufPerEntity, "-", "-",
+        protobufEncodeNs, protobufDecodeNs, "0", "0");
+
+    for (size_t entityCount : { size_t{ 1 }, size_t{ 8 }, size_t{ 64 } }) {
+        std::vector<QuantizedEntity> entities(entityCount);
+        std::vector<QuantizedEntity> decoded;
+        decoded.reserve(entityCount);
+        std::vector<char> buffer(QuantizedSnapshotMaxSize(entityCount));
+        QuantizedSnapshotDecoder decoder;
+        // 第一个数据报附带量化框架，之后的不带
+        const size_t frameSize = EncodeQuantizedSnapshot(0, frame, true, std::span<const QuantizedEntity>(entities), buffer);
+        decoder.Decode(std::span<const char>(buffer.data(), frameSize), decoded);
+
+        uint64_t bytes = 0;
+        float maxPositionError = 0.0f;
+        float maxVelocityError = 0.0f;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < snapshots; ++i) {
+            for (size_t e = 0; e < entityCount; ++e) {
+                entities[e] = { static_cast<uint32_t>(e), trajectory[(i + e * 37) % snapshots] };
+            }
+            const size_t size = EncodeQuantizedSnapshot(0, frame, false, std::span<const QuantizedEntity>(entities), buffer);
+            bytes += size;
+            decoded.clear();
+            if (decoder.Decode(std::span<const char>(buffer.data(), size), decoded) != QuantizedSnapshotDecoder::Result::Ok ||
+                decoded.size() != entityCount) {
+                ++mismatches;
+                continue;
+            }
+            for (size_t e = 0; e < entityCount; ++e) {
+                const PlayerState& expected = entities[e].state;
+                const PlayerState& actual = decoded[e].state;
+                const Struct3D positionError = actual.pos - expected.pos;
+                const Struct3D velocityError = actual.velocity - expected.velocity;
+                maxPositionError = std::max({ maxPositionError, std::abs(positionError.x), std::abs(positionError.y), std::abs(positionError.z) });
+                maxVelocityError = std::max({ maxVelocityError, std::abs(velocityError.x), std::abs(velocityError.y), std::abs(velocityError.z) });
+                mismatches += decoded[e].slot != entities[e].slot || actual.isInAir != expected.isInAir || actual.hasWon != expected.hasWon;
+            }
+        }
+
+        // 吞吐：同一组实体反复编码/解码
+        const size_t iterations = 400000 / entityCount;
+        size_t size = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            size = EncodeQuantizedSnapshot(0, frame, false, std::span<const QuantizedEntity>(entities), buffer);
+        }
+        const double encodeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (iterations * entityCount);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            decoded.clear();
+            decoder.Decode(std::span<const char>(buffer.data(), size), decoded);
+        }
+        const double decodeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (iterations * entityCount);
+
+        const double perEntity = static_cast<double>(bytes) / (snapshots * entityCount);
+        std::printf("%10zu %14.1f %14.1f %9.0f%% %12.1f %12.1f %10.2fmm %8.2fmm/s\n", entityCount, protobufPerEntity, perEntity,
+            100.0 * (1.0 - perEntity / protobufPerEntity), encodeNs, decodeNs, maxPositionError * 1000.0f, maxVelocityError * 1000.0f);
+        if (mismatches != 0) {
+            std::cout << "[Bench] Error: " << mismatches << " quantized snapshots decoded incorrectly" << std::endl;
+        }
+    }
+    std::cout << "[Bench] quantized: a datagram with the quantization frame adds "
+        << EncodeQuantizedSnapshot(0, frame, true, {}, protobufBuffer) - EncodeQuantizedSnapshot(0, frame, false, {}, protobufBuffer)
+        << " bytes; protobuf sends one datagram per entity (+28 bytes IP/UDP header each)" << std::endl;
+}
+
+struct BenchEntry {
+    std::string_view name;
+    void (*fn)();
+};
+
+const BenchEntry BENCHMARKS[] = {
+    { "broadphase", BenchBroadphase },
+    { "simd", BenchSimdOverlap },
+    { "players", BenchPlayerBatch },
+    { "ccd", BenchContinuousCollision },
+    { "rooms", BenchRoomScaling },
+    { "mapparse", BenchMapParse },
+    { "recv", BenchReceivePath },
+    { "send", BenchSendPath },
+    { "protobuf", BenchProtobufTick },
+    { "batchio", BenchBatchedIo },
+    { "recvpool", BenchReceivePool },
+#ifdef __linux__
+    { "uring", BenchIoUring },
+#endif
+    { "sessions", BenchSessionTable },
+    { "netthread", BenchNetworkThread },
+    { "broadcast", BenchBroadcast },
+    { "delta", BenchDeltaSnapshots },
+    { "quantized", BenchQuantizedCodec },
+    { "tickloop", BenchTickLoop },
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    for (const auto& bench : BENCHMARKS) {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || bench.name == argv[i];
+        }
+        if (selected) {
+            bench.fn();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+// BroadcastScheduler.cpp
+
+#include "BroadcastScheduler.h"
+
+namespace {
+    // 逐位相同才算没有变化：客户端收到的就是这些值，任何变化都应该发出去
+    bool SameState(const PlayerState& a, const PlayerState& b) {
+        return a.pos == b.pos && a.velocity == b.velocity && a.isInAir == b.isInAir && a.hasWon == b.hasWon;
+    }
+}
+
+BroadcastScheduler::BroadcastScheduler(float sendRate) {
+    SetSendRate(sendRate);
+}
+
+void BroadcastScheduler::SetSendRate(float sendRate) {
+    sendRate_ = sendRate;
+    interval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / sendRate));
+}
+
+BroadcastScheduler::Decision BroadcastScheduler::Decide(BroadcastSlot& slot, const PlayerState& state,
+    std::chrono::steady_clock::time_point now) const {
+    if (!slot.hasSent || state.hasWon != slot.lastSent.hasWon) {
+        return Decision::Event;
+    }
+    if (now < slot.nextSendTime) {
+        return Decision::Wait;
+    }
+    if (SameState(state, slot.lastSent) && now - slot.lastSendTime < BROADCAST_KEEPALIVE_INTERVAL) {
+        Advance(slot, now);
+        return Decision::Unchanged;
+    }
+    return Decision::Send;
+}
+
+void BroadcastScheduler::MarkSent(BroadcastSlot& slot, const PlayerState& state, std::chrono::steady_clock::time_point now) const {
+    if (!slot.hasSent) {
+        slot.nextSendTime = now;
+    }
+    slot.hasSent = true;
+    slot.lastSent = state;
+    slot.lastSendTime = now;
+    Advance(slot, now);
+}
+
+void BroadcastScheduler::Advance(BroadcastSlot& slot, std::chrono::steady_clock::time_point now) const {
+    slot.nextSendTime += interval_;
+    if (slot.nextSendTime <= now) {
+        slot.nextSendTime = now + interval_;
+    }
+}
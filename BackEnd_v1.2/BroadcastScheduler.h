@@ -0,0 +1,58 @@
+// BroadcastScheduler.h
+#pragma once
+
+#include "3DPos.h"
+#include <chrono>
+#include <cstdint>
+
+// 状态没有变化时，至少每隔这么久仍发送一次，弥补丢失的数据报
+const auto BROADCAST_KEEPALIVE_INTERVAL = std::chrono::seconds(1);
+
+// 一个客户端（玩家槽位）的广播进度
+struct BroadcastSlot {
+    bool hasSent = false;
+    std::chrono::steady_clock::time_point nextSendTime; // 下一次按频率发送的时间
+    std::chrono::steady_clock::time_point lastSendTime;
+    PlayerState lastSent;                               // 上一次发出的状态
+};
+
+// 广播统计（每个房间一份），由打印统计的一方读取后清零
+struct BroadcastStats {
+    uint64_t sent = 0;             // 发出的状态（含事件触发的）
+    uint64_t eventSent = 0;        // 其中因事件（新加入、胜利状态变化）立即发出的
+    uint64_t deltaSent = 0;        // 其中编码为差量快照的
+    uint64_t skippedUnchanged = 0; // 到了发送时间但状态没有变化而跳过的
+    uint64_t bytes = 0;            // 发出的状态字节数（UDP 负载）
+    double cpuUs = 0.0;            // 判断、序列化与投递发送所花的时间
+};
+
+// 状态广播调度：把发给客户端的状态频率与主循环频率解耦
+// - 每个客户端按 sendRate 发送，发送时间按客户端各自计算（客户端加入的时间不同，发送自然错开）
+// - 到了发送时间但状态与上次发出的完全相同时跳过，只在超过 BROADCAST_KEEPALIVE_INTERVAL 后补发一次
+// - 新加入的客户端以及 hasWon 变化等事件不等发送时间，立即发送
+class BroadcastScheduler {
+public:
+    enum class Decision : uint8_t {
+        Wait,      // 还没到发送时间
+        Unchanged, // 到了发送时间但状态没有变化，跳过
+        Send,      // 按频率发送
+        Event,     // 事件触发，立即发送
+    };
+
+    explicit BroadcastScheduler(float sendRate = 60.0f);
+
+    void SetSendRate(float sendRate);
+    float SendRate() const { return sendRate_; }
+
+    // 判断本次是否向该客户端发送状态 state；Unchanged 时顺延下一次发送时间
+    Decision Decide(BroadcastSlot& slot, const PlayerState& state, std::chrono::steady_clock::time_point now) const;
+    // 状态已经发出：记录发出的状态并计算下一次发送时间
+    void MarkSent(BroadcastSlot& slot, const PlayerState& state, std::chrono::steady_clock::time_point now) const;
+
+private:
+    // 下一次发送时间按固定间隔递增，避免频率随主循环抖动漂移；落后超过一个间隔时从当前时间重新开始
+    void Advance(BroadcastSlot& slot, std::chrono::steady_clock::time_point now) const;
+
+    float sendRate_ = 60.0f;
+    std::chrono::steady_clock::duration interval_;
+};
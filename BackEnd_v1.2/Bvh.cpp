@@ -0,0 +1,206 @@
+// Bvh.cpp
+
+#include "Bvh.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+namespace {
+    constexpr uint32_t MAX_LEAF_SIZE = 4;     // 图元数不超过该值时直接作为叶子
+    constexpr uint32_t MAX_FORCED_LEAF = 16;  // SAH认为不值得细分时，允许的最大叶子
+    constexpr int SAH_BIN_COUNT = 12;         // 每个轴的分箱数
+    constexpr int MAX_SAH_DEPTH = 64;         // 超过该深度改用中位数切分，保证树高有界
+
+    float SurfaceArea(const AABB& box) {
+        Struct3D e = box.max - box.min;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    float Axis(const Struct3D& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    AABB EmptyBounds() {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        return { { inf, inf, inf }, { -inf, -inf, -inf } };
+    }
+
+    bool Overlaps(const AABB& a, const AABB& b) {
+        return a.max.x >= b.min.x && a.min.x <= b.max.x &&
+            a.max.y >= b.min.y && a.min.y <= b.max.y &&
+            a.max.z >= b.min.z && a.min.z <= b.max.z;
+    }
+}
+
+void Bvh::Clear() {
+    nodes_.clear();
+    primIndices_.clear();
+}
+
+void Bvh::Assign(std::vector<BvhNode> nodes, std::vector<uint32_t> primIndices) {
+    nodes_ = std::move(nodes);
+    primIndices_ = std::move(primIndices);
+}
+
+void Bvh::Build(const std::vector<AABB>& boxes) {
+    Clear();
+    if (boxes.empty()) {
+        return;
+    }
+
+    std::vector<Struct3D> centroids(boxes.size());
+    primIndices_.resize(boxes.size());
+    for (uint32_t i = 0; i < boxes.size(); ++i) {
+        centroids[i] = (boxes[i].min + boxes[i].max) * 0.5f;
+        primIndices_[i] = i;
+    }
+
+    nodes_.reserve(boxes.size() * 2);
+    BuildRecursive(0, static_cast<uint32_t>(boxes.size()), 0, boxes, centroids);
+    nodes_.shrink_to_fit();
+}
+
+AABB Bvh::ComputeBounds(uint32_t first, uint32_t count, const std::vector<AABB>& boxes) const {
+    AABB bounds = EmptyBounds();
+    for (uint32_t i = first; i < first + count; ++i) {
+        bounds = MergeAABB(bounds, boxes[primIndices_[i]]);
+    }
+    return bounds;
+}
+
+uint32_t Bvh::BuildRecursive(uint32_t first, uint32_t count, int depth,
+    const std::vector<AABB>& boxes, const std::vector<Struct3D>& centroids) {
+    const uint32_t nodeIndex = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back({});
+    const AABB bounds = ComputeBounds(first, count, boxes);
+
+    auto makeLeaf = [&]() {
+        nodes_[nodeIndex] = { bounds, first, count };
+        return nodeIndex;
+    };
+    if (count <= MAX_LEAF_SIZE) {
+        return makeLeaf();
+    }
+
+    // 图元中心点的包围盒，分箱在它上面进行
+    AABB centroidBounds = EmptyBounds();
+    for (uint32_t i = first; i < first + count; ++i) {
+        const Struct3D& c = centroids[primIndices_[i]];
+        centroidBounds = MergeAABB(centroidBounds, { c, c });
+    }
+
+    auto begin = primIndices_.begin() + first;
+    auto end = begin + count;
+    uint32_t leftCount = 0;
+
+    if (depth < MAX_SAH_DEPTH) {
+        // 分箱SAH：在每个轴上把中心点分成若干箱，评估每个箱边界作为切分面的代价
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; ++axis) {
+            float cmin = Axis(centroidBounds.min, axis);
+            float cmax = Axis(centroidBounds.max, axis);
+            if (cmax - cmin <= 1e-6f) {
+                continue; // 该轴上所有中心点重合，无法切分
+            }
+            std::array<AABB, SAH_BIN_COUNT> binBounds;
+            std::array<uint32_t, SAH_BIN_COUNT> binCounts{};
+            binBounds.fill(EmptyBounds());
+            const float scale = SAH_BIN_COUNT / (cmax - cmin);
+            for (uint32_t i = first; i < first + count; ++i) {
+                uint32_t prim = primIndices_[i];
+                int bin = std::min(SAH_BIN_COUNT - 1, static_cast<int>((Axis(centroids[prim], axis) - cmin) * scale));
+                ++binCounts[bin];
+                binBounds[bin] = MergeAABB(binBounds[bin], boxes[prim]);
+            }
+            // 从右往左累积，得到每个切分面右侧的面积与数量
+            std::array<float, SAH_BIN_COUNT - 1> rightArea{};
+            std::array<uint32_t, SAH_BIN_COUNT - 1> rightCount{};
+            AABB acc = EmptyBounds();
+            uint32_t accCount = 0;
+            for (int b = SAH_BIN_COUNT - 1; b > 0; --b) {
+                acc = MergeAABB(acc, binBounds[b]);
+                accCount += binCounts[b];
+                rightArea[b - 1] = accCount ? SurfaceArea(acc) : 0.0f;
+                rightCount[b - 1] = accCount;
+            }
+            // 从左往右累积并计算代价 A_left * N_left + A_right * N_right
+            acc = EmptyBounds();
+            accCount = 0;
+            for (int b = 0; b < SAH_BIN_COUNT - 1; ++b) {
+                acc = MergeAABB(acc, binBounds[b]);
+                accCount += binCounts[b];
+                if (accCount == 0 || rightCount[b] == 0) {
+                    continue;
+                }
+                float cost = SurfaceArea(acc) * accCount + rightArea[b] * rightCount[b];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        // 细分的代价不低于直接作为叶子时，小节点就不再细分
+        const float leafCost = SurfaceArea(bounds) * count;
+        if ((bestAxis < 0 || bestCost >= leafCost) && count <= MAX_FORCED_LEAF) {
+            return makeLeaf();
+        }
+        if (bestAxis >= 0) {
+            const float cmin = Axis(centroidBounds.min, bestAxis);
+            const float scale = SAH_BIN_COUNT / (Axis(centroidBounds.max, bestAxis) - cmin);
+            auto mid = std::partition(begin, end, [&](uint32_t prim) {
+                int bin = std::min(SAH_BIN_COUNT - 1, static_cast<int>((Axis(centroids[prim], bestAxis) - cmin) * scale));
+                return bin <= bestSplit;
+            });
+            leftCount = static_cast<uint32_t>(mid - begin);
+        }
+    }
+
+    // SAH无法给出有效切分（或树已过深）：沿中心点跨度最大的轴按中位数切分
+    if (leftCount == 0 || leftCount == count) {
+        Struct3D extent = centroidBounds.max - centroidBounds.min;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        leftCount = count / 2;
+        std::nth_element(begin, begin + leftCount, end, [&](uint32_t a, uint32_t b) {
+            return Axis(centroids[a], axis) < Axis(centroids[b], axis);
+        });
+    }
+
+    // 左孩子紧跟在当前节点之后（深度优先布局），右孩子的下标记录在节点中
+    BuildRecursive(first, leftCount, depth + 1, boxes, centroids);
+    uint32_t rightIndex = BuildRecursive(first + leftCount, count - leftCount, depth + 1, boxes, centroids);
+    nodes_[nodeIndex] = { bounds, rightIndex, 0 };
+    return nodeIndex;
+}
+
+void Bvh::Query(const AABB& box, std::vector<uint32_t>& out) const {
+    if (nodes_.empty()) {
+        return;
+    }
+    std::array<uint32_t, QUERY_STACK_SIZE> stack;
+    int top = 0;
+    uint32_t nodeIndex = 0;
+    while (true) {
+        const BvhNode& node = nodes_[nodeIndex];
+        if (Overlaps(node.bounds, box)) {
+            if (node.IsLeaf()) {
+                out.insert(out.end(), primIndices_.begin() + node.leftOrFirst,
+                    primIndices_.begin() + node.leftOrFirst + node.count);
+            }
+            else {
+                // 先访问左孩子，右孩子入栈
+                stack[top++] = node.leftOrFirst;
+                nodeIndex = nodeIndex + 1;
+                continue;
+            }
+        }
+        if (top == 0) {
+            break;
+        }
+        nodeIndex = stack[--top];
+    }
+}
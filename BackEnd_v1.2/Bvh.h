@@ -0,0 +1,50 @@
+// Bvh.h
+#pragma once
+
+#include "3DPos.h"
+#include <vector>
+#include <cstdint>
+
+// 扁平化的BVH节点，32字节，按深度优先顺序连续存放
+// 内部节点：左孩子紧跟在自身之后，leftOrFirst 为右孩子下标
+// 叶子节点：leftOrFirst 为其第一个图元在 primIndices_ 中的位置，count 为图元个数
+struct BvhNode {
+    AABB bounds;
+    uint32_t leftOrFirst = 0;
+    uint32_t count = 0; // 0 表示内部节点
+
+    bool IsLeaf() const { return count > 0; }
+};
+
+// 静态关卡几何的包围体层次结构(BVH)
+// 使用分箱SAH(表面积启发式)构建，适合障碍物分布很不均匀的关卡：
+// 密集的尖刺簇会被细分，大片空旷区域只占很少的节点
+class Bvh {
+public:
+    // 查询时的遍历栈大小：树中任一路径上的内部节点数不能超过它（构建保证远小于它，载入的节点数组须先检查）
+    static constexpr uint32_t QUERY_STACK_SIZE = 128;
+
+    void Build(const std::vector<AABB>& boxes);
+    void Clear();
+
+    // 将与 box 相交的叶子中的障碍物下标追加到 out 中（每个下标最多出现一次，顺序不定）
+    void Query(const AABB& box, std::vector<uint32_t>& out) const;
+
+    bool Empty() const { return nodes_.empty(); }
+    size_t NodeCount() const { return nodes_.size(); }
+
+    // 直接访问/恢复扁平化的节点数组，用于预编译地图的保存与载入（跳过SAH构建）
+    const std::vector<BvhNode>& Nodes() const { return nodes_; }
+    const std::vector<uint32_t>& PrimIndices() const { return primIndices_; }
+    void Assign(std::vector<BvhNode> nodes, std::vector<uint32_t> primIndices);
+
+private:
+    // 为 primIndices_[first, first + count) 递归构建子树，返回子树根节点下标
+    uint32_t BuildRecursive(uint32_t first, uint32_t count, int depth,
+        const std::vector<AABB>& boxes, const std::vector<Struct3D>& centroids);
+    // 计算节点内图元的包围盒
+    AABB ComputeBounds(uint32_t first, uint32_t count, const std::vector<AABB>& boxes) const;
+
+    std::vector<BvhNode> nodes_;
+    std::vector<uint32_t> primIndices_; // 叶子引用的障碍物下标
+};
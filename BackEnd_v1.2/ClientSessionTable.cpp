@@ -0,0 +1,117 @@
+// ClientSessionTable.cpp
+
+#include "ClientSessionTable.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+    // splitmix64 的最终混合步骤，把端口和地址的每一位都扩散到结果中
+    uint64_t Mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+std::atomic<uint32_t> ClientSessionTable::nextSessionId_{ 1 };
+
+ClientSessionTable::ClientSessionTable(size_t maxSessions)
+    : maxSessions_(maxSessions) {
+    const size_t bucketCount = std::bit_ceil(std::max<size_t>(maxSessions * 2, 16));
+    bucketMask_ = bucketCount - 1;
+    buckets_.resize(bucketCount);
+    sessions_.reserve(maxSessions);
+}
+
+uint32_t ClientSessionTable::HashEndpoint(const asio::ip::udp::endpoint& endpoint) {
+    uint64_t h = endpoint.port();
+    const asio::ip::address address = endpoint.address();
+    if (address.is_v4()) {
+        h ^= static_cast<uint64_t>(address.to_v4().to_uint()) << 16;
+    }
+    else {
+        const auto bytes = address.to_v6().to_bytes();
+        uint64_t high = 0;
+        uint64_t low = 0;
+        std::memcpy(&high, bytes.data(), sizeof(high));
+        std::memcpy(&low, bytes.data() + sizeof(high), sizeof(low));
+        h = Mix(h ^ high) ^ low;
+    }
+    return static_cast<uint32_t>(Mix(h));
+}
+
+size_t ClientSessionTable::FindBucket(const asio::ip::udp::endpoint& endpoint, uint32_t hash) const {
+    size_t bucket = hash & bucketMask_;
+    while (true) {
+        const Bucket& b = buckets_[bucket];
+        if (b.session == EMPTY_BUCKET || (b.hash == hash && sessions_[b.session].endpoint == endpoint)) {
+            return bucket;
+        }
+        bucket = (bucket + 1) & bucketMask_;
+    }
+}
+
+ClientSession* ClientSessionTable::Find(const asio::ip::udp::endpoint& endpoint) {
+    const Bucket& b = buckets_[FindBucket(endpoint, HashEndpoint(endpoint))];
+    return b.session == EMPTY_BUCKET ? nullptr : &sessions_[b.session];
+}
+
+ClientSession* ClientSessionTable::Insert(const asio::ip::udp::endpoint& endpoint, uint32_t playerSlot) {
+    if (sessions_.size() >= maxSessions_) {
+        return nullptr;
+    }
+    const uint32_t hash = HashEndpoint(endpoint);
+    Bucket& b = buckets_[FindBucket(endpoint, hash)];
+    if (b.session != EMPTY_BUCKET) {
+        return nullptr;
+    }
+    b.session = static_cast<uint32_t>(sessions_.size());
+    b.hash = hash;
+
+    ClientSession& session = sessions_.emplace_back();
+    session.id = nextSessionId_.fetch_add(1, std::memory_order_relaxed);
+    session.playerSlot = playerSlot;
+    session.endpoint = endpoint;
+    session.connectedTime = std::chrono::steady_clock::now();
+    session.lastReceiveTime = session.connectedTime;
+    return &session;
+}
+
+bool ClientSessionTable::Erase(const asio::ip::udp::endpoint& endpoint) {
+    size_t hole = FindBucket(endpoint, HashEndpoint(endpoint));
+    const uint32_t removed = buckets_[hole].session;
+    if (removed == EMPTY_BUCKET) {
+        return false;
+    }
+
+    // 向后移动删除：把探测链上后面的元素前移填补空位，直到遇到空桶或已在理想位置上的元素
+    size_t next = (hole + 1) & bucketMask_;
+    while (buckets_[next].session != EMPTY_BUCKET) {
+        const size_t ideal = buckets_[next].hash & bucketMask_;
+        // next 元素从 ideal 探测到 next 的距离不小于从 hole 到 next 的距离，说明它可以移到 hole
+        if (((next - ideal) & bucketMask_) >= ((next - hole) & bucketMask_)) {
+            buckets_[hole] = buckets_[next];
+            hole = next;
+        }
+        next = (next + 1) & bucketMask_;
+    }
+    buckets_[hole] = Bucket{};
+
+    // 紧凑数组：把最后一个会话换到被删除的位置，并更新它在索引表中的下标
+    const uint32_t last = static_cast<uint32_t>(sessions_.size() - 1);
+    if (removed != last) {
+        sessions_[removed] = sessions_[last];
+        const uint32_t movedHash = HashEndpoint(sessions_[removed].endpoint);
+        size_t bucket = movedHash & bucketMask_;
+        while (buckets_[bucket].session != last) {
+            bucket = (bucket + 1) & bucketMask_;
+        }
+        buckets_[bucket].session = removed;
+    }
+    sessions_.pop_back();
+    return true;
+}
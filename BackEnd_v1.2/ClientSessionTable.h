@@ -0,0 +1,91 @@
+// ClientSessionTable.h
+#pragma once
+
+#ifndef ASIO_STANDALONE
+#define ASIO_STANDALONE
+#endif
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 每个网络管理器（套接字）最多同时连接的客户端数
+const size_t MAX_CLIENT_SESSIONS = 4096;
+
+// 一个客户端（按UDP端点区分）的会话
+struct ClientSession {
+    uint32_t id = 0;           // 会话编号，进程内递增、不复用（分片之间也不重复）
+    uint32_t room = 0;         // 所在房间在网络管理器房间列表中的下标
+    uint32_t playerSlot = 0;   // 该客户端控制的玩家槽位
+    asio::ip::udp::endpoint endpoint;
+    std::chrono::steady_clock::time_point connectedTime;
+    std::chrono::steady_clock::time_point lastReceiveTime;
+    uint64_t packetsReceived = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+};
+
+// 端点 -> 会话 的表
+// 会话紧凑地存放在数组中（遍历发送状态时连续访问），另有一张开放寻址（线性探测）的索引表把端点映射到数组下标。
+// 索引表的桶数是最大会话数两倍以上的2的幂，负载因子不超过 0.5，查找平均只探测一两个桶；
+// 删除时使用向后移动(backward shift)而不是墓碑，探测链不会随着客户端进出而变长。
+// 所有内存在构造时一次性分配，插入、查找、删除都不分配内存
+class ClientSessionTable {
+public:
+    explicit ClientSessionTable(size_t maxSessions = MAX_CLIENT_SESSIONS);
+
+    // 查找端点对应的会话，不存在时返回 nullptr。返回的指针在下一次 Erase 之前有效
+    ClientSession* Find(const asio::ip::udp::endpoint& endpoint);
+    // 为端点新建会话；表已满或端点已存在时返回 nullptr
+    ClientSession* Insert(const asio::ip::udp::endpoint& endpoint, uint32_t playerSlot);
+    // 删除端点对应的会话，返回是否存在
+    bool Erase(const asio::ip::udp::endpoint& endpoint);
+
+    size_t Size() const { return sessions_.size(); }
+    size_t Capacity() const { return maxSessions_; }
+
+    // 按下标遍历全部会话；回调中可以 Insert（新会话追加在末尾，本次遍历也会访问到），但不能 Erase
+    template <typename Fn>
+    void ForEach(Fn&& fn) {
+        for (size_t i = 0; i < sessions_.size(); ++i) {
+            fn(sessions_[i]);
+        }
+    }
+
+    // 删除所有满足 pred 的会话，删除前对其调用 onErase
+    template <typename Pred, typename OnErase>
+    size_t EraseIf(Pred&& pred, OnErase&& onErase) {
+        size_t erased = 0;
+        // 倒序遍历：删除时被换到当前位置的是已经检查过的末尾元素
+        for (size_t i = sessions_.size(); i-- > 0;) {
+            if (pred(sessions_[i])) {
+                onErase(sessions_[i]);
+                Erase(sessions_[i].endpoint);
+                ++erased;
+            }
+        }
+        return erased;
+    }
+
+    static uint32_t HashEndpoint(const asio::ip::udp::endpoint& endpoint);
+
+private:
+    static constexpr uint32_t EMPTY_BUCKET = UINT32_MAX;
+
+    struct Bucket {
+        uint32_t session = EMPTY_BUCKET; // sessions_ 中的下标
+        uint32_t hash = 0;               // 端点哈希，探测时先比较它，减少端点比较
+    };
+
+    // 返回端点所在的桶，不存在时返回它应当插入的空桶
+    size_t FindBucket(const asio::ip::udp::endpoint& endpoint, uint32_t hash) const;
+
+    size_t maxSessions_;
+    size_t bucketMask_;
+    std::vector<Bucket> buckets_;
+    std::vector<ClientSession> sessions_;
+    static std::atomic<uint32_t> nextSessionId_;
+};
@@ -1,293 +1,409 @@
 // GameHandler.cpp
 
 #include "GameHandler.h"
-// AsioNetworkManager.h  GameHandler.h УﲻҪظ
-//  GameHandler.cpp ֱʹ AsioNetworkManager ľԱҪ
-// #include "AsioNetworkManager.h" // ȷ AsioNetworkManager ɼ
-
-// GameHandler 캯
+#include "SweptAABB.h"
+#include "MapLoader.h"
+#include "Logger.h"
+// AsioNetworkManager.h 包含在 GameHandler.h 中，这里不需要重复包含，
+// 但如果 GameHandler.cpp 中直接使用了 AsioNetworkManager 的具体成员，则可能需要
+// #include "AsioNetworkManager.h" // 确保 AsioNetworkManager 的完整定义可见
+
+// GameHandler 构造函数
 GameHandler::GameHandler() {
-    Initialize(); // óʼúصͼ
+    Initialize(); // 调用初始化函数，该函数将加载地图
+}
+
+GameHandler::GameHandler(std::string mapFile) : mapFile_(std::move(mapFile)) {
+    Initialize();
 }
 
-// ʼϷ״̬ļصͼ
+// 初始化游戏状态，包括从文件加载地图数据
 void GameHandler::Initialize() {
-    nowPlayerState_ = {}; // ״̬
-    currentInput_ = {};   // ״̬
-
-    // صͼ
-    currentMap_ = LoadMapFromFile(GameConstants::DEFAULT_MAP_FILE);
-    if (!currentMap_.loadedSuccessfully) {
-        std::cerr << "[Game] Error: Failed to load map data from " << GameConstants::DEFAULT_MAP_FILE
-            << ". Using empty map." << std::endl;
-        // ѡһĬϵĿյͼ׳쳣
-        currentMap_.obstacles.clear();
-        currentMap_.victoryPoint = { 0.0f, 0.0f, 10.0f }; // һĬʤԷһ
+    players_.Clear();     // 重置所有玩家状态与输入
+    players_.Add();       // 主玩家，占用 PRIMARY_PLAYER_SLOT
+
+    // 加载地图数据
+    // 存在预编译的二进制地图时直接映射载入，否则解析文本地图
+    auto mapData = std::make_shared<MapData>(LoadMap(mapFile_));
+    if (!mapData->loadedSuccessfully) {
+        LOG_ERROR("[Game] Error: Failed to load map data from %s. Using empty map.", mapFile_.c_str());
+        // 可以选择加载一个默认的空地图或者抛出异常
+        mapData->obstacles.clear();
+        mapData->bounds = {};
+        mapData->victoryPoint = { 0.0f, 0.0f, 10.0f }; // 设置一个默认胜利点以防万一
     }
     else {
-        std::cout << "[Game] Map data loaded successfully from " << GameConstants::DEFAULT_MAP_FILE << "." << std::endl;
-        std::cout << "[Game] Loaded " << currentMap_.obstacles.size() << " obstacles." << std::endl;
-        std::cout << "[Game] Victory point set to: ("
-            << currentMap_.victoryPoint.x << ", "
-            << currentMap_.victoryPoint.y << ", "
-            << currentMap_.victoryPoint.z << ")." << std::endl;
+        LOG_INFO("[Game] Map data loaded successfully from %s.", mapFile_.c_str());
+        LOG_INFO("[Game] Loaded %zu obstacles.", mapData->obstacles.size());
+        LOG_INFO("[Game] Victory point set to: (%g, %g, %g).",
+            mapData->victoryPoint.x, mapData->victoryPoint.y, mapData->victoryPoint.z);
     }
-    std::cout << "[Game] Game state initialized/reset." << std::endl;
+    currentMap_ = std::move(mapData);
+    // 重新开始监视，热重载从刚载入的地图继续
+    if (mapWatcher_) {
+        mapWatcher_.reset();
+        SetMapHotReload(true);
+    }
+    LOG_INFO("[Game] Game state initialized/reset.");
 }
 
-
-// ļصͼ
-// ļʽ:
-// һ: victory_point x y z
-// ֮ÿ: obstacle_aabb min_x min_y min_z max_x max_y max_z
-MapData GameHandler::LoadMapFromFile(const std::string& filename) {
-    MapData mapData;
-    mapData.loadedSuccessfully = false; // Ĭϼʧ
-    std::ifstream mapFile(filename);
-    std::string line;
-
-    if (!mapFile.is_open()) {
-        std::cerr << "[Game] Error: Could not open map file: " << filename << std::endl;
-        return mapData; // ؼʧܵMapData
+AABB GameHandler::LevelBounds() const {
+    const Struct3D spawn = PlayerState{}.pos;
+    AABB bounds = MergeAABB({ spawn, spawn }, { currentMap_->victoryPoint, currentMap_->victoryPoint });
+    if (!currentMap_->obstacles.empty()) {
+        bounds = MergeAABB(bounds, currentMap_->bounds);
     }
+    return bounds;
+}
 
-    // ȡʤ
-    if (std::getline(mapFile, line)) {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
-        if (type == "victory_point") {
-            iss >> mapData.victoryPoint.x >> mapData.victoryPoint.y >> mapData.victoryPoint.z;
-        }
-        else {
-            std::cerr << "[Game] Error: Invalid map file format. Expected 'victory_point' on the first line." << std::endl;
-            mapFile.close();
-            return mapData; // ؼʧܵMapData
-        }
+void GameHandler::SetMapHotReload(bool enabled) {
+    if (!enabled) {
+        mapWatcher_.reset();
+        return;
     }
-    else {
-        std::cerr << "[Game] Error: Map file is empty or could not read victory point." << std::endl;
-        mapFile.close();
-        return mapData; // ؼʧܵMapData
+    if (!mapWatcher_) {
+        mapWatcher_ = std::make_unique<MapWatcher>(mapFile_, currentMap_);
+        mapGeneration_ = mapWatcher_->Generation();
     }
+}
 
-    // ȡϰ
-    while (std::getline(mapFile, line)) {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
-        if (type == "obstacle_aabb") {
-            AABB obstacle;
-            iss >> obstacle.min.x >> obstacle.min.y >> obstacle.min.z
-                >> obstacle.max.x >> obstacle.max.y >> obstacle.max.z;
-            mapData.obstacles.push_back(obstacle);
-        }
-        else if (!line.empty() && line[0] != '#') { // Կкע
-            std::cerr << "[Game] Warning: Skipping invalid line in map file: " << line << std::endl;
-        }
+void GameHandler::SyncMap() {
+    // 只读一次原子计数；后台线程发布了新地图时切换到它，本帧之后都使用新地图
+    uint64_t generation = mapWatcher_->Generation();
+    if (generation != mapGeneration_) {
+        mapGeneration_ = generation;
+        currentMap_ = mapWatcher_->Current();
+        LOG_INFO("[Game] Switched to reloaded map (%zu obstacles).", currentMap_->obstacles.size());
     }
-
-    mapFile.close();
-    mapData.loadedSuccessfully = true; // Ǽسɹ
-    return mapData;
 }
 
 
 void GameHandler::ProcessInput(const PlayerInputState& input) {
-    currentInput_ = input;
+    ProcessInput(PRIMARY_PLAYER_SLOT, input);
 }
 
-void GameHandler::Update(float deltaTime) {
-    // Ѿʤ򲻸Ϸ߼
-    if (nowPlayerState_.hasWon) {
-        // ѡԾ룬ֹʤյԾָӰ״̬
-        currentInput_.jumpPressed = false;
-        return;
+void GameHandler::ProcessInput(uint32_t slot, const PlayerInputState& input) {
+    if (players_.IsActive(slot)) {
+        players_.SetInput(slot, input);
     }
+}
+
+uint32_t GameHandler::AddPlayer() {
+    return players_.Add();
+}
 
-    // 1. Ŀˮƽٶ
-    Struct3D targetVelocity = { 0.0f, nowPlayerState_.velocity.y, 0.0f };
-    if (currentInput_.moveForward)  targetVelocity.z += GameConstants::MOVE_SPEED;
-    if (currentInput_.moveBackward) targetVelocity.z -= GameConstants::MOVE_SPEED;
-    if (currentInput_.moveLeft)   targetVelocity.x -= GameConstants::MOVE_SPEED;
-    if (currentInput_.moveRight)  targetVelocity.x += GameConstants::MOVE_SPEED;
-
-    nowPlayerState_.velocity.x = targetVelocity.x;
-    nowPlayerState_.velocity.z = targetVelocity.z;
-
-    // 2. Ծ
-    if (currentInput_.jumpPressed && !nowPlayerState_.isInAir) {
-        nowPlayerState_.velocity.y = GameConstants::JUMP_FORCE;
-        nowPlayerState_.isInAir = true;
-        // std::cout << "[Game] Jump initiated!" << std::endl; // ԰豣Ƴ־
+void GameHandler::AddPlayerAt(uint32_t slot) {
+    players_.AddAt(slot);
+}
+
+void GameHandler::RemovePlayer(uint32_t slot) {
+    if (slot != PRIMARY_PLAYER_SLOT) { // 主玩家槽位始终保留
+        players_.Remove(slot);
+    }
+}
+
+PlayerState GameHandler::GetPlayerState(uint32_t slot) const {
+    return players_.IsActive(slot) ? players_.Get(slot) : PlayerState{};
+}
+
+void GameHandler::SetPlayerState(uint32_t slot, const PlayerState& state) {
+    if (players_.IsActive(slot)) {
+        players_.Set(slot, state);
     }
+}
 
-    // 3. Ӧ
-    if (nowPlayerState_.isInAir) {
-        nowPlayerState_.velocity.y -= GameConstants::GRAVITY * deltaTime;
-        nowPlayerState_.velocity.y = std::max(nowPlayerState_.velocity.y, GameConstants::MAX_FALL_VELOCITY);
+// 房间内所有玩家以结构数组形式批量模拟：
+// 逐玩家独立的移动/重力/地面步骤是对全部玩家的向量化循环，碰撞处理则逐个玩家进行
+void GameHandler::Update(float deltaTime) {
+    // 0. 地图热重载：切换到后台线程发布的新地图
+    if (mapWatcher_) {
+        SyncMap();
     }
-    else {
-        nowPlayerState_.velocity.y = 0;
+
+    // 1~4. 根据输入计算速度、处理跳跃与重力，得出无碰撞时的下一位置（已胜利的玩家不更新）
+    players_.IntegrateMovement(deltaTime);
+
+    // 5. 碰撞检测与处理
+    for (uint32_t slot = 0; slot < players_.Capacity(); ++slot) {
+        if (!players_.simulate[slot]) {
+            continue;
+        }
+        PlayerState player = players_.Get(slot);
+        Struct3D potentialNextPos = { players_.nextX[slot], players_.nextY[slot], players_.nextZ[slot] };
+        players_.collided[slot] = ResolveObstacleCollisions(player, potentialNextPos, deltaTime);
+        // 写回碰撞响应修改过的速度、空中状态与目标位置
+        players_.velX[slot] = player.velocity.x;
+        players_.velY[slot] = player.velocity.y;
+        players_.velZ[slot] = player.velocity.z;
+        players_.isInAir[slot] = player.isInAir;
+        players_.nextX[slot] = potentialNextPos.x;
+        players_.nextY[slot] = potentialNextPos.y;
+        players_.nextZ[slot] = potentialNextPos.z;
     }
 
-    // 4. ײʱһλ
-    Struct3D potentialNextPos = nowPlayerState_.pos + (nowPlayerState_.velocity * deltaTime);
+    // 6~7. 检测与地面的碰撞，更新最终位置与空中状态
+    players_.ApplyGroundAndCommit();
+
+    // 8. 检查胜利条件
+    CheckWinCondition();
+
+    // 9. 重置单帧输入事件
+    players_.ClearFrameInputs();
+}
 
-    // 5. ײ봦
-    PlayerState nextState = nowPlayerState_;
+// 处理单个玩家与静态障碍物的碰撞，potentialNextPos 为无碰撞时的下一位置，处理后为修正后的位置
+// 碰撞响应会直接修改 player 的速度与空中状态；返回本帧是否发生了碰撞
+bool GameHandler::ResolveObstacleCollisions(PlayerState& player, Struct3D& potentialNextPos, float deltaTime) {
+    // 连续碰撞：位移较大时（低帧率或高速下落）只检测终点会穿过薄平台，
+    // 这里先沿位移扫掠，把目标位置限制在最早接触点之前
+    bool sweptCollision = false;
+    if (continuousCollision_) {
+        potentialNextPos = SweepPlayerMovement(player, player.velocity * deltaTime, sweptCollision);
+    }
+
+    // 5. 碰撞检测与处理
+    PlayerState nextState = player;
     nextState.pos = potentialNextPos;
     AABB playerNextAABB = GetPlayerAABB(nextState);
-    bool collisionOccurredThisFrame = false;
-
-    // 1볡о̬ϰײ (ʹôӵͼļصϰ)
-    for (const auto& obstacle : currentMap_.obstacles) {
+    bool collisionOccurredThisFrame = sweptCollision;
+
+    // 宽相位：只取出玩家本帧扫掠范围（起点与终点的并集）附近的障碍物，
+    // 再向外扩一个玩家尺寸，以容纳碰撞响应产生的推回
+    const Struct3D playerSize = { GameConstants::PLAYER_WIDTH, GameConstants::PLAYER_HEIGHT, GameConstants::PLAYER_DEPTH };
+    AABB queryAABB = ExpandAABB(MergeAABB(GetPlayerAABB(player), playerNextAABB), playerSize);
+    QueryObstacleCandidates(*currentMap_, broadphaseMode_, queryAABB, candidateScratch_);
+
+    // 1）检测与场景中静态障碍物的碰撞 (使用从地图文件加载的障碍物)
+    // 候选按下标升序处理，与线性遍历的处理顺序一致
+    for (size_t cursor = 0; cursor < candidateScratch_.size(); ++cursor) {
+        const uint32_t obstacleIndex = candidateScratch_[cursor];
+        const AABB& obstacle = currentMap_->obstacles[obstacleIndex];
         if (CheckAABBCollision(playerNextAABB, obstacle)) {
-            // std::cout << "[Game] Collision detected with obstacle." << std::endl; // 豣
+            // std::cout << "[Game] Collision detected with obstacle." << std::endl; // 按需保留
             collisionOccurredThisFrame = true;
 
-            // 򻯵ײӦƻأֹͣڸ÷ϵٶ
-            // صСᣬϵص
+            // 简化的碰撞响应：将玩家推回，并停止在该方向上的速度
+            // 查找重叠最小的轴，计算各轴上的重叠量
             float overlapX = 0.0f, overlapY = 0.0f, overlapZ = 0.0f;
 
-            // Xص
+            // 计算X轴重叠
             if (playerNextAABB.max.x > obstacle.min.x && playerNextAABB.min.x < obstacle.max.x) {
                 overlapX = std::min(playerNextAABB.max.x - obstacle.min.x, obstacle.max.x - playerNextAABB.min.x);
             }
-            // Yص
+            // 计算Y轴重叠
             if (playerNextAABB.max.y > obstacle.min.y && playerNextAABB.min.y < obstacle.max.y) {
                 overlapY = std::min(playerNextAABB.max.y - obstacle.min.y, obstacle.max.y - playerNextAABB.min.y);
             }
-            // Zص
+            // 计算Z轴重叠
             if (playerNextAABB.max.z > obstacle.min.z && playerNextAABB.min.z < obstacle.max.z) {
                 overlapZ = std::min(playerNextAABB.max.z - obstacle.min.z, obstacle.max.z - playerNextAABB.min.z);
             }
 
-            // ȴYײ (½ײͷ)
+            // 优先处理Y轴碰撞 (着陆或撞头)
             if (overlapY > 0 && (overlapX == 0 || overlapY <= overlapX) && (overlapZ == 0 || overlapY <= overlapZ)) {
-                if (nowPlayerState_.velocity.y <= 0 && playerNextAABB.min.y < obstacle.max.y && nowPlayerState_.pos.y >= obstacle.max.y - GameConstants::PLAYER_HEIGHT * 0.5f) { // ˶ʱײ
-                    potentialNextPos.y = obstacle.max.y; // ȷŵϰﶥ
-                    nowPlayerState_.velocity.y = 0;
-                    nowPlayerState_.isInAir = false;
+                if (player.velocity.y <= 0 && playerNextAABB.min.y < obstacle.max.y && player.pos.y >= obstacle.max.y - GameConstants::PLAYER_HEIGHT * 0.5f) { // 向下运动时撞到顶部
+                    potentialNextPos.y = obstacle.max.y; // 精确放到障碍物顶部
+                    player.velocity.y = 0;
+                    player.isInAir = false;
                     // std::cout << "[Game] Landed on obstacle." << std::endl;
                 }
-                else if (nowPlayerState_.velocity.y > 0 && playerNextAABB.max.y > obstacle.min.y && nowPlayerState_.pos.y <= obstacle.min.y + GameConstants::PLAYER_HEIGHT * 0.5f) { // ˶ʱײײ
-                    potentialNextPos.y = obstacle.min.y - GameConstants::PLAYER_HEIGHT; // ȷŵϰ·
-                    nowPlayerState_.velocity.y = 0; // ײͷֹͣϵٶ
+                else if (player.velocity.y > 0 && playerNextAABB.max.y > obstacle.min.y && player.pos.y <= obstacle.min.y + GameConstants::PLAYER_HEIGHT * 0.5f) { // 向上运动时撞到底部
+                    potentialNextPos.y = obstacle.min.y - GameConstants::PLAYER_HEIGHT; // 精确放到障碍物下方
+                    player.velocity.y = 0; // 撞头，停止向上的速度
                     // std::cout << "[Game] Hit obstacle underside." << std::endl;
                 }
             }
-            // δXײ
+            // 其次处理X轴碰撞
             else if (overlapX > 0 && (overlapY == 0 || overlapX <= overlapY) && (overlapZ == 0 || overlapX <= overlapZ)) {
                 float pushBackEpsilon = 0.001f;
-                if (nowPlayerState_.velocity.x > 0 && playerNextAABB.max.x > obstacle.min.x) { //
+                if (player.velocity.x > 0 && playerNextAABB.max.x > obstacle.min.x) { //向右
                     potentialNextPos.x = obstacle.min.x - GameConstants::PLAYER_WIDTH * 0.5f - pushBackEpsilon;
-                    nowPlayerState_.velocity.x = 0;
+                    player.velocity.x = 0;
                 }
-                else if (nowPlayerState_.velocity.x < 0 && playerNextAABB.min.x < obstacle.max.x) { //
+                else if (player.velocity.x < 0 && playerNextAABB.min.x < obstacle.max.x) { //向左
                     potentialNextPos.x = obstacle.max.x + GameConstants::PLAYER_WIDTH * 0.5f + pushBackEpsilon;
-                    nowPlayerState_.velocity.x = 0;
+                    player.velocity.x = 0;
                 }
                 // std::cout << "[Game] Hit obstacle side (X)." << std::endl;
             }
-            // Zײ
+            // 最后处理Z轴碰撞
             else if (overlapZ > 0) {
                 float pushBackEpsilon = 0.001f;
-                if (nowPlayerState_.velocity.z > 0 && playerNextAABB.max.z > obstacle.min.z) { //ǰ
+                if (player.velocity.z > 0 && playerNextAABB.max.z > obstacle.min.z) { //向前
                     potentialNextPos.z = obstacle.min.z - GameConstants::PLAYER_DEPTH * 0.5f - pushBackEpsilon;
-                    nowPlayerState_.velocity.z = 0;
+                    player.velocity.z = 0;
                 }
-                else if (nowPlayerState_.velocity.z < 0 && playerNextAABB.min.z < obstacle.max.z) { //
+                else if (player.velocity.z < 0 && playerNextAABB.min.z < obstacle.max.z) { //向后
                     potentialNextPos.z = obstacle.max.z + GameConstants::PLAYER_DEPTH * 0.5f + pushBackEpsilon;
-                    nowPlayerState_.velocity.z = 0;
+                    player.velocity.z = 0;
                 }
                 // std::cout << "[Game] Hit obstacle side (Z)." << std::endl;
             }
-            // ײ¼ҵAABBΪλÿѾı
-            nextState.pos = potentialNextPos; // ʱ״̬λ
-            playerNextAABB = GetPlayerAABB(nextState); // »ȡAABB
+            // 碰撞后重新计算玩家的AABB，因为位置可能已经改变
+            nextState.pos = potentialNextPos; // 更新临时状态的位置
+            playerNextAABB = GetPlayerAABB(nextState); // 重新获取AABB
+
+            // 推回可能把玩家移出查询盒（例如被推到大障碍物的另一侧），
+            // 此时以新位置重新查询，并只继续处理下标更大的障碍物
+            if (!ContainsAABB(queryAABB, playerNextAABB)) {
+                queryAABB = ExpandAABB(playerNextAABB, playerSize);
+                QueryObstacleCandidates(*currentMap_, broadphaseMode_, queryAABB, candidateScratch_);
+                cursor = std::upper_bound(candidateScratch_.begin(), candidateScratch_.end(), obstacleIndex)
+                    - candidateScratch_.begin() - 1;
+            }
         }
     }
 
 
-    // 2ײ
-    bool landedOnGroundThisFrame = false;
-    if (potentialNextPos.y <= GameConstants::GROUND_LEVEL_Y && nowPlayerState_.velocity.y <= 0) {
-        if (!nowPlayerState_.isInAir) { // Ѿڵ
-            potentialNextPos.y = GameConstants::GROUND_LEVEL_Y;
+    return collisionOccurredThisFrame;
+}
+
+// 检查玩家是否到达胜利点
+void GameHandler::CheckWinCondition() {
+    if (!currentMap_->loadedSuccessfully) { // 只有在地图加载成功时检查
+        return;
+    }
+    for (uint32_t slot = 0; slot < players_.Capacity(); ++slot) {
+        if (!players_.simulate[slot]) { // 未在用或已经胜利
+            continue;
         }
-        else { // սӴ
-            potentialNextPos.y = GameConstants::GROUND_LEVEL_Y;
-            nowPlayerState_.velocity.y = 0;
-            nowPlayerState_.isInAir = false;
-            landedOnGroundThisFrame = true;
-            // std::cout << "[Game] Landed on ground." << std::endl;
+        Struct3D pos = { players_.posX[slot], players_.posY[slot], players_.posZ[slot] };
+        if (pos.IsCloseTo(currentMap_->victoryPoint, 1.0f)) { // 使用较大的容差判断
+            players_.hasWon[slot] = 1;
+            LOG_INFO("[Game] Player %u has reached the victory point!", slot);
+            // 可以在这里触发一些胜利相关的逻辑，例如停止玩家移动
+            players_.velX[slot] = players_.velY[slot] = players_.velZ[slot] = 0.0f;
         }
-        collisionOccurredThisFrame = true;
     }
+}
 
-    // 6. λ
-    nowPlayerState_.pos = potentialNextPos;
 
-    // 7. ¿״̬
-    // ֡û½ϰϣλøڵ棬ڿ
-    if (!landedOnGroundThisFrame && !(!nowPlayerState_.isInAir && collisionOccurredThisFrame && nowPlayerState_.velocity.y == 0)) {
-        if (nowPlayerState_.pos.y > GameConstants::GROUND_LEVEL_Y) {
-            if (!nowPlayerState_.isInAir) { // ֮ǰڵϣڸڵ (ӱԵ)
-                // std::cout << "[Game] Left ground/obstacle." << std::endl;
-            }
-            nowPlayerState_.isInAir = true;
-        }
-    }
+std::optional<std::string> GameHandler::GetStateDataForNetwork() const {
+    return GetStateDataForNetwork(PRIMARY_PLAYER_SLOT);
+}
 
+const game_backend::ServerToClient& GameHandler::FillStateMessage(uint32_t slot) const {
+    const PlayerState player = GetPlayerState(slot);
 
-    // 8. ʤ
-    CheckWinCondition();
+    game_backend::GameState* state_payload = stateMessage_.mutable_state(); // 获取GameState负载
 
+    // 填充位置
+    game_backend::Vector3* pos_proto = state_payload->mutable_position();
+    pos_proto->set_x(player.pos.x);
+    pos_proto->set_y(player.pos.y);
+    pos_proto->set_z(player.pos.z);
 
-    // 9. õ֡¼
-    currentInput_.jumpPressed = false;
+    // 填充速度
+    game_backend::Vector3* vel_proto = state_payload->mutable_velocity();
+    vel_proto->set_x(player.velocity.x);
+    vel_proto->set_y(player.velocity.y);
+    vel_proto->set_z(player.velocity.z);
+
+    // 填充其他状态
+    state_payload->set_is_in_air(player.isInAir);
+    state_payload->set_has_won(player.hasWon); // 同步胜利状态
+    return stateMessage_;
 }
 
-// Ƿ񵽴ʤ
-void GameHandler::CheckWinCondition() {
-    if (!nowPlayerState_.hasWon && currentMap_.loadedSuccessfully) { // ֻڵͼسɹδʤʱ
-        if (nowPlayerState_.pos.IsCloseTo(currentMap_.victoryPoint, 1.0f)) { // ʹýϴݲж
-            nowPlayerState_.hasWon = true;
-            std::cout << "[Game] Player has reached the victory point!" << std::endl;
-            // ﴥһЩʤص߼ֹͣƶ
-            nowPlayerState_.velocity = { 0.0f, 0.0f, 0.0f };
-        }
+std::optional<std::string> GameHandler::GetStateDataForNetwork(uint32_t slot) const {
+    std::string serialized_data;
+    if (!FillStateMessage(slot).SerializeToString(&serialized_data)) {
+        LOG_ERROR_RATE(1, "[Game] Error: Failed to serialize game state!");
+        return std::nullopt;
     }
+    return serialized_data;
 }
 
+size_t GameHandler::SerializeStateTo(std::span<char> out) const {
+    return SerializeStateTo(PRIMARY_PLAYER_SLOT, out);
+}
 
-std::optional<std::string> GameHandler::GetStateDataForNetwork() const {
-    game_backend::ServerToClient server_msg;
-    game_backend::GameState* state_payload = server_msg.mutable_state(); // ȡGameState
+size_t GameHandler::SerializeStateTo(uint32_t slot, std::span<char> out) const {
+    const game_backend::ServerToClient& server_msg = FillStateMessage(slot);
+    // ByteSizeLong 同时缓存了各子消息的大小，直接按缓存的大小写出，不像 SerializeToArray 那样再计算一遍
+    const size_t size = server_msg.ByteSizeLong();
+    if (size > out.size()) {
+        LOG_ERROR_RATE(1, "[Game] Error: Failed to serialize game state (%zu bytes, buffer %zu)!", size, out.size());
+        return 0;
+    }
+    server_msg.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(out.data()));
+    return size;
+}
 
-    // λ
-    game_backend::Vector3* pos_proto = state_payload->mutable_position();
-    pos_proto->set_x(nowPlayerState_.pos.x);
-    pos_proto->set_y(nowPlayerState_.pos.y);
-    pos_proto->set_z(nowPlayerState_.pos.z);
+void GameHandler::SetBroadphaseMode(BroadphaseMode mode) {
+    broadphaseMode_ = mode;
+    LOG_INFO("[Game] Broadphase mode set to: %s", BroadphaseModeName(mode));
+    if (mode == BroadphaseMode::Simd) {
+        LOG_INFO("[Game] SIMD overlap kernel: %s", SimdLevelName(DetectSimdLevel()));
+    }
+}
 
-    // ٶ
-    game_backend::Vector3* vel_proto = state_payload->mutable_velocity();
-    vel_proto->set_x(nowPlayerState_.velocity.x);
-    vel_proto->set_y(nowPlayerState_.velocity.y);
-    vel_proto->set_z(nowPlayerState_.velocity.z);
+void GameHandler::SetContinuousCollision(bool enabled) {
+    continuousCollision_ = enabled;
+    LOG_INFO("[Game] Continuous collision %s.", enabled ? "enabled" : "disabled");
+}
 
-    // ״̬
-    state_payload->set_is_in_air(nowPlayerState_.isInAir);
-    state_payload->set_has_won(nowPlayerState_.hasWon); // ͬʤ״̬
+Struct3D GameHandler::SweepPlayerMovement(PlayerState& player, Struct3D displacement, bool& collided) {
+    // 每次接触后沿接触面滑动，最多处理这么多次接触（角落里最多同时接触三个面）
+    constexpr int MAX_SWEEP_ITERATIONS = 3;
+    const float pushBackEpsilon = 0.001f;
+    const Struct3D queryMargin = { 0.01f, 0.01f, 0.01f };
+    const Struct3D zero = {};
+
+    PlayerState movingState = player;
+    for (int iteration = 0; iteration < MAX_SWEEP_ITERATIONS && displacement != zero; ++iteration) {
+        AABB startAABB = GetPlayerAABB(movingState);
+        AABB endAABB = { startAABB.min + displacement, startAABB.max + displacement };
+        QueryObstacleCandidates(*currentMap_, broadphaseMode_, ExpandAABB(MergeAABB(startAABB, endAABB), queryMargin), candidateScratch_);
+
+        // 找出最早接触的障碍物（时刻相同取下标最小的，保证结果确定）
+        SweepHit earliest;
+        uint32_t earliestIndex = 0;
+        for (uint32_t obstacleIndex : candidateScratch_) {
+            SweepHit hit = SweepAABB(startAABB, displacement, currentMap_->obstacles[obstacleIndex]);
+            if (hit.hit && (!earliest.hit || hit.time < earliest.time)) {
+                earliest = hit;
+                earliestIndex = obstacleIndex;
+            }
+        }
+        if (!earliest.hit) {
+            movingState.pos += displacement;
+            break;
+        }
 
-    std::string serialized_data;
-    if (!server_msg.SerializeToString(&serialized_data)) {
-        std::cerr << "[Game] Error: Failed to serialize game state!" << std::endl;
-        return std::nullopt;
+        collided = true;
+        const AABB& obstacle = currentMap_->obstacles[earliestIndex];
+        movingState.pos += displacement * earliest.time;
+        displacement = displacement * (1.0f - earliest.time);
+
+        // 贴到接触面上（消除浮点误差），去掉法线方向的速度和剩余位移
+        if (earliest.normal.y > 0.0f) { // 落到障碍物顶部
+            movingState.pos.y = obstacle.max.y;
+            player.velocity.y = 0;
+            player.isInAir = false;
+            displacement.y = 0.0f;
+        }
+        else if (earliest.normal.y < 0.0f) { // 撞到障碍物底部
+            movingState.pos.y = obstacle.min.y - GameConstants::PLAYER_HEIGHT;
+            player.velocity.y = 0;
+            displacement.y = 0.0f;
+        }
+        else if (earliest.normal.x != 0.0f) {
+            movingState.pos.x = earliest.normal.x < 0.0f
+                ? obstacle.min.x - GameConstants::PLAYER_WIDTH * 0.5f - pushBackEpsilon
+                : obstacle.max.x + GameConstants::PLAYER_WIDTH * 0.5f + pushBackEpsilon;
+            player.velocity.x = 0;
+            displacement.x = 0.0f;
+        }
+        else {
+            movingState.pos.z = earliest.normal.z < 0.0f
+                ? obstacle.min.z - GameConstants::PLAYER_DEPTH * 0.5f - pushBackEpsilon
+                : obstacle.max.z + GameConstants::PLAYER_DEPTH * 0.5f + pushBackEpsilon;
+            player.velocity.z = 0;
+            displacement.z = 0.0f;
+        }
     }
-    return serialized_data;
+    return movingState.pos;
 }
 
 bool GameHandler::CheckAABBCollision(const AABB& a, const AABB& b) const {
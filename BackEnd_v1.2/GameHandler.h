@@ -2,41 +2,91 @@
 #pragma once
 
 #include "3DPos.h"
+#include "MapData.h"
+#include "PlayerBatch.h"
+#include "MapWatcher.h"
 #include "messages.pb.h" 
 #include <string>
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <optional>
-#include <fstream>  // ļȡ
-#include <sstream>  // ַ
+#include <memory>
+#include <span>
+#include <fstream>  // 用于文件读取
+#include <sstream>  // 用于字符串解析
 
-// ǰ AsioNetworkManagerѭ
-// AsioNetworkManager.h Ҳǰ GameHandler
-// ʵʵĽ߼ ProcessReceivedData .cpp ļʵ֣԰ͷļ
+// 前向声明 AsioNetworkManager，避免循环依赖问题
+// AsioNetworkManager.h 中也前向声明了 GameHandler
+// 实际的交互逻辑（如 ProcessReceivedData）在 .cpp 文件中实现，可以包含两个头文件
 class AsioNetworkManager;
 
 
 class GameHandler {
 public:
-    GameHandler(); // 캯ֻInitialize
-    void Initialize(); // ʼϷ״̬صͼ
+    GameHandler(); // 构造函数现在只调用Initialize，使用默认地图文件
+    explicit GameHandler(std::string mapFile); // 多房间时每个房间加载自己的地图
+    void Initialize(); // 初始化或重置游戏状态，包括加载地图
     void ProcessInput(const PlayerInputState& input);
     void Update(float deltaTime);
+    // 序列化成新的 std::string，每次调用都会分配内存；每帧发送状态用下面的 SerializeStateTo
     std::optional<std::string> GetStateDataForNetwork() const;
+    // 把状态直接序列化到调用方提供的缓冲区（例如网络层的发送缓冲区），返回写入的字节数，失败返回 0
+    // 复用内部的状态消息对象，稳定状态下不分配内存
+    size_t SerializeStateTo(std::span<char> out) const;
+
+    // 多玩家：同一房间内的其他玩家（竞速、观战幽灵等）与主玩家一起批量模拟
+    // 不带槽位参数的接口都作用于主玩家
+    static constexpr uint32_t PRIMARY_PLAYER_SLOT = 0;
+    uint32_t AddPlayer();
+    // 在网络层分配好的槽位上加入玩家；槽位已在用（例如主玩家）时保持原状态
+    void AddPlayerAt(uint32_t slot);
+    void RemovePlayer(uint32_t slot);
+    size_t PlayerCount() const { return players_.ActiveCount(); }
+    void ProcessInput(uint32_t slot, const PlayerInputState& input);
+    PlayerState GetPlayerState(uint32_t slot) const;
+    // 直接设置玩家的状态（位置、速度等），例如传送或在基准测试中摆放玩家；槽位不在用时忽略
+    void SetPlayerState(uint32_t slot, const PlayerState& state);
+    std::optional<std::string> GetStateDataForNetwork(uint32_t slot) const;
+    size_t SerializeStateTo(uint32_t slot, std::span<char> out) const;
+
+    // 切换宽相位模式（默认BVH），可在运行时调用
+    void SetBroadphaseMode(BroadphaseMode mode);
+    BroadphaseMode GetBroadphaseMode() const { return broadphaseMode_; }
+    // 开关连续碰撞检测（默认开启）。关闭后只在位移终点做重叠检测，低帧率下可能穿过薄平台
+    void SetContinuousCollision(bool enabled);
+    // 开关地图热重载（默认关闭）。开启后地图文件变化时在后台线程重新载入，下一帧起生效
+    void SetMapHotReload(bool enabled);
+    // 关卡范围：障碍物、胜利点和出生点的包围盒，随地图（包括热重载）变化。量化编码以它为基准
+    AABB LevelBounds() const;
 
 private:
-    // ͼغ
-    MapData LoadMapFromFile(const std::string& filename);
     bool CheckAABBCollision(const AABB& a, const AABB& b) const;
-    // Ƿ񵽴ʤ
+    // 单个玩家的碰撞处理（连续碰撞 + 重叠推回），返回本帧是否与障碍物发生碰撞
+    bool ResolveObstacleCollisions(PlayerState& player, Struct3D& potentialNextPos, float deltaTime);
+    // 连续碰撞：沿本帧位移扫掠玩家，遇到障碍物时停在接触面上并沿接触面滑动剩余位移
+    // 返回不会穿过任何障碍物的目标位置；发生接触时 collided 置为 true
+    Struct3D SweepPlayerMovement(PlayerState& player, Struct3D displacement, bool& collided);
+    // 检查玩家是否到达胜利点
     void CheckWinCondition();
+    // 热重载发布了新地图时切换 currentMap_
+    void SyncMap();
+    // 把玩家 slot 的状态填入 stateMessage_ 并返回它
+    const game_backend::ServerToClient& FillStateMessage(uint32_t slot) const;
 
 
-    PlayerState nowPlayerState_;
-    PlayerInputState currentInput_;
-    MapData currentMap_; // 洢ǰصĵͼ
-    // std::vector<AABB> obstacles_; //  currentMap_.obstacles 
-    // Struct3D victoryPoint_; //  currentMap_.victoryPoint 
-    // bool playerHasWon_ = false; // ƶ PlayerState 
+    std::string mapFile_ = GameConstants::DEFAULT_MAP_FILE;
+    PlayerBatch players_; // 房间内全部玩家的状态与输入（结构数组）
+    // 存储当前加载的地图数据；地图不可变，热重载时整体替换为新载入的一份
+    std::shared_ptr<const MapData> currentMap_;
+    std::unique_ptr<MapWatcher> mapWatcher_;
+    uint64_t mapGeneration_ = 0;
+    BroadphaseMode broadphaseMode_ = BroadphaseMode::Bvh;
+    bool continuousCollision_ = true;
+    std::vector<uint32_t> candidateScratch_; // 宽相位查询结果的复用缓冲区，避免每帧分配
+    // 序列化状态用的复用消息：子消息在第一次填充后保留，之后每次只覆盖字段值
+    mutable game_backend::ServerToClient stateMessage_;
+    // std::vector<AABB> obstacles_; // 由 currentMap_.obstacles 替代
+    // Struct3D victoryPoint_; // 由 currentMap_.victoryPoint 替代
+    // bool playerHasWon_ = false; // 移动到 PlayerState 中
 };
\ No newline at end of file
@@ -0,0 +1,194 @@
+// IoUring.cpp
+
+#include "IoUring.h"
+
+#ifdef __linux__
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+    int SetupRing(unsigned entries, io_uring_params& params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    int EnterRing(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    int RegisterRing(int fd, unsigned opcode, void* arg, unsigned count) {
+        return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    void* MapRing(int fd, size_t size, off_t offset) {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+        if (p == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "io_uring mmap");
+        }
+        return p;
+    }
+
+    template <typename T>
+    T* At(void* base, unsigned offset) {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+}
+
+IoUring::IoUring(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    // SUBMIT_ALL：某个提交项出错时（以错误完成项的形式报告）仍然提交其余的，一次 io_uring_enter 总是交出全部提交项
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+    params.cq_entries = entries * 4;
+    fd_ = SetupRing(entries, params);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+    }
+    try {
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        sqRing_ = MapRing(fd_, sqRingSize_, IORING_OFF_SQ_RING);
+        void* cqBase = sqRing_;
+        if (!singleMap) {
+            cqRing_ = MapRing(fd_, cqRingSize_, IORING_OFF_CQ_RING);
+            cqBase = cqRing_;
+        }
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(MapRing(fd_, sqesSize_, IORING_OFF_SQES));
+        sqHead_ = At<unsigned>(sqRing_, params.sq_off.head);
+        sqTail_ = At<unsigned>(sqRing_, params.sq_off.tail);
+        sqMask_ = *At<unsigned>(sqRing_, params.sq_off.ring_mask);
+        sqEntries_ = params.sq_entries;
+        sqArray_ = At<unsigned>(sqRing_, params.sq_off.array);
+        cqHead_ = At<unsigned>(cqBase, params.cq_off.head);
+        cqTail_ = At<unsigned>(cqBase, params.cq_off.tail);
+        cqMask_ = *At<unsigned>(cqBase, params.cq_off.ring_mask);
+        cqes_ = At<io_uring_cqe>(cqBase, params.cq_off.cqes);
+        sqeTail_ = submittedTail_ = *sqTail_;
+    }
+    catch (...) {
+        Release(); // 构造失败时析构函数不会执行，释放已经映射的部分
+        throw;
+    }
+}
+
+IoUring::~IoUring() {
+    Release();
+}
+
+void IoUring::Release() {
+    // 先关闭环：内核取消未完成的操作后才不再写注册的缓冲区
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (bufferRing_ != nullptr) {
+        ::munmap(bufferRing_, bufferRingSize_);
+        bufferRing_ = nullptr;
+    }
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqesSize_);
+        sqes_ = nullptr;
+    }
+    if (cqRing_ != nullptr) {
+        ::munmap(cqRing_, cqRingSize_);
+        cqRing_ = nullptr;
+    }
+    if (sqRing_ != nullptr) {
+        ::munmap(sqRing_, sqRingSize_);
+        sqRing_ = nullptr;
+    }
+}
+
+unsigned IoUring::LoadAcquire(const unsigned* p) const {
+    return std::atomic_ref<unsigned>(*const_cast<unsigned*>(p)).load(std::memory_order_acquire);
+}
+
+void IoUring::StoreRelease(unsigned* p, unsigned value) {
+    std::atomic_ref<unsigned>(*p).store(value, std::memory_order_release);
+}
+
+io_uring_sqe* IoUring::GetSqe() {
+    if (sqeTail_ - LoadAcquire(sqHead_) >= sqEntries_) {
+        return nullptr;
+    }
+    const unsigned index = sqeTail_ & sqMask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    ++sqeTail_;
+    return sqe;
+}
+
+int IoUring::Submit() {
+    const unsigned toSubmit = sqeTail_ - submittedTail_;
+    if (toSubmit == 0) {
+        return 0;
+    }
+    StoreRelease(sqTail_, sqeTail_);
+    int submitted;
+    do {
+        ++enterCount_;
+        submitted = EnterRing(fd_, toSubmit, 0, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted < 0) {
+        return -errno;
+    }
+    submittedTail_ += static_cast<unsigned>(submitted);
+    return submitted;
+}
+
+void IoUring::RegisterBufferRing(uint16_t groupId, std::span<char> buffers, uint32_t bufferSize, uint32_t count) {
+    if (count == 0 || count > 32768 || (count & (count - 1)) != 0 || static_cast<size_t>(bufferSize) * count > buffers.size()) {
+        throw std::invalid_argument("io_uring buffer ring needs a power-of-two count of buffers that fit the memory");
+    }
+    // 环本身要求按页对齐，单独匿名映射
+    bufferRingSize_ = count * sizeof(io_uring_buf);
+    void* ring = ::mmap(nullptr, bufferRingSize_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "io_uring buffer ring mmap");
+    }
+    bufferRing_ = static_cast<io_uring_buf*>(ring);
+
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufferRing_);
+    reg.ring_entries = count;
+    reg.bgid = groupId;
+    if (RegisterRing(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        const int error = errno;
+        ::munmap(bufferRing_, bufferRingSize_);
+        bufferRing_ = nullptr;
+        throw std::system_error(error, std::generic_category(), "IORING_REGISTER_PBUF_RING");
+    }
+    buffers_ = buffers.data();
+    bufferSize_ = bufferSize;
+    bufferRingMask_ = static_cast<uint16_t>(count - 1);
+    bufferRingTail_ = 0;
+    for (uint32_t id = 0; id < count; ++id) {
+        RecycleBuffer(static_cast<uint16_t>(id));
+    }
+}
+
+void IoUring::RecycleBuffer(uint16_t bufferId) {
+    io_uring_buf& entry = bufferRing_[bufferRingTail_ & bufferRingMask_];
+    entry.addr = reinterpret_cast<uint64_t>(Buffer(bufferId));
+    entry.len = bufferSize_;
+    entry.bid = bufferId;
+    ++bufferRingTail_;
+    // 环的尾指针与第 0 项的 resv 字段重叠（io_uring_buf_ring 的定义）
+    std::atomic_ref<uint16_t>(bufferRing_[0].resv).store(bufferRingTail_, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,101 @@
+// IoUring.h
+#pragma once
+
+// 最小的 io_uring 封装：直接使用内核接口（<linux/io_uring.h> 与 io_uring_setup/io_uring_enter/io_uring_register 系统调用），
+// 不依赖 liburing。只提供 UDP 收发需要的部分：提交队列、完成队列，以及供多发接收(multishot)挑选的注册缓冲区环(provided buffer ring)
+#ifdef __linux__
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+class IoUring {
+public:
+    // entries 为提交队列长度，完成队列是它的 4 倍；内核不支持或被禁止（例如 seccomp）时抛出 std::system_error
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // 环的文件描述符：有完成事件时可读，可以交给 epoll（asio）等待
+    int Fd() const { return fd_; }
+
+    // 取一个空闲的提交项（已清零）；提交队列满时返回 nullptr，先 Submit 再取
+    io_uring_sqe* GetSqe();
+    // 用一次 io_uring_enter 提交此前取出的全部提交项，返回提交的个数，失败时返回 -errno（未提交的项留到下次）
+    // 不是 SQPOLL 模式，非阻塞的操作（例如带 MSG_DONTWAIT 的发送）在返回前就已经执行完
+    // 没有待提交的项时不进入内核
+    int Submit();
+    // 已取出但尚未提交的提交项数
+    unsigned PendingSubmissions() const { return sqeTail_ - submittedTail_; }
+
+    // 依次处理已到达的完成项（只读共享内存，不进入内核），返回处理的个数
+    template <typename Handler>
+    size_t ForEachCompletion(Handler&& handler);
+
+    // 注册缓冲区环：把 buffers 平分成 count 个 bufferSize 字节的缓冲区（count 为 2 的幂），编号 0..count-1，组号 groupId
+    void RegisterBufferRing(uint16_t groupId, std::span<char> buffers, uint32_t bufferSize, uint32_t count);
+    char* Buffer(uint16_t bufferId) const { return buffers_ + static_cast<size_t>(bufferId) * bufferSize_; }
+    uint32_t BufferSize() const { return bufferSize_; }
+    // 把用完的缓冲区放回环中，内核之后的接收可以再挑选它
+    void RecycleBuffer(uint16_t bufferId);
+
+    // io_uring_enter 的调用次数
+    uint64_t EnterCount() const { return enterCount_; }
+
+private:
+    void Release();
+    unsigned LoadAcquire(const unsigned* p) const;
+    void StoreRelease(unsigned* p, unsigned value);
+
+    int fd_ = -1;
+    // 提交队列
+    void* sqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned* sqArray_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned sqeTail_ = 0;       // 本地已取出的提交项
+    unsigned submittedTail_ = 0; // 已交给内核的提交项
+    // 完成队列（与提交队列共用一次映射时 cqRing_ 为 nullptr）
+    void* cqRing_ = nullptr;
+    size_t cqRingSize_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    // 注册缓冲区环
+    io_uring_buf* bufferRing_ = nullptr;
+    size_t bufferRingSize_ = 0;
+    uint16_t bufferRingMask_ = 0;
+    uint16_t bufferRingTail_ = 0;
+    char* buffers_ = nullptr;
+    uint32_t bufferSize_ = 0;
+    uint64_t enterCount_ = 0;
+};
+
+template <typename Handler>
+size_t IoUring::ForEachCompletion(Handler&& handler) {
+    size_t count = 0;
+    unsigned head = *cqHead_;
+    // 处理过程中可能有新的完成项到达，一直取到队列为空
+    for (unsigned tail = LoadAcquire(cqTail_); head != tail; tail = LoadAcquire(cqTail_)) {
+        while (head != tail) {
+            const io_uring_cqe cqe = cqes_[head & cqMask_];
+            ++head;
+            // 先归还完成项所占的位置，handler 中的提交不会因此受阻
+            StoreRelease(cqHead_, head);
+            handler(cqe);
+            ++count;
+        }
+    }
+    return count;
+}
+
+#endif
@@ -0,0 +1,598 @@
+// LoadGenerator.cpp
+// 无界面的机器人压测工具（不参与服务器构建）：在回环地址上模拟大量 UDP 客户端，按脚本或随机的输入模式
+// 以指定频率向服务器发送 ClientToServer/PlayerInput，接收 ServerToClient 状态，报告吞吐量、输入到状态的延迟分位数和丢包
+// 用法: LoadGenerator [--名称=值 ...]，例如 LoadGenerator --bots=2000 --rate=30 --duration=20，--help 列出全部参数
+//
+// 输入到状态的延迟：服务器每帧按玩家当前的方向键直接设置水平速度（MOVE_SPEED × 方向），
+// 因此机器人改变方向时记下发送时间和期望的水平速度，第一个速度与之相同的状态到达时就是这次输入生效并发回的时间
+// 撞墙时碰撞会把速度清零，这样的方向改变在下一次改变时记为"被覆盖"，不算丢失
+
+#include "3DPos.h"
+#include "messages.pb.h"
+#ifndef ASIO_STANDALONE
+#define ASIO_STANDALONE
+#endif
+#include <asio.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // 一次方向改变超过这么久还没有在状态中看到，记为没有回应（输入或状态丢失）
+    const auto CHANGE_TIMEOUT = std::chrono::seconds(1);
+    // 单个数据报的最大字节数（与服务器的缓冲区相同）
+    const size_t DATAGRAM_SIZE = 1472;
+
+    enum class InputPattern {
+        Random, // 随机选择八个方向之一，间隔在 [0.5, 1.5] × 改变间隔内随机，偶尔跳跃
+        Script, // 依次 前、右、后、左 循环，每圈跳一次，所有机器人相同（相位错开）
+    };
+
+    struct LoadConfig {
+        std::string host = "127.0.0.1";      // --host=地址
+        unsigned short port = 12034;         // --port=端口，第一个房间的端口
+        size_t rooms = 1;                    // --rooms=N，机器人 i 连接 端口 + i % N（对应服务器的 --rooms）；分片服务器共用一个端口，用 1
+        size_t bots = 100;                   // --bots=N，客户端数，每个一个 UDP 套接字（服务器上一个会话、一个玩家）
+        float rate = 30.0f;                  // --rate=Hz，每个机器人每秒发送的输入数
+        InputPattern pattern = InputPattern::Random; // --pattern=random|script
+        float changeInterval = 0.5f;         // --change-interval=秒，改变方向的间隔
+        float duration = 10.0f;              // --duration=秒，计入统计的时长
+        float warmup = 2.0f;                 // --warmup=秒，开始统计之前的时长（建立会话、离开出生点）
+        size_t threads = 0;                  // --threads=N，运行机器人的线程数，0 表示按CPU核数（最多 8）
+        uint32_t seed = 1;                   // --seed=N，随机输入模式的种子
+    };
+
+    float ParseFloat(std::string_view name, std::string_view value) {
+        float result = 0.0f;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc() || end != value.data() + value.size()) {
+            throw std::invalid_argument("Invalid number for --" + std::string(name) + ": " + std::string(value));
+        }
+        return result;
+    }
+
+    size_t ParseCount(std::string_view name, std::string_view value) {
+        size_t result = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc() || end != value.data() + value.size()) {
+            throw std::invalid_argument("Invalid count for --" + std::string(name) + ": " + std::string(value));
+        }
+        return result;
+    }
+
+    LoadConfig ParseLoadConfig(int argc, char* argv[]) {
+        LoadConfig config;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            size_t eq = arg.find('=');
+            if (arg.substr(0, 2) != "--" || eq == std::string_view::npos) {
+                throw std::invalid_argument("Expected --name=value, got: " + std::string(arg));
+            }
+            std::string_view name = arg.substr(2, eq - 2);
+            std::string_view value = arg.substr(eq + 1);
+            if (name == "host") {
+                config.host = std::string(value);
+            }
+            else if (name == "port") {
+                const size_t port = ParseCount(name, value);
+                if (port < 1 || port > 65535) {
+                    throw std::invalid_argument("--port must be between 1 and 65535");
+                }
+                config.port = static_cast<unsigned short>(port);
+            }
+            else if (name == "rooms") {
+                config.rooms = ParseCount(name, value);
+                if (config.rooms < 1 || config.rooms > 1024) {
+                    throw std::invalid_argument("--rooms must be between 1 and 1024");
+                }
+            }
+            else if (name == "bots") {
+                config.bots = ParseCount(name, value);
+                if (config.bots < 1 || config.bots > 60000) {
+                    throw std::invalid_argument("--bots must be between 1 and 60000");
+                }
+            }
+            else if (name == "rate") {
+                config.rate = ParseFloat(name, value);
+                if (!(config.rate >= 1.0f && config.rate <= 1000.0f)) {
+                    throw std::invalid_argument("--rate must be between 1 and 1000");
+                }
+            }
+            else if (name == "pattern") {
+                if (value == "random") config.pattern = InputPattern::Random;
+                else if (value == "script") config.pattern = InputPattern::Script;
+                else throw std::invalid_argument("Invalid input pattern: " + std::string(value));
+            }
+            else if (name == "change-interval") {
+                config.changeInterval = ParseFloat(name, value);
+                if (!(config.changeInterval >= 0.05f)) {
+                    throw std::invalid_argument("--change-interval must be at least 0.05");
+                }
+            }
+            else if (name == "duration") {
+                config.duration = ParseFloat(name, value);
+                if (!(config.duration > 0.0f)) {
+                    throw std::invalid_argument("--duration must be positive");
+                }
+            }
+            else if (name == "warmup") {
+                config.warmup = ParseFloat(name, value);
+                if (!(config.warmup >= 0.0f)) {
+                    throw std::invalid_argument("--warmup must not be negative");
+                }
+            }
+            else if (name == "threads") {
+                config.threads = ParseCount(name, value);
+                if (config.threads > 256) {
+                    throw std::invalid_argument("--threads must be at most 256");
+                }
+            }
+            else if (name == "seed") {
+                config.seed = static_cast<uint32_t>(ParseCount(name, value));
+            }
+            else {
+                throw std::invalid_argument("Unknown option: --" + std::string(name));
+            }
+        }
+        return config;
+    }
+
+    void PrintUsage(const char* programName) {
+        std::cerr << "Usage: " << programName << " [options]\n"
+            << "  --host=ADDRESS            server address (default: 127.0.0.1)\n"
+            << "  --port=PORT               port of the first room (default: 12034)\n"
+            << "  --rooms=N                 bot i connects to port + i % N, matching the server's --rooms (default: 1)\n"
+            << "  --bots=N                  simulated clients, one UDP socket each (default: 100)\n"
+            << "  --rate=HZ                 inputs sent per bot per second (default: 30)\n"
+            << "  --pattern=random|script   random directions and jumps, or a fixed forward/right/back/left loop (default: random)\n"
+            << "  --change-interval=SECONDS time between direction changes (default: 0.5)\n"
+            << "  --duration=SECONDS        measured run time (default: 10)\n"
+            << "  --warmup=SECONDS          run time before measuring starts (default: 2)\n"
+            << "  --threads=N               bot threads, 0 = one per core up to 8 (default: 0)\n"
+            << "  --seed=N                  seed of the random pattern (default: 1)\n";
+    }
+
+    // 一个线程的计数，运行中由主线程每秒读取
+    struct alignas(64) BotThreadStats {
+        std::atomic<uint64_t> inputsSent{ 0 };
+        std::atomic<uint64_t> sendErrors{ 0 };
+        std::atomic<uint64_t> statesReceived{ 0 };
+        std::atomic<uint64_t> bytesReceived{ 0 };
+        std::atomic<uint64_t> malformed{ 0 };
+        std::atomic<uint64_t> changes{ 0 };      // 计入统计的方向改变
+        std::atomic<uint64_t> answered{ 0 };     // 在状态中看到的
+        std::atomic<uint64_t> superseded{ 0 };   // 还没看到就又改变了方向（通常是撞墙）
+        std::atomic<uint64_t> unanswered{ 0 };   // CHANGE_TIMEOUT 内没有看到
+    };
+
+    // 单线程写、其他线程只读的计数
+    void Increment(std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    struct Bot {
+        explicit Bot(asio::io_context& io) : socket(io) {}
+
+        asio::ip::udp::socket socket;
+        asio::ip::udp::endpoint server;
+        asio::ip::udp::endpoint from;
+        std::array<char, DATAGRAM_SIZE> buffer;
+        PlayerInputState input;
+        uint32_t scriptStep = 0;
+        Clock::time_point nextChange;
+        // 等待在状态中看到的方向改变
+        bool pending = false;
+        bool measured = false; // 改变发生在统计开始之后
+        Clock::time_point changeTime;
+        float expectX = 0.0f;
+        float expectZ = 0.0f;
+        bool won = false;      // 到达胜利点后服务器不再更新该玩家，不再统计
+    };
+
+    // 一组机器人：一个线程、一个 io_context。发送由一个定时器按槽位错开：发送周期被分成若干个槽位，
+    // 每次定时器到期发送一个槽位中的机器人，数据包均匀分布而不是每个周期集中发出
+    class BotGroup {
+    public:
+        BotGroup(const LoadConfig& config, size_t firstBot, size_t botCount, Clock::time_point measureStart, uint32_t seed)
+            : config_(config), measureStart_(measureStart), timer_(io_), rng_(seed) {
+            const asio::ip::address address = asio::ip::make_address(config.host);
+            const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.rate));
+            slotCount_ = std::clamp<size_t>(static_cast<size_t>(period / std::chrono::milliseconds(1)), 1, botCount);
+            slotPeriod_ = period / static_cast<Clock::duration::rep>(slotCount_);
+            const auto changeInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.changeInterval));
+            const Clock::time_point now = Clock::now();
+            for (size_t i = 0; i < botCount; ++i) {
+                auto bot = std::make_unique<Bot>(io_);
+                bot->socket.open(asio::ip::udp::v4());
+                bot->socket.non_blocking(true);
+                const size_t index = firstBot + i;
+                bot->server = asio::ip::udp::endpoint(address, static_cast<unsigned short>(config.port + index % config.rooms));
+                bot->scriptStep = static_cast<uint32_t>(index);
+                // 各机器人改变方向的时间错开
+                bot->nextChange = now + changeInterval * static_cast<Clock::duration::rep>(index % 16) / 16;
+                bots_.push_back(std::move(bot));
+            }
+        }
+
+        void Start() {
+            for (auto& bot : bots_) {
+                Receive(*bot);
+            }
+            nextSlotTime_ = Clock::now();
+            ScheduleSend();
+            thread_ = std::thread([this] { io_.run(); });
+        }
+
+        void Stop() {
+            io_.stop();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+        const BotThreadStats& Stats() const { return stats_; }
+        // 只在 Stop 之后读取
+        const std::vector<float>& LatenciesUs() const { return latenciesUs_; }
+        size_t WonBots() const {
+            return static_cast<size_t>(std::count_if(bots_.begin(), bots_.end(), [](const auto& bot) { return bot->won; }));
+        }
+
+    private:
+        void ScheduleSend() {
+            nextSlotTime_ += slotPeriod_;
+            timer_.expires_at(nextSlotTime_);
+            timer_.async_wait([this](const asio::error_code& error) {
+                if (error) {
+                    return;
+                }
+                const Clock::time_point now = Clock::now();
+                for (size_t i = slot_; i < bots_.size(); i += slotCount_) {
+                    Send(*bots_[i], now);
+                }
+                slot_ = (slot_ + 1) % slotCount_;
+                // 落后太多时（例如线程被挂起）不补发，从现在重新对齐
+                if (now - nextSlotTime_ > std::chrono::milliseconds(100)) {
+                    nextSlotTime_ = now;
+                }
+                ScheduleSend();
+            });
+        }
+
+        void ChangeDirection(Bot& bot, Clock::time_point now) {
+            PlayerInputState input;
+            if (config_.pattern == InputPattern::Script) {
+                const uint32_t step = bot.scriptStep++ % 4;
+                input.moveForward = step == 0;
+                input.moveRight = step == 1;
+                input.moveBackward = step == 2;
+                input.moveLeft = step == 3;
+                input.jumpPressed = step == 0;
+            }
+            else {
+                // 八个方向之一，保证与当前方向不同
+                const uint32_t current = (bot.input.moveForward ? 1u : 0u) | (bot.input.moveBackward ? 2u : 0u) |
+                    (bot.input.moveLeft ? 4u : 0u) | (bot.input.moveRight ? 8u : 0u);
+                static const uint32_t DIRECTIONS[8] = { 1, 1 | 8, 8, 2 | 8, 2, 2 | 4, 4, 1 | 4 };
+                uint32_t direction;
+                do {
+                    direction = DIRECTIONS[rng_() % 8];
+                } while (direction == current);
+                input.moveForward = (direction & 1) != 0;
+                input.moveBackward = (direction & 2) != 0;
+                input.moveLeft = (direction & 4) != 0;
+                input.moveRight = (direction & 8) != 0;
+                input.jumpPressed = rng_() % 4 == 0;
+            }
+            bot.input = input;
+
+            const auto interval = std::chrono::duration<double>(config_.changeInterval *
+                (config_.pattern == InputPattern::Random ? 0.5 + std::uniform_real_distribution<double>(0.0, 1.0)(rng_) : 1.0));
+            bot.nextChange = now + std::chrono::duration_cast<Clock::duration>(interval);
+            if (bot.won) {
+                return;
+            }
+            if (bot.pending && bot.measured) {
+                Increment(stats_.superseded);
+            }
+            bot.pending = true;
+            bot.measured = now >= measureStart_;
+            bot.changeTime = now;
+            bot.expectX = (static_cast<float>(input.moveRight) - static_cast<float>(input.moveLeft)) * GameConstants::MOVE_SPEED;
+            bot.expectZ = (static_cast<float>(input.moveForward) - static_cast<float>(input.moveBackward)) * GameConstants::MOVE_SPEED;
+            if (bot.measured) {
+                Increment(stats_.changes);
+            }
+        }
+
+        void Send(Bot& bot, Clock::time_point now) {
+            if (bot.pending && now - bot.changeTime > CHANGE_TIMEOUT) {
+                bot.pending = false;
+                if (bot.measured) {
+                    Increment(stats_.unanswered);
+                }
+            }
+            if (now >= bot.nextChange) {
+                ChangeDirection(bot, now);
+            }
+            else {
+                bot.input.jumpPressed = false; // 跳跃只在改变方向的那个输入中按下
+            }
+            game_backend::PlayerInput* input = message_.mutable_input();
+            input->set_move_forward(bot.input.moveForward);
+            input->set_move_backward(bot.input.moveBackward);
+            input->set_move_left(bot.input.moveLeft);
+            input->set_move_right(bot.input.moveRight);
+            input->set_jump_pressed(bot.input.jumpPressed);
+            std::array<char, 64> packet;
+            const size_t size = message_.ByteSizeLong();
+            if (size > packet.size() || !message_.SerializeToArray(packet.data(), static_cast<int>(size))) {
+                return;
+            }
+            asio::error_code error;
+            bot.socket.send_to(asio::buffer(packet.data(), size), bot.server, 0, error);
+            if (error) {
+                Increment(stats_.sendErrors); // 套接字发送缓冲区满等，输入方向保持不变，下一个输入会再带上
+            }
+            else if (now >= measureStart_) {
+                Increment(stats_.inputsSent);
+            }
+        }
+
+        void Receive(Bot& bot) {
+            bot.socket.async_receive_from(asio::buffer(bot.buffer), bot.from, [this, &bot](const asio::error_code& error, size_t size) {
+                if (error == asio::error::operation_aborted) {
+                    return;
+                }
+                if (!error) {
+                    HandleState(bot, size);
+                }
+                Receive(bot);
+            });
+        }
+
+        void HandleState(Bot& bot, size_t size) {
+            const Clock::time_point now = Clock::now();
+            if (!reply_.ParseFromArray(bot.buffer.data(), static_cast<int>(size)) || !reply_.has_state()) {
+                Increment(stats_.malformed);
+                return;
+            }
+            if (now >= measureStart_) {
+                Increment(stats_.statesReceived);
+                Increment(stats_.bytesReceived, size);
+            }
+            const game_backend::GameState& state = reply_.state();
+            if (state.has_won()) {
+                bot.won = true;
+                bot.pending = false;
+                return;
+            }
+            if (bot.pending && std::abs(state.velocity().x() - bot.expectX) < 1e-3f && std::abs(state.velocity().z() - bot.expectZ) < 1e-3f) {
+                bot.pending = false;
+                if (bot.measured) {
+                    Increment(stats_.answered);
+                    latenciesUs_.push_back(std::chrono::duration<float, std::micro>(now - bot.changeTime).count());
+                }
+            }
+        }
+
+        const LoadConfig& config_;
+        Clock::time_point measureStart_;
+        asio::io_context io_;
+        asio::steady_timer timer_;
+        std::vector<std::unique_ptr<Bot>> bots_;
+        size_t slotCount_ = 1;
+        size_t slot_ = 0;
+        Clock::duration slotPeriod_{};
+        Clock::time_point nextSlotTime_;
+        std::mt19937 rng_;
+        game_backend::ClientToServer message_;
+        game_backend::ServerToClient reply_;
+        BotThreadStats stats_;
+        std::vector<float> latenciesUs_;
+        std::thread thread_;
+    };
+
+    // 回环上 UDP 套接字的内核丢包计数（/proc/net/udp 的 drops 列，只在 Linux 上可用）：
+    // 服务器端口上的，以及其余套接字（机器人）上的
+    struct SocketDrops {
+        bool available = false;
+        uint64_t server = 0;
+        uint64_t others = 0;
+    };
+
+    SocketDrops ReadSocketDrops(const LoadConfig& config) {
+        SocketDrops drops;
+        std::ifstream file("/proc/net/udp");
+        if (!file) {
+            return drops;
+        }
+        drops.available = true;
+        std::string line;
+        std::getline(file, line); // 表头
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string slot, local, remote, column;
+            fields >> slot >> local >> remote;
+            uint64_t value = 0;
+            while (fields >> column) {
+                value = std::strtoull(column.c_str(), nullptr, 10); // 最后一列为 drops
+            }
+            const size_t colon = local.find(':');
+            const unsigned long port = colon == std::string::npos ? 0 : std::strtoul(local.c_str() + colon + 1, nullptr, 16);
+            const bool serverPort = port >= config.port && port < config.port + config.rooms;
+            (serverPort ? drops.server : drops.others) += value;
+        }
+        return drops;
+    }
+
+    // 尽量放宽打开文件数的限制：每个机器人一个套接字
+    void RaiseFileLimit(size_t bots) {
+#ifdef __linux__
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+            if (limit.rlim_cur != RLIM_INFINITY && bots + 64 > limit.rlim_cur) {
+                std::cerr << "[LoadGen] Warning: open file limit " << limit.rlim_cur << " is too low for " << bots << " bots." << std::endl;
+            }
+        }
+#else
+        (void)bots;
+#endif
+    }
+
+    struct Totals {
+        uint64_t inputsSent = 0;
+        uint64_t sendErrors = 0;
+        uint64_t statesReceived = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t malformed = 0;
+        uint64_t changes = 0;
+        uint64_t answered = 0;
+        uint64_t superseded = 0;
+        uint64_t unanswered = 0;
+    };
+
+    Totals SumStats(const std::vector<std::unique_ptr<BotGroup>>& groups) {
+        Totals totals;
+        for (const auto& group : groups) {
+            const BotThreadStats& stats = group->Stats();
+            totals.inputsSent += stats.inputsSent.load(std::memory_order_relaxed);
+            totals.sendErrors += stats.sendErrors.load(std::memory_order_relaxed);
+            totals.statesReceived += stats.statesReceived.load(std::memory_order_relaxed);
+            totals.bytesReceived += stats.bytesReceived.load(std::memory_order_relaxed);
+            totals.malformed += stats.malformed.load(std::memory_order_relaxed);
+            totals.changes += stats.changes.load(std::memory_order_relaxed);
+            totals.answered += stats.answered.load(std::memory_order_relaxed);
+            totals.superseded += stats.superseded.load(std::memory_order_relaxed);
+            totals.unanswered += stats.unanswered.load(std::memory_order_relaxed);
+        }
+        return totals;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view(argv[i]) == "--help") {
+                PrintUsage(argv[0]);
+                return 0;
+            }
+        }
+        config = ParseLoadConfig(argc, argv);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << "[LoadGen] Invalid argument: " << e.what() << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    RaiseFileLimit(config.bots);
+
+    const size_t threadCount = std::clamp<size_t>(config.threads != 0 ? config.threads : std::min(8u, std::max(1u, std::thread::hardware_concurrency())),
+        1, config.bots);
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point measureStart = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.warmup));
+    const Clock::time_point end = measureStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.duration));
+
+    std::vector<std::unique_ptr<BotGroup>> groups;
+    try {
+        for (size_t t = 0; t < threadCount; ++t) {
+            const size_t first = config.bots * t / threadCount;
+            const size_t last = config.bots * (t + 1) / threadCount;
+            groups.push_back(std::make_unique<BotGroup>(config, first, last - first, measureStart, config.seed + static_cast<uint32_t>(t)));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[LoadGen] Error: Failed to create bots: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "[LoadGen] " << config.bots << " bots on " << threadCount << " thread(s) -> " << config.host << ":" << config.port;
+    if (config.rooms > 1) {
+        std::cout << "-" << config.port + config.rooms - 1;
+    }
+    std::cout << ", " << config.rate << " inputs/s per bot, " << (config.pattern == InputPattern::Random ? "random" : "scripted")
+        << " pattern, direction change every " << config.changeInterval << " s" << std::endl;
+    std::cout << "[LoadGen] Warming up for " << config.warmup << " s, then measuring for " << config.duration << " s." << std::endl;
+
+    for (auto& group : groups) {
+        group->Start();
+    }
+    std::this_thread::sleep_until(measureStart);
+    const SocketDrops dropsAtStart = ReadSocketDrops(config);
+
+    // 每秒打印一次进度
+    Totals last;
+    Clock::time_point lastTime = measureStart;
+    while (Clock::now() < end) {
+        std::this_thread::sleep_until(std::min(end, lastTime + std::chrono::seconds(1)));
+        const Clock::time_point now = Clock::now();
+        const Totals totals = SumStats(groups);
+        const double seconds = std::chrono::duration<double>(now - lastTime).count();
+        std::printf("[LoadGen] t=%5.1fs: %9.0f inputs/s sent, %9.0f states/s received, %6llu changes answered\n",
+            std::chrono::duration<double>(now - measureStart).count(), (totals.inputsSent - last.inputsSent) / seconds,
+            (totals.statesReceived - last.statesReceived) / seconds, static_cast<unsigned long long>(totals.answered - last.answered));
+        last = totals;
+        lastTime = now;
+    }
+    const SocketDrops dropsAtEnd = ReadSocketDrops(config);
+    const Totals totals = SumStats(groups);
+    const double seconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+    for (auto& group : groups) {
+        group->Stop();
+    }
+
+    std::vector<float> latencies;
+    size_t wonBots = 0;
+    for (const auto& group : groups) {
+        latencies.insert(latencies.end(), group->LatenciesUs().begin(), group->LatenciesUs().end());
+        wonBots += group->WonBots();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentileMs = [&](double p) {
+        return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))] / 1000.0;
+    };
+
+    std::printf("[LoadGen] Throughput: %.0f inputs/s sent (%llu send errors), %.0f states/s received, %.1f KB/s received, %llu malformed replies\n",
+        totals.inputsSent / seconds, static_cast<unsigned long long>(totals.sendErrors), totals.statesReceived / seconds,
+        totals.bytesReceived / 1024.0 / seconds, static_cast<unsigned long long>(totals.malformed));
+    std::printf("[LoadGen] Per bot: %.1f inputs/s, %.1f states/s\n", totals.inputsSent / seconds / config.bots,
+        totals.statesReceived / seconds / config.bots);
+    std::printf("[LoadGen] Input-to-state latency (ms, %zu samples): p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n",
+        latencies.size(), percentileMs(0.5), percentileMs(0.9), percentileMs(0.99), percentileMs(0.999),
+        latencies.empty() ? 0.0 : latencies.back() / 1000.0);
+    const double judged = static_cast<double>(std::max<uint64_t>(1, totals.answered + totals.unanswered));
+    std::printf("[LoadGen] Direction changes: %llu, answered %llu, superseded %llu (blocked by a wall or overtaken), "
+        "unanswered within %lld ms %llu (%.2f%% loss), still pending at the end %llu; %zu bot(s) reached the victory point\n",
+        static_cast<unsigned long long>(totals.changes), static_cast<unsigned long long>(totals.answered),
+        static_cast<unsigned long long>(totals.superseded), static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(CHANGE_TIMEOUT).count()),
+        static_cast<unsigned long long>(totals.unanswered), totals.unanswered * 100.0 / judged,
+        static_cast<unsigned long long>(totals.changes - std::min(totals.changes, totals.answered + totals.superseded + totals.unanswered)), wonBots);
+    if (dropsAtStart.available && dropsAtEnd.available) {
+        std::printf("[LoadGen] Kernel UDP drops during the run: %llu on the server port(s), %llu on other sockets (bots)\n",
+            static_cast<unsigned long long>(dropsAtEnd.server - dropsAtStart.server),
+            static_cast<unsigned long long>(dropsAtEnd.others - dropsAtStart.others));
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Logger.cpp
+
+#include "Logger.h"
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    constexpr size_t RING_CAPACITY = 4096;   // 必须是2的幂
+    constexpr size_t MESSAGE_SIZE = 240;     // 单条日志的最大长度（含结尾'\0'），超出部分截断
+    constexpr auto IDLE_SLEEP = std::chrono::milliseconds(2);
+
+    struct Slot {
+        std::atomic<size_t> sequence{ 0 };
+        LogLevel level = LogLevel::Info;
+        char text[MESSAGE_SIZE];
+    };
+
+    // 有界多生产者单消费者环形缓冲区（Vyukov 序号槽算法）
+    // 每个槽位的 sequence 表示它当前可以被哪个位置的生产者/消费者使用，生产者之间只竞争 enqueuePos_
+    class LogRing {
+    public:
+        LogRing() {
+            for (size_t i = 0; i < RING_CAPACITY; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // 取得一个可写槽位；缓冲区满时返回 nullptr
+        Slot* BeginPush() {
+            size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = slots_[pos & (RING_CAPACITY - 1)];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        return &slot;
+                    }
+                }
+                else if (diff < 0) {
+                    return nullptr;
+                }
+                else {
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void EndPush(Slot* slot) {
+            slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // 只由写线程调用
+        Slot* BeginPop() {
+            Slot& slot = slots_[dequeuePos_ & (RING_CAPACITY - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            return sequence == dequeuePos_ + 1 ? &slot : nullptr;
+        }
+
+        void EndPop(Slot* slot) {
+            slot->sequence.store(dequeuePos_ + RING_CAPACITY, std::memory_order_release);
+            ++dequeuePos_;
+        }
+
+    private:
+        std::array<Slot, RING_CAPACITY> slots_;
+        alignas(64) std::atomic<size_t> enqueuePos_{ 0 };
+        alignas(64) size_t dequeuePos_ = 0;
+    };
+
+    LogRing ring;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> stopRequested{ false };
+    // 正在向缓冲区写入的线程数：Stop 关闭 running 后等它归零，保证最后一次 Drain 之后不会再有日志进入缓冲区
+    std::atomic<uint32_t> activeProducers{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::thread writerThread;
+
+    void Output(LogLevel level, const char* text) {
+        std::FILE* stream = level >= LogLevel::Warning ? stderr : stdout;
+        std::fputs(text, stream);
+        std::fputc('\n', stream);
+    }
+
+    // 把缓冲区中已提交的日志全部写出，返回写出的条数
+    size_t Drain() {
+        size_t written = 0;
+        while (Slot* slot = ring.BeginPop()) {
+            Output(slot->level, slot->text);
+            ring.EndPop(slot);
+            ++written;
+        }
+        if (written > 0) {
+            std::fflush(stdout);
+        }
+        return written;
+    }
+
+    void WriterLoop() {
+        uint64_t reportedDrops = 0;
+        while (!stopRequested.load(std::memory_order_acquire)) {
+            if (Drain() == 0) {
+                std::this_thread::sleep_for(IDLE_SLEEP);
+            }
+            uint64_t drops = dropped.load(std::memory_order_relaxed);
+            if (drops != reportedDrops) {
+                std::fprintf(stderr, "[Log] Warning: %llu log messages dropped (buffer full)\n",
+                    static_cast<unsigned long long>(drops - reportedDrops));
+                reportedDrops = drops;
+            }
+        }
+        Drain();
+    }
+
+    void Submit(LogLevel level, uint32_t suppressed, const char* format, va_list args) {
+        // 先登记再检查 running（都是顺序一致的操作）：Stop 要么看到这里的登记并等待，要么这里看到 running 已关闭走同步输出
+        activeProducers.fetch_add(1);
+        if (!running.load()) {
+            activeProducers.fetch_sub(1);
+            char text[MESSAGE_SIZE];
+            std::vsnprintf(text, sizeof(text), format, args);
+            Output(level, text);
+            if (suppressed > 0) {
+                std::fprintf(level >= LogLevel::Warning ? stderr : stdout, "  (%u similar messages suppressed)\n", suppressed);
+            }
+            return;
+        }
+        Slot* slot = ring.BeginPush();
+        if (slot == nullptr) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            activeProducers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        slot->level = level;
+        int length = std::vsnprintf(slot->text, MESSAGE_SIZE, format, args);
+        if (suppressed > 0 && length >= 0 && static_cast<size_t>(length) < MESSAGE_SIZE) {
+            std::snprintf(slot->text + length, MESSAGE_SIZE - length, " (%u similar messages suppressed)", suppressed);
+        }
+        ring.EndPush(slot);
+        activeProducers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+namespace Log {
+    namespace detail {
+        std::atomic<int> runtimeLevel{ static_cast<int>(LogLevel::Info) };
+
+        void Write(LogLevel level, const char* format, ...) {
+            va_list args;
+            va_start(args, format);
+            Submit(level, 0, format, args);
+            va_end(args);
+        }
+
+        void WriteSuppressed(LogLevel level, uint32_t suppressed, const char* format, ...) {
+            va_list args;
+            va_start(args, format);
+            Submit(level, suppressed, format, args);
+            va_end(args);
+        }
+    }
+
+    void SetLevel(LogLevel level) {
+        detail::runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel GetLevel() {
+        return static_cast<LogLevel>(detail::runtimeLevel.load(std::memory_order_relaxed));
+    }
+
+    std::optional<LogLevel> ParseLevel(std::string_view name) {
+        if (name == "debug") return LogLevel::Debug;
+        if (name == "info") return LogLevel::Info;
+        if (name == "warn") return LogLevel::Warning;
+        if (name == "error") return LogLevel::Error;
+        if (name == "off") return LogLevel::Off;
+        return std::nullopt;
+    }
+
+    void Start() {
+        if (running.exchange(true)) {
+            return;
+        }
+        stopRequested = false;
+        writerThread = std::thread(WriterLoop);
+    }
+
+    void Stop() {
+        // 先关闭 running：之后的日志直接同步输出；再等已经在写缓冲区的线程完成，最后让写线程做最后一次 Drain
+        if (!running.exchange(false)) {
+            return;
+        }
+        while (activeProducers.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        stopRequested = true;
+        writerThread.join();
+    }
+
+    uint64_t DroppedCount() {
+        return dropped.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,134 @@
+// Logger.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// 异步分级日志
+// - 调用方线程只做一次 snprintf 格式化到固定大小的槽位，并写入无锁环形缓冲区，不做任何I/O
+// - 后台写线程负责把缓冲区中的日志写到 stdout（Warning 及以上写到 stderr）
+// - 级别低于运行时级别的日志在求值参数之前就被跳过；低于编译期级别（IWANNA_LOG_COMPILE_LEVEL）的直接被移除
+// - LOG_*_RATE 宏为每个调用点单独限流，超出部分只计数，下一条放行时附带被抑制的条数
+// 缓冲区满时丢弃新日志并计数，绝不阻塞调用方
+
+enum class LogLevel : int {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+    Off = 4,
+};
+
+// 编译期最低级别：默认 Release(NDEBUG) 下移除 Debug 日志
+#ifndef IWANNA_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define IWANNA_LOG_COMPILE_LEVEL 1
+#else
+#define IWANNA_LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IWANNA_PRINTF_FORMAT(fmtIndex, argIndex) __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+#define IWANNA_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+namespace Log {
+    // 运行时级别，可随时修改
+    void SetLevel(LogLevel level);
+    LogLevel GetLevel();
+    std::optional<LogLevel> ParseLevel(std::string_view name);
+
+    // 启动/停止后台写线程。未启动时日志同步写出（例如在 main 之前或单独的工具程序中）
+    void Start();
+    // 写完缓冲区中剩余的日志并停止写线程
+    void Stop();
+
+    // 缓冲区满而丢弃的日志条数
+    uint64_t DroppedCount();
+
+    // 作用域内启用后台写线程，离开作用域时写完剩余日志
+    class ScopedWriter {
+    public:
+        ScopedWriter() { Start(); }
+        ~ScopedWriter() { Stop(); }
+        ScopedWriter(const ScopedWriter&) = delete;
+        ScopedWriter& operator=(const ScopedWriter&) = delete;
+    };
+
+    namespace detail {
+        extern std::atomic<int> runtimeLevel;
+
+        inline bool Enabled(LogLevel level) {
+            return static_cast<int>(level) >= runtimeLevel.load(std::memory_order_relaxed);
+        }
+
+        void Write(LogLevel level, const char* format, ...) IWANNA_PRINTF_FORMAT(2, 3);
+        void WriteSuppressed(LogLevel level, uint32_t suppressed, const char* format, ...) IWANNA_PRINTF_FORMAT(3, 4);
+
+        // 每个调用点一个的限流器：每秒最多放行 perSecond 条
+        class RateLimiter {
+        public:
+            explicit RateLimiter(uint32_t perSecond) : perSecond_(perSecond) {}
+
+            // 返回是否放行；放行时 suppressed 为上一个时间窗口以来被抑制的条数
+            bool Allow(uint32_t& suppressed) {
+                const int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+                int64_t window = window_.load(std::memory_order_relaxed);
+                if (second != window && window_.compare_exchange_strong(window, second, std::memory_order_relaxed)) {
+                    count_.store(0, std::memory_order_relaxed);
+                }
+                if (count_.fetch_add(1, std::memory_order_relaxed) < perSecond_) {
+                    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+                    return true;
+                }
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+        private:
+            const uint32_t perSecond_;
+            std::atomic<int64_t> window_{ 0 };
+            std::atomic<uint32_t> count_{ 0 };
+            std::atomic<uint32_t> suppressed_{ 0 };
+        };
+    }
+}
+
+// 该级别的日志是否会输出；需要为日志额外准备数据（例如转储缓冲区）时先用它判断
+#define LOG_ENABLED(level) (static_cast<int>(level) >= IWANNA_LOG_COMPILE_LEVEL && ::Log::detail::Enabled(level))
+
+#define IWANNA_LOG_IMPL(level, ...) \
+    do { \
+        if (LOG_ENABLED(level)) { \
+            ::Log::detail::Write(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define IWANNA_LOG_RATE_IMPL(level, perSecond, ...) \
+    do { \
+        if (LOG_ENABLED(level)) { \
+            static ::Log::detail::RateLimiter iwannaLogLimiter_(perSecond); \
+            uint32_t iwannaLogSuppressed_ = 0; \
+            if (iwannaLogLimiter_.Allow(iwannaLogSuppressed_)) { \
+                ::Log::detail::WriteSuppressed(level, iwannaLogSuppressed_, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// printf 风格的格式串
+#define LOG_DEBUG(...) IWANNA_LOG_IMPL(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) IWANNA_LOG_IMPL(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) IWANNA_LOG_IMPL(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) IWANNA_LOG_IMPL(LogLevel::Error, __VA_ARGS__)
+
+// 带每调用点限流的版本，第一个参数为每秒最多输出的条数
+#define LOG_DEBUG_RATE(perSecond, ...) IWANNA_LOG_RATE_IMPL(LogLevel::Debug, perSecond, __VA_ARGS__)
+#define LOG_INFO_RATE(perSecond, ...) IWANNA_LOG_RATE_IMPL(LogLevel::Info, perSecond, __VA_ARGS__)
+#define LOG_WARN_RATE(perSecond, ...) IWANNA_LOG_RATE_IMPL(LogLevel::Warning, perSecond, __VA_ARGS__)
+#define LOG_ERROR_RATE(perSecond, ...) IWANNA_LOG_RATE_IMPL(LogLevel::Error, perSecond, __VA_ARGS__)
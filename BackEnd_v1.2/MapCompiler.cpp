@@ -0,0 +1,44 @@
+// MapCompiler.cpp
+// 离线地图编译工具（不参与服务器构建），把文本地图转换为可直接映射载入的二进制地图
+// 用法: MapCompiler 输入.txt [输出.iwmap]，不指定输出时写到输入文件旁边（扩展名改为 .iwmap）
+
+#include "MapLoader.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <map.txt> [output" << COMPILED_MAP_EXTENSION << "]" << std::endl;
+        return 1;
+    }
+    const std::string input = argv[1];
+    const std::string output = argc == 3 ? argv[2] : CompiledMapPath(input);
+
+    auto start = std::chrono::steady_clock::now();
+    MapData mapData = LoadTextMap(input);
+    if (!mapData.loadedSuccessfully) {
+        return 1;
+    }
+    std::chrono::duration<double, std::milli> textMs = std::chrono::steady_clock::now() - start;
+
+    if (!WriteCompiledMap(mapData, output)) {
+        return 1;
+    }
+
+    // 读回校验，同时给出两种格式的载入耗时对比
+    start = std::chrono::steady_clock::now();
+    MapData compiled = LoadCompiledMap(output);
+    std::chrono::duration<double, std::milli> compiledMs = std::chrono::steady_clock::now() - start;
+    if (!compiled.loadedSuccessfully || compiled.obstacles != mapData.obstacles ||
+        compiled.victoryPoint != mapData.victoryPoint) {
+        std::cerr << "[MapCompiler] Error: Verification of " << output << " failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "[MapCompiler] " << input << " -> " << output << ": " << mapData.obstacles.size()
+        << " obstacles, " << mapData.obstacleBvh.NodeCount() << " BVH nodes" << std::endl;
+    std::cout << "[MapCompiler] Load time: text " << textMs.count() << " ms, compiled "
+        << compiledMs.count() << " ms" << std::endl;
+    return 0;
+}
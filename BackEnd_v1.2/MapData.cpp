@@ -0,0 +1,65 @@
+// MapData.cpp
+
+#include "MapData.h"
+#include <algorithm>
+#include <numeric>
+
+void BuildAccelerationStructures(MapData& mapData, bool rebuildBvh) {
+    mapData.bounds = {};
+    if (!mapData.obstacles.empty()) {
+        mapData.bounds = mapData.obstacles.front();
+        for (const AABB& obstacle : mapData.obstacles) {
+            mapData.bounds = MergeAABB(mapData.bounds, obstacle);
+        }
+    }
+    mapData.obstacleGrid.Build(mapData.obstacles);
+    if (rebuildBvh) {
+        mapData.obstacleBvh.Build(mapData.obstacles);
+    }
+    mapData.obstacleSoA.Build(mapData.obstacles);
+}
+
+void QueryObstacleCandidates(const MapData& mapData, BroadphaseMode mode, const AABB& query, std::vector<uint32_t>& out) {
+    out.clear();
+    switch (mode) {
+    case BroadphaseMode::Grid:
+        mapData.obstacleGrid.Query(query, out);
+        // 同一个障碍物可能出现在多个格子里，排序去重
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        return;
+    case BroadphaseMode::Bvh:
+        // BVH叶子互不相交，不会产生重复，只需排序
+        mapData.obstacleBvh.Query(query, out);
+        std::sort(out.begin(), out.end());
+        return;
+    case BroadphaseMode::Simd:
+        // SIMD扫描直接给出与 query 重叠的障碍物，结果本身就是升序
+        mapData.obstacleSoA.Query(query, out);
+        return;
+    case BroadphaseMode::Linear:
+    default:
+        // 原始行为：所有障碍物都是候选
+        out.resize(mapData.obstacles.size());
+        std::iota(out.begin(), out.end(), 0u);
+        return;
+    }
+}
+
+std::optional<BroadphaseMode> ParseBroadphaseMode(std::string_view name) {
+    if (name == "linear") return BroadphaseMode::Linear;
+    if (name == "grid") return BroadphaseMode::Grid;
+    if (name == "bvh") return BroadphaseMode::Bvh;
+    if (name == "simd") return BroadphaseMode::Simd;
+    return std::nullopt;
+}
+
+const char* BroadphaseModeName(BroadphaseMode mode) {
+    switch (mode) {
+    case BroadphaseMode::Linear: return "linear";
+    case BroadphaseMode::Grid: return "grid";
+    case BroadphaseMode::Bvh: return "bvh";
+    case BroadphaseMode::Simd: return "simd";
+    }
+    return "unknown";
+}
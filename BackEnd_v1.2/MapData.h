@@ -0,0 +1,46 @@
+// MapData.h
+#pragma once
+
+#include "3DPos.h"
+#include "UniformGrid.h"
+#include "Bvh.h"
+#include "ObstacleSoA.h"
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// 宽相位(broadphase)模式：决定每帧如何筛选可能与玩家相撞的障碍物
+// 运行时可切换，便于和原始的线性遍历做对比
+enum class BroadphaseMode {
+    Linear, // 线性遍历全部障碍物（原始实现）
+    Grid,   // 均匀网格
+    Bvh,    // SAH构建的包围体层次结构（默认）
+    Simd,   // 基于SoA存储的SIMD线性扫描，每次测试8个障碍物
+};
+
+// 地图数据结构，包含障碍物、胜利点以及加载后构建的加速结构
+struct MapData {
+    std::vector<AABB> obstacles;
+    Struct3D victoryPoint;
+    bool loadedSuccessfully = false;
+
+    // 以下由 BuildAccelerationStructures 构建
+    AABB bounds; // 全部障碍物的包围盒，没有障碍物时为原点处的空盒
+    UniformGrid obstacleGrid;
+    Bvh obstacleBvh;
+    ObstacleSoA obstacleSoA;
+};
+
+// 在障碍物列表载入后构建所有加速结构（以及障碍物包围盒）
+// 从预编译地图载入时BVH已经恢复，传 rebuildBvh = false 只构建其余（构建代价低的）结构
+void BuildAccelerationStructures(MapData& mapData, bool rebuildBvh = true);
+
+// 收集可能与 query 相交的障碍物下标，结果升序且不重复
+// 升序保证了与线性遍历完全相同的碰撞处理顺序
+// out 会先被清空；调用方可复用同一个 vector 以避免每帧分配内存
+void QueryObstacleCandidates(const MapData& mapData, BroadphaseMode mode, const AABB& query, std::vector<uint32_t>& out);
+
+// 模式与字符串之间的转换（用于命令行参数和日志）
+std::optional<BroadphaseMode> ParseBroadphaseMode(std::string_view name);
+const char* BroadphaseModeName(BroadphaseMode mode);
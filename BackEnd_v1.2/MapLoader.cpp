@@ -0,0 +1,346 @@
+// MapLoader.cpp
+
+#include "MapLoader.h"
+#include "MappedFile.h"
+#include "Logger.h"
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+static_assert(std::is_trivially_copyable_v<AABB> && sizeof(AABB) == 24, "compiled map stores AABB verbatim");
+static_assert(std::is_trivially_copyable_v<BvhNode> && sizeof(BvhNode) == 32, "compiled map stores BvhNode verbatim");
+
+namespace {
+    uint64_t AlignUp(uint64_t value) {
+        return (value + COMPILED_MAP_ALIGNMENT - 1) / COMPILED_MAP_ALIGNMENT * COMPILED_MAP_ALIGNMENT;
+    }
+
+    // [offset, offset + count * elementSize) 是否完整落在文件内且满足对齐
+    bool SectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+        if (offset % COMPILED_MAP_ALIGNMENT != 0 || offset > fileSize) {
+            return false;
+        }
+        return count <= (fileSize - offset) / elementSize;
+    }
+
+    bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // 文本地图的一行，按空白切分记号；语义与 std::istringstream 的 operator>> 一致：
+    // 数值读取失败时该值置 0，并且本行之后的读取都不再生效
+    class TextLine {
+    public:
+        explicit TextLine(std::string_view text) : text_(text) {}
+
+        std::string_view Text() const { return text_; }
+        bool Empty() const { return text_.empty(); }
+        char Front() const { return text_.front(); }
+
+        std::string_view NextToken() {
+            SkipSpace();
+            size_t start = pos_;
+            while (pos_ < text_.size() && !IsSpace(text_[pos_])) {
+                ++pos_;
+            }
+            return text_.substr(start, pos_ - start);
+        }
+
+        void ReadFloat(float& value) {
+            if (failed_) {
+                return;
+            }
+            SkipSpace();
+            const char* first = text_.data() + pos_;
+            const char* last = text_.data() + text_.size();
+            // from_chars 不接受前导 '+'，operator>> 接受
+            if (first != last && *first == '+' && last - first > 1 && first[1] != '-') {
+                ++first;
+            }
+            // operator>> 不识别 inf/nan，这里也只接受以数字、小数点或负号开头的数值
+            bool numeric = first != last && (std::isdigit(static_cast<unsigned char>(*first)) || *first == '.' || *first == '-');
+            if (numeric && *first == '-' && (last - first < 2 ||
+                !(std::isdigit(static_cast<unsigned char>(first[1])) || first[1] == '.'))) {
+                numeric = false;
+            }
+            auto [end, ec] = numeric ? std::from_chars(first, last, value) : std::from_chars_result{ first, std::errc::invalid_argument };
+            if (ec != std::errc()) {
+                value = 0.0f;
+                failed_ = true;
+                return;
+            }
+            pos_ = static_cast<size_t>(end - text_.data());
+        }
+
+    private:
+        void SkipSpace() {
+            while (pos_ < text_.size() && IsSpace(text_[pos_])) {
+                ++pos_;
+            }
+        }
+
+        std::string_view text_;
+        size_t pos_ = 0;
+        bool failed_ = false;
+    };
+
+    // 检查BVH的结构与下标引用，防止损坏或恶意构造的文件导致查询时越界访问或死循环
+    // 从根节点深度优先遍历：内部节点 i 的左孩子 i + 1 与右孩子都必须在数组内且只向后引用，
+    // 每个节点恰好被访问一次（是一棵树，没有环、共享的子树或不可达的节点），
+    // 路径上的内部节点数不超过查询栈的大小
+    bool ValidateBvh(const std::vector<BvhNode>& nodes, const std::vector<uint32_t>& indices, size_t obstacleCount) {
+        if (nodes.empty()) {
+            return true;
+        }
+        std::vector<uint8_t> visited(nodes.size(), 0);
+        size_t visitedCount = 0;
+        // (节点下标, 祖先中的内部节点数)
+        std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0, 0 } };
+        while (!stack.empty()) {
+            const auto [index, depth] = stack.back();
+            stack.pop_back();
+            if (visited[index]) {
+                return false;
+            }
+            visited[index] = 1;
+            ++visitedCount;
+            const BvhNode& node = nodes[index];
+            if (node.IsLeaf()) {
+                if (node.leftOrFirst > indices.size() || node.count > indices.size() - node.leftOrFirst) {
+                    return false;
+                }
+                continue;
+            }
+            const size_t left = static_cast<size_t>(index) + 1;
+            if (left >= nodes.size() || node.leftOrFirst <= left || node.leftOrFirst >= nodes.size() ||
+                depth + 1 > Bvh::QUERY_STACK_SIZE) {
+                return false;
+            }
+            stack.push_back({ node.leftOrFirst, depth + 1 });
+            stack.push_back({ static_cast<uint32_t>(left), depth + 1 });
+        }
+        if (visitedCount != nodes.size()) {
+            return false;
+        }
+        for (uint32_t index : indices) {
+            if (index >= obstacleCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool ParseTextMap(std::string_view text, MapData& mapData) {
+    size_t pos = 0;
+    bool firstLine = true;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view lineText = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (!lineText.empty() && lineText.back() == '\r') { // 与文本模式读取一致，去掉CRLF中的'\r'
+            lineText.remove_suffix(1);
+        }
+        TextLine line(lineText);
+
+        if (firstLine) {
+            // 读取胜利点
+            firstLine = false;
+            if (line.NextToken() != "victory_point") {
+                LOG_ERROR("[Game] Error: Invalid map file format. Expected 'victory_point' on the first line.");
+                return false;
+            }
+            line.ReadFloat(mapData.victoryPoint.x);
+            line.ReadFloat(mapData.victoryPoint.y);
+            line.ReadFloat(mapData.victoryPoint.z);
+            continue;
+        }
+
+        // 读取障碍物
+        if (line.NextToken() == "obstacle_aabb") {
+            AABB obstacle;
+            line.ReadFloat(obstacle.min.x);
+            line.ReadFloat(obstacle.min.y);
+            line.ReadFloat(obstacle.min.z);
+            line.ReadFloat(obstacle.max.x);
+            line.ReadFloat(obstacle.max.y);
+            line.ReadFloat(obstacle.max.z);
+            mapData.obstacles.push_back(obstacle);
+        }
+        else if (!line.Empty() && line.Front() != '#') { // 忽略空行和注释行
+            LOG_WARN("[Game] Warning: Skipping invalid line in map file: %.*s", static_cast<int>(line.Text().size()), line.Text().data());
+        }
+    }
+    if (firstLine) {
+        LOG_ERROR("[Game] Error: Map file is empty or could not read victory point.");
+        return false;
+    }
+    return true;
+}
+
+MapData LoadTextMap(const std::string& filename) {
+    MapData mapData;
+    mapData.loadedSuccessfully = false; // 默认加载失败
+    std::ifstream mapFile(filename, std::ios::binary);
+    if (!mapFile.is_open()) {
+        LOG_ERROR("[Game] Error: Could not open map file: %s", filename.c_str());
+        return mapData; // 返回加载失败的MapData
+    }
+
+    // 整个文件一次读入同一个缓冲区，之后逐行解析时不再分配内存
+    std::string text;
+    mapFile.seekg(0, std::ios::end);
+    std::streamoff fileSize = mapFile.tellg();
+    mapFile.seekg(0, std::ios::beg);
+    if (fileSize > 0) {
+        text.resize(static_cast<size_t>(fileSize));
+        mapFile.read(text.data(), fileSize);
+        text.resize(static_cast<size_t>(mapFile.gcount()));
+    }
+    mapFile.close();
+
+    if (!ParseTextMap(text, mapData)) {
+        mapData.obstacles.clear();
+        return mapData; // 返回加载失败的MapData
+    }
+
+    // 障碍物只在加载时变化，这里一次性构建宽相位加速结构
+    BuildAccelerationStructures(mapData);
+    mapData.loadedSuccessfully = true; // 标记加载成功
+    return mapData;
+}
+
+MapData LoadCompiledMap(const std::string& filename) {
+    MapData mapData;
+    mapData.loadedSuccessfully = false;
+
+    MappedFile file(filename);
+    if (!file.IsOpen()) {
+        LOG_ERROR("[Game] Error: Could not map compiled map file: %s", filename.c_str());
+        return mapData;
+    }
+
+    CompiledMapHeader header;
+    if (file.Size() < sizeof(header)) {
+        LOG_ERROR("[Game] Error: Compiled map file is truncated: %s", filename.c_str());
+        return mapData;
+    }
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, COMPILED_MAP_MAGIC, sizeof(header.magic)) != 0 ||
+        header.headerSize != sizeof(CompiledMapHeader)) {
+        LOG_ERROR("[Game] Error: Not a compiled map file: %s", filename.c_str());
+        return mapData;
+    }
+    if (header.version != COMPILED_MAP_VERSION) {
+        LOG_ERROR("[Game] Error: Compiled map %s has version %u, expected %u. Recompile it with MapCompiler.",
+            filename.c_str(), header.version, COMPILED_MAP_VERSION);
+        return mapData;
+    }
+    const uint64_t fileSize = file.Size();
+    if (header.fileSize != fileSize ||
+        !SectionFits(header.obstaclesOffset, header.obstacleCount, sizeof(AABB), fileSize) ||
+        !SectionFits(header.bvhNodesOffset, header.bvhNodeCount, sizeof(BvhNode), fileSize) ||
+        !SectionFits(header.bvhIndicesOffset, header.bvhIndexCount, sizeof(uint32_t), fileSize)) {
+        LOG_ERROR("[Game] Error: Compiled map file is corrupt: %s", filename.c_str());
+        return mapData;
+    }
+
+    // 各段整块复制，不做逐项解析
+    mapData.victoryPoint = { header.victoryPoint[0], header.victoryPoint[1], header.victoryPoint[2] };
+    mapData.obstacles.resize(header.obstacleCount);
+    std::memcpy(mapData.obstacles.data(), file.Data() + header.obstaclesOffset, header.obstacleCount * sizeof(AABB));
+
+    bool hasBvh = header.bvhNodeCount > 0;
+    if (hasBvh) {
+        std::vector<BvhNode> nodes(header.bvhNodeCount);
+        std::vector<uint32_t> indices(header.bvhIndexCount);
+        std::memcpy(nodes.data(), file.Data() + header.bvhNodesOffset, nodes.size() * sizeof(BvhNode));
+        std::memcpy(indices.data(), file.Data() + header.bvhIndicesOffset, indices.size() * sizeof(uint32_t));
+        if (!ValidateBvh(nodes, indices, mapData.obstacles.size())) {
+            LOG_WARN("[Game] Warning: Compiled map %s has an invalid BVH, rebuilding it.", filename.c_str());
+            hasBvh = false;
+        }
+        else {
+            mapData.obstacleBvh.Assign(std::move(nodes), std::move(indices));
+        }
+    }
+
+    // 网格与SoA的构建是线性的，载入时现场构建；BVH已恢复时跳过SAH构建
+    BuildAccelerationStructures(mapData, !hasBvh);
+    mapData.loadedSuccessfully = true;
+    return mapData;
+}
+
+bool WriteCompiledMap(const MapData& mapData, const std::string& filename) {
+    const std::vector<BvhNode>& nodes = mapData.obstacleBvh.Nodes();
+    const std::vector<uint32_t>& indices = mapData.obstacleBvh.PrimIndices();
+
+    CompiledMapHeader header{};
+    std::memcpy(header.magic, COMPILED_MAP_MAGIC, sizeof(header.magic));
+    header.version = COMPILED_MAP_VERSION;
+    header.headerSize = sizeof(CompiledMapHeader);
+    header.obstacleCount = static_cast<uint32_t>(mapData.obstacles.size());
+    header.victoryPoint[0] = mapData.victoryPoint.x;
+    header.victoryPoint[1] = mapData.victoryPoint.y;
+    header.victoryPoint[2] = mapData.victoryPoint.z;
+    header.bvhNodeCount = static_cast<uint32_t>(nodes.size());
+    header.bvhIndexCount = static_cast<uint32_t>(indices.size());
+    header.obstaclesOffset = AlignUp(sizeof(CompiledMapHeader));
+    header.bvhNodesOffset = AlignUp(header.obstaclesOffset + mapData.obstacles.size() * sizeof(AABB));
+    header.bvhIndicesOffset = AlignUp(header.bvhNodesOffset + nodes.size() * sizeof(BvhNode));
+    header.fileSize = header.bvhIndicesOffset + indices.size() * sizeof(uint32_t);
+
+    std::vector<char> image(header.fileSize, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + header.obstaclesOffset, mapData.obstacles.data(), mapData.obstacles.size() * sizeof(AABB));
+    std::memcpy(image.data() + header.bvhNodesOffset, nodes.data(), nodes.size() * sizeof(BvhNode));
+    std::memcpy(image.data() + header.bvhIndicesOffset, indices.data(), indices.size() * sizeof(uint32_t));
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+        LOG_ERROR("[Game] Error: Could not write compiled map file: %s", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string CompiledMapPath(const std::string& textFile) {
+    return std::filesystem::path(textFile).replace_extension(COMPILED_MAP_EXTENSION).string();
+}
+
+MapData LoadMap(const std::string& filename) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (fs::path(filename).extension() == COMPILED_MAP_EXTENSION) {
+        return LoadCompiledMap(filename);
+    }
+
+    // 文本地图比预编译文件新时说明编辑后没有重新编译，以文本为准
+    const std::string compiledFile = CompiledMapPath(filename);
+    if (fs::exists(compiledFile, ec)) {
+        auto compiledTime = fs::last_write_time(compiledFile, ec);
+        bool upToDate = !ec;
+        if (upToDate && fs::exists(filename, ec)) {
+            auto textTime = fs::last_write_time(filename, ec);
+            upToDate = !ec && compiledTime >= textTime;
+        }
+        if (upToDate) {
+            MapData mapData = LoadCompiledMap(compiledFile);
+            if (mapData.loadedSuccessfully) {
+                return mapData;
+            }
+            LOG_WARN("[Game] Warning: Falling back to text map %s", filename.c_str());
+        }
+        else {
+            LOG_WARN("[Game] Warning: %s is older than %s, using the text map.", compiledFile.c_str(), filename.c_str());
+        }
+    }
+    return LoadTextMap(filename);
+}
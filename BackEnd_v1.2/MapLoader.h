@@ -0,0 +1,56 @@
+// MapLoader.h
+#pragma once
+
+#include "MapData.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 预编译二进制地图格式（主机字节序，x86/ARM均为小端）：
+//   CompiledMapHeader
+//   AABB[obstacleCount]          障碍物，原样存放
+//   BvhNode[bvhNodeCount]        预先构建好的BVH节点
+//   uint32_t[bvhIndexCount]      BVH叶子引用的障碍物下标
+// 各段起始位置按 COMPILED_MAP_ALIGNMENT 对齐，载入时映射文件后直接整段复制，不做任何文本解析
+// 格式有任何不兼容的改动都必须增加 COMPILED_MAP_VERSION，旧版本文件会被拒绝并回退到文本地图
+constexpr char COMPILED_MAP_MAGIC[4] = { 'I', 'W', 'M', 'B' };
+constexpr uint32_t COMPILED_MAP_VERSION = 1;
+constexpr uint64_t COMPILED_MAP_ALIGNMENT = 16;
+constexpr const char* COMPILED_MAP_EXTENSION = ".iwmap";
+
+struct CompiledMapHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t headerSize;    // sizeof(CompiledMapHeader)，防止结构体布局不同的构建互相读取
+    uint32_t obstacleCount;
+    float victoryPoint[3];
+    uint32_t bvhNodeCount;  // 为 0 时载入后现场构建BVH
+    uint32_t bvhIndexCount;
+    uint32_t reserved;
+    uint64_t obstaclesOffset;
+    uint64_t bvhNodesOffset;
+    uint64_t bvhIndicesOffset;
+    uint64_t fileSize;
+};
+
+// 解析文本地图并构建加速结构
+// 文件格式:
+// 第一行: victory_point x y z
+// 之后每行: obstacle_aabb min_x min_y min_z max_x max_y max_z
+MapData LoadTextMap(const std::string& filename);
+
+// 只解析内存中的文本地图内容（胜利点与障碍物），不构建加速结构
+// 单遍扫描，数值用 std::from_chars 解析，除 obstacles 的增长外不分配内存；格式错误时返回 false
+bool ParseTextMap(std::string_view text, MapData& mapData);
+
+// 通过内存映射读取预编译地图；文件不存在、版本不符或内容损坏时返回的 loadedSuccessfully 为 false
+MapData LoadCompiledMap(const std::string& filename);
+
+// 写出预编译地图，mapData 的加速结构需要已经构建好
+bool WriteCompiledMap(const MapData& mapData, const std::string& filename);
+
+// 文本地图对应的预编译文件路径：map.txt -> map.iwmap
+std::string CompiledMapPath(const std::string& textFile);
+
+// 载入地图：存在不比文本地图旧的预编译文件时优先使用它，否则（或读取失败时）回退到文本解析
+MapData LoadMap(const std::string& filename);
@@ -0,0 +1,130 @@
+// MapWatcher.cpp
+
+#include "MapWatcher.h"
+#include "MapLoader.h"
+#include "Logger.h"
+#include <chrono>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr int WATCH_TIMEOUT_MS = 250;  // 等待文件变化的单次超时，也决定了析构时最长的等待时间
+    constexpr int SETTLE_TIME_MS = 100;    // 变化后等文件安静这么久再载入，避免读到写了一半的文件
+}
+
+MapWatcher::MapWatcher(std::string mapFile, std::shared_ptr<const MapData> initialMap)
+    : mapFile_(std::move(mapFile)), compiledFile_(CompiledMapPath(mapFile_)), current_(std::move(initialMap)) {
+    namespace fs = std::filesystem;
+#ifdef __linux__
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ >= 0) {
+        // 监视所在目录而不是文件本身：编辑器常用“写临时文件再改名”的方式保存，文件本身的inode会被替换
+        fs::path dir = fs::path(mapFile_).parent_path();
+        std::string dirName = dir.empty() ? "." : dir.string();
+        if (inotify_add_watch(inotifyFd_, dirName.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            close(inotifyFd_);
+            inotifyFd_ = -1;
+        }
+    }
+    if (inotifyFd_ < 0) {
+        LOG_WARN("[Game] Warning: Could not watch %s with inotify, hot reload disabled.", mapFile_.c_str());
+        return;
+    }
+#else
+    std::error_code ec;
+    lastTextTime_ = fs::last_write_time(mapFile_, ec);
+    lastCompiledTime_ = fs::last_write_time(compiledFile_, ec);
+#endif
+    thread_ = std::thread(&MapWatcher::Run, this);
+    LOG_INFO("[Game] Watching %s for changes.", mapFile_.c_str());
+}
+
+MapWatcher::~MapWatcher() {
+    stopping_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        close(inotifyFd_);
+    }
+#endif
+}
+
+void MapWatcher::Run() {
+    while (!stopping_) {
+        if (WaitForChange(WATCH_TIMEOUT_MS)) {
+            // 连续的写入事件合并为一次重载
+            while (!stopping_ && WaitForChange(SETTLE_TIME_MS)) {
+            }
+            if (!stopping_) {
+                Reload();
+            }
+        }
+        CollectRetired();
+    }
+}
+
+#ifdef __linux__
+
+bool MapWatcher::WaitForChange(int timeoutMs) {
+    pollfd pfd = { inotifyFd_, POLLIN, 0 };
+    if (poll(&pfd, 1, timeoutMs) <= 0) {
+        return false;
+    }
+    const std::string textName = std::filesystem::path(mapFile_).filename().string();
+    const std::string compiledName = std::filesystem::path(compiledFile_).filename().string();
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            if (event->len > 0 && (textName == event->name || compiledName == event->name)) {
+                changed = true;
+            }
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+#else
+
+bool MapWatcher::WaitForChange(int timeoutMs) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    std::error_code ec;
+    auto textTime = std::filesystem::last_write_time(mapFile_, ec);
+    auto compiledTime = std::filesystem::last_write_time(compiledFile_, ec);
+    bool changed = textTime != lastTextTime_ || compiledTime != lastCompiledTime_;
+    lastTextTime_ = textTime;
+    lastCompiledTime_ = compiledTime;
+    return changed;
+}
+
+#endif
+
+void MapWatcher::Reload() {
+    auto start = std::chrono::steady_clock::now();
+    auto mapData = std::make_shared<MapData>(LoadMap(mapFile_));
+    if (!mapData->loadedSuccessfully) {
+        LOG_WARN("[Game] Warning: Reloading %s failed, keeping the current map.", mapFile_.c_str());
+        return;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    // 发布新地图；旧地图留在 retired_ 中，等逻辑帧线程不再引用后由本线程释放
+    retired_.push_back(current_.exchange(std::move(mapData), std::memory_order_acq_rel));
+    generation_.fetch_add(1, std::memory_order_release);
+    LOG_INFO("[Game] Map %s reloaded in %.2f ms (%zu obstacles).", mapFile_.c_str(), elapsed.count(),
+        Current()->obstacles.size());
+}
+
+void MapWatcher::CollectRetired() {
+    // 旧地图已不可能再被 Current() 取到，引用计数降到 1（只剩这里）即可安全释放
+    std::erase_if(retired_, [](const std::shared_ptr<const MapData>& map) { return map.use_count() == 1; });
+}
@@ -0,0 +1,49 @@
+// MapWatcher.h
+#pragma once
+
+#include "MapData.h"
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 地图热重载：后台线程监视地图文件（Linux 上使用 inotify，其他平台定期检查修改时间），
+// 文件变化后在后台线程重新载入并构建加速结构，再以原子指针交换的方式发布（类似RCU）
+// 逻辑帧线程只做一次原子读取拿到最新地图，不会因文件I/O或索引构建而阻塞；
+// 被替换下来的旧地图由后台线程在没有逻辑帧线程引用后释放
+class MapWatcher {
+public:
+    MapWatcher(std::string mapFile, std::shared_ptr<const MapData> initialMap);
+    ~MapWatcher();
+
+    MapWatcher(const MapWatcher&) = delete;
+    MapWatcher& operator=(const MapWatcher&) = delete;
+
+    // 每发布一次新地图加一，逻辑帧线程据此判断是否需要切换
+    uint64_t Generation() const { return generation_.load(std::memory_order_acquire); }
+    std::shared_ptr<const MapData> Current() const { return current_.load(std::memory_order_acquire); }
+
+private:
+    void Run();
+    // 阻塞等待地图文件（文本或预编译文件）发生变化，最多等待 timeoutMs 毫秒；变化时返回 true
+    bool WaitForChange(int timeoutMs);
+    void Reload();
+    // 释放已经没有其他引用的旧地图
+    void CollectRetired();
+
+    std::string mapFile_;
+    std::string compiledFile_;
+    std::atomic<std::shared_ptr<const MapData>> current_;
+    std::atomic<uint64_t> generation_{ 0 };
+    std::atomic<bool> stopping_{ false };
+    std::vector<std::shared_ptr<const MapData>> retired_; // 只由后台线程访问
+#ifdef __linux__
+    int inotifyFd_ = -1;
+#else
+    std::filesystem::file_time_type lastTextTime_{};
+    std::filesystem::file_time_type lastCompiledTime_{};
+#endif
+    std::thread thread_;
+};
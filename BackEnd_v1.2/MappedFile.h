@@ -0,0 +1,32 @@
+// MappedFile.h
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 只读内存映射文件（Windows 使用 CreateFileMapping，其他平台使用 mmap）
+// 映射在对象析构时解除；打开失败时 IsOpen() 为 false
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return data_ != nullptr; }
+    const unsigned char* Data() const { return static_cast<const unsigned char*>(data_); }
+    size_t Size() const { return size_; }
+
+private:
+    const void* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+};
@@ -0,0 +1,187 @@
+// ObstacleSoA.cpp
+
+#include "ObstacleSoA.h"
+#include <bit>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define IWANNA_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang 需要按函数开启指令集，MSVC 可以直接使用所有内建函数
+#if defined(IWANNA_X86) && (defined(__GNUC__) || defined(__clang__))
+#define IWANNA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define IWANNA_TARGET_AVX2
+#endif
+
+namespace {
+
+using OverlapMaskFn = uint32_t(*)(const ObstacleSoA&, const AABB&, size_t);
+
+// 标量版本：逐个比较，作为不支持SIMD时的后备
+uint32_t OverlapMaskScalar(const ObstacleSoA& soa, const AABB& box, size_t base) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < ObstacleSoA::LANES; ++i) {
+        size_t k = base + i;
+        bool hit = box.max.x > soa.MinX()[k] && box.min.x < soa.MaxX()[k] &&
+            box.max.y > soa.MinY()[k] && box.min.y < soa.MaxY()[k] &&
+            box.max.z > soa.MinZ()[k] && box.min.z < soa.MaxZ()[k];
+        mask |= static_cast<uint32_t>(hit) << i;
+    }
+    return mask;
+}
+
+#ifdef IWANNA_X86
+// SSE2版本：每条指令比较4个障碍物，两次覆盖8个
+uint32_t OverlapMaskSse2(const ObstacleSoA& soa, const AABB& box, size_t base) {
+    const __m128 pMinX = _mm_set1_ps(box.min.x), pMaxX = _mm_set1_ps(box.max.x);
+    const __m128 pMinY = _mm_set1_ps(box.min.y), pMaxY = _mm_set1_ps(box.max.y);
+    const __m128 pMinZ = _mm_set1_ps(box.min.z), pMaxZ = _mm_set1_ps(box.max.z);
+    uint32_t mask = 0;
+    for (size_t half = 0; half < 2; ++half) {
+        size_t k = base + half * 4;
+        __m128 x = _mm_and_ps(_mm_cmpgt_ps(pMaxX, _mm_loadu_ps(soa.MinX() + k)), _mm_cmplt_ps(pMinX, _mm_loadu_ps(soa.MaxX() + k)));
+        __m128 y = _mm_and_ps(_mm_cmpgt_ps(pMaxY, _mm_loadu_ps(soa.MinY() + k)), _mm_cmplt_ps(pMinY, _mm_loadu_ps(soa.MaxY() + k)));
+        __m128 z = _mm_and_ps(_mm_cmpgt_ps(pMaxZ, _mm_loadu_ps(soa.MinZ() + k)), _mm_cmplt_ps(pMinZ, _mm_loadu_ps(soa.MaxZ() + k)));
+        mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(_mm_and_ps(x, y), z))) << (half * 4);
+    }
+    return mask;
+}
+
+// AVX2版本：一条比较指令覆盖8个障碍物
+IWANNA_TARGET_AVX2
+uint32_t OverlapMaskAvx2(const ObstacleSoA& soa, const AABB& box, size_t base) {
+    __m256 x = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_set1_ps(box.max.x), _mm256_loadu_ps(soa.MinX() + base), _CMP_GT_OQ),
+        _mm256_cmp_ps(_mm256_set1_ps(box.min.x), _mm256_loadu_ps(soa.MaxX() + base), _CMP_LT_OQ));
+    __m256 y = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_set1_ps(box.max.y), _mm256_loadu_ps(soa.MinY() + base), _CMP_GT_OQ),
+        _mm256_cmp_ps(_mm256_set1_ps(box.min.y), _mm256_loadu_ps(soa.MaxY() + base), _CMP_LT_OQ));
+    __m256 z = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_set1_ps(box.max.z), _mm256_loadu_ps(soa.MinZ() + base), _CMP_GT_OQ),
+        _mm256_cmp_ps(_mm256_set1_ps(box.min.z), _mm256_loadu_ps(soa.MaxZ() + base), _CMP_LT_OQ));
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(x, y), z)));
+}
+
+// 扫描循环本身也放进带 target 的函数里，使 AVX2 内核可以被内联
+IWANNA_TARGET_AVX2
+void ScanAvx2(const ObstacleSoA& soa, const AABB& box, std::vector<uint32_t>& out) {
+    for (size_t base = 0; base < soa.PaddedSize(); base += ObstacleSoA::LANES) {
+        for (uint32_t mask = OverlapMaskAvx2(soa, box, base); mask != 0; mask &= mask - 1) {
+            out.push_back(static_cast<uint32_t>(base) + std::countr_zero(mask));
+        }
+    }
+}
+#endif
+
+template <OverlapMaskFn Kernel>
+void Scan(const ObstacleSoA& soa, const AABB& box, std::vector<uint32_t>& out) {
+    for (size_t base = 0; base < soa.PaddedSize(); base += ObstacleSoA::LANES) {
+        for (uint32_t mask = Kernel(soa, box, base); mask != 0; mask &= mask - 1) {
+            out.push_back(static_cast<uint32_t>(base) + std::countr_zero(mask));
+        }
+    }
+}
+
+SimdLevel DetectSimdLevelOnce() {
+#ifdef IWANNA_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) { // 操作系统需保存YMM寄存器
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    if (avx2) return SimdLevel::Avx2;
+    if (sse2) return SimdLevel::Sse2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+#endif
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel ClampLevel(SimdLevel level) {
+    return static_cast<int>(level) > static_cast<int>(DetectSimdLevel()) ? DetectSimdLevel() : level;
+}
+
+} // namespace
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel level = DetectSimdLevelOnce();
+    return level;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Sse2: return "sse2";
+    case SimdLevel::Avx2: return "avx2";
+    }
+    return "unknown";
+}
+
+void ObstacleSoA::Clear() {
+    count_ = 0;
+    for (auto* column : { &minX_, &minY_, &minZ_, &maxX_, &maxY_, &maxZ_ }) {
+        column->clear();
+    }
+}
+
+void ObstacleSoA::Build(const std::vector<AABB>& boxes) {
+    Clear();
+    count_ = boxes.size();
+    const size_t padded = (count_ + LANES - 1) / LANES * LANES;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    for (auto* column : { &minX_, &minY_, &minZ_ }) {
+        column->assign(padded, inf);
+    }
+    for (auto* column : { &maxX_, &maxY_, &maxZ_ }) {
+        column->assign(padded, -inf);
+    }
+    for (size_t i = 0; i < count_; ++i) {
+        minX_[i] = boxes[i].min.x; minY_[i] = boxes[i].min.y; minZ_[i] = boxes[i].min.z;
+        maxX_[i] = boxes[i].max.x; maxY_[i] = boxes[i].max.y; maxZ_[i] = boxes[i].max.z;
+    }
+}
+
+uint32_t ObstacleSoA::OverlapMask8(const AABB& box, size_t base) const {
+    return OverlapMask8(box, base, DetectSimdLevel());
+}
+
+uint32_t ObstacleSoA::OverlapMask8(const AABB& box, size_t base, SimdLevel level) const {
+    switch (ClampLevel(level)) {
+#ifdef IWANNA_X86
+    case SimdLevel::Avx2: return OverlapMaskAvx2(*this, box, base);
+    case SimdLevel::Sse2: return OverlapMaskSse2(*this, box, base);
+#endif
+    default: return OverlapMaskScalar(*this, box, base);
+    }
+}
+
+void ObstacleSoA::Query(const AABB& box, std::vector<uint32_t>& out) const {
+    Query(box, out, DetectSimdLevel());
+}
+
+void ObstacleSoA::Query(const AABB& box, std::vector<uint32_t>& out, SimdLevel level) const {
+    switch (ClampLevel(level)) {
+#ifdef IWANNA_X86
+    case SimdLevel::Avx2: ScanAvx2(*this, box, out); return;
+    case SimdLevel::Sse2: Scan<OverlapMaskSse2>(*this, box, out); return;
+#endif
+    default: Scan<OverlapMaskScalar>(*this, box, out); return;
+    }
+}
@@ -0,0 +1,51 @@
+// ObstacleSoA.h
+#pragma once
+
+#include "3DPos.h"
+#include <vector>
+#include <cstdint>
+
+// SIMD指令级别，启动时检测一次CPU支持的最高级别
+enum class SimdLevel {
+    Scalar,
+    Sse2, // 每次4个障碍物，8个需要两次
+    Avx2, // 每次8个障碍物
+};
+
+SimdLevel DetectSimdLevel();
+const char* SimdLevelName(SimdLevel level);
+
+// 结构数组(SoA)形式存储的障碍物，六个分量各自连续存放
+// 长度补齐到8的倍数，补齐项为 min=+inf / max=-inf 的空盒，永远不会命中
+class ObstacleSoA {
+public:
+    static constexpr size_t LANES = 8;
+
+    void Build(const std::vector<AABB>& boxes);
+    void Clear();
+
+    size_t Size() const { return count_; }
+    size_t PaddedSize() const { return minX_.size(); }
+
+    // 测试 box 与 [base, base + 8) 这8个障碍物是否重叠（判定与 CheckAABBCollision 相同）
+    // 返回命中位掩码，bit i 对应障碍物 base + i；base 必须是8的倍数
+    uint32_t OverlapMask8(const AABB& box, size_t base) const;
+    uint32_t OverlapMask8(const AABB& box, size_t base, SimdLevel level) const;
+
+    // 扫描全部障碍物，把与 box 重叠的下标按升序追加到 out
+    void Query(const AABB& box, std::vector<uint32_t>& out) const;
+    // 指定内核级别（用于基准对比）；级别超过CPU支持时退回到检测到的级别
+    void Query(const AABB& box, std::vector<uint32_t>& out, SimdLevel level) const;
+
+    const float* MinX() const { return minX_.data(); }
+    const float* MinY() const { return minY_.data(); }
+    const float* MinZ() const { return minZ_.data(); }
+    const float* MaxX() const { return maxX_.data(); }
+    const float* MaxY() const { return maxY_.data(); }
+    const float* MaxZ() const { return maxZ_.data(); }
+
+private:
+    size_t count_ = 0;
+    std::vector<float> minX_, minY_, minZ_;
+    std::vector<float> maxX_, maxY_, maxZ_;
+};
@@ -0,0 +1,185 @@
+// PlayerBatch.cpp
+
+#include "PlayerBatch.h"
+#include <algorithm>
+
+uint32_t PlayerBatch::Add(const PlayerState& state) {
+    uint32_t slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    }
+    else {
+        slot = AppendSlot();
+    }
+    Set(slot, state);
+    SetInput(slot, {});
+    active[slot] = 1;
+    return slot;
+}
+
+void PlayerBatch::AddAt(uint32_t slot, const PlayerState& state) {
+    if (IsActive(slot)) {
+        return;
+    }
+    // 中间跳过的槽位进入空闲列表
+    while (active.size() <= slot) {
+        freeSlots_.push_back(AppendSlot());
+    }
+    auto it = std::find(freeSlots_.begin(), freeSlots_.end(), slot);
+    if (it != freeSlots_.end()) {
+        *it = freeSlots_.back();
+        freeSlots_.pop_back();
+    }
+    Set(slot, state);
+    SetInput(slot, {});
+    active[slot] = 1;
+}
+
+uint32_t PlayerBatch::AppendSlot() {
+    const uint32_t slot = static_cast<uint32_t>(active.size());
+    for (auto* column : { &posX, &posY, &posZ, &velX, &velY, &velZ, &nextX, &nextY, &nextZ }) {
+        column->push_back(0.0f);
+    }
+    for (auto* column : { &isInAir, &hasWon, &active, &moveForward, &moveBackward, &moveLeft, &moveRight,
+        &jumpPressed, &simulate, &collided }) {
+        column->push_back(0);
+    }
+    return slot;
+}
+
+void PlayerBatch::Remove(uint32_t slot) {
+    if (!IsActive(slot)) {
+        return;
+    }
+    active[slot] = 0;
+    simulate[slot] = 0;
+    freeSlots_.push_back(slot);
+}
+
+void PlayerBatch::Clear() {
+    for (auto* column : { &posX, &posY, &posZ, &velX, &velY, &velZ, &nextX, &nextY, &nextZ }) {
+        column->clear();
+    }
+    for (auto* column : { &isInAir, &hasWon, &active, &moveForward, &moveBackward, &moveLeft, &moveRight,
+        &jumpPressed, &simulate, &collided }) {
+        column->clear();
+    }
+    freeSlots_.clear();
+}
+
+PlayerState PlayerBatch::Get(uint32_t slot) const {
+    PlayerState state;
+    state.pos = { posX[slot], posY[slot], posZ[slot] };
+    state.velocity = { velX[slot], velY[slot], velZ[slot] };
+    state.isInAir = isInAir[slot] != 0;
+    state.hasWon = hasWon[slot] != 0;
+    return state;
+}
+
+void PlayerBatch::Set(uint32_t slot, const PlayerState& state) {
+    posX[slot] = state.pos.x; posY[slot] = state.pos.y; posZ[slot] = state.pos.z;
+    velX[slot] = state.velocity.x; velY[slot] = state.velocity.y; velZ[slot] = state.velocity.z;
+    isInAir[slot] = state.isInAir;
+    hasWon[slot] = state.hasWon;
+}
+
+void PlayerBatch::SetInput(uint32_t slot, const PlayerInputState& input) {
+    moveForward[slot] = input.moveForward;
+    moveBackward[slot] = input.moveBackward;
+    moveLeft[slot] = input.moveLeft;
+    moveRight[slot] = input.moveRight;
+    jumpPressed[slot] = input.jumpPressed;
+}
+
+// 以下循环只做逐元素的算术和条件选择（没有分支、没有跨元素依赖），
+// 编译器可以把它们向量化；不参与模拟的槽位通过 simulate 掩码保持原值
+void PlayerBatch::IntegrateMovement(float deltaTime) {
+    const size_t count = Capacity();
+    const uint8_t* __restrict act = active.data();
+    const uint8_t* __restrict won = hasWon.data();
+    uint8_t* __restrict sim = simulate.data();
+    uint8_t* __restrict hit = collided.data();
+    for (size_t i = 0; i < count; ++i) {
+        sim[i] = act[i] & (won[i] ^ 1); // 已胜利的玩家不再更新
+        hit[i] = 0;
+    }
+
+    // 1. 根据输入计算目标水平速度
+    const uint8_t* __restrict fwd = moveForward.data();
+    const uint8_t* __restrict back = moveBackward.data();
+    const uint8_t* __restrict left = moveLeft.data();
+    const uint8_t* __restrict right = moveRight.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vz = velZ.data();
+    for (size_t i = 0; i < count; ++i) {
+        float targetX = (static_cast<float>(right[i]) - static_cast<float>(left[i])) * GameConstants::MOVE_SPEED;
+        float targetZ = (static_cast<float>(fwd[i]) - static_cast<float>(back[i])) * GameConstants::MOVE_SPEED;
+        vx[i] = sim[i] ? targetX : vx[i];
+        vz[i] = sim[i] ? targetZ : vz[i];
+    }
+
+    // 2. 处理跳跃  3. 应用重力
+    const uint8_t* __restrict jump = jumpPressed.data();
+    uint8_t* __restrict air = isInAir.data();
+    float* __restrict vy = velY.data();
+    const float gravityStep = GameConstants::GRAVITY * deltaTime;
+    for (size_t i = 0; i < count; ++i) {
+        bool jumping = jump[i] && !air[i];
+        float newVy = jumping ? GameConstants::JUMP_FORCE : vy[i];
+        uint8_t newAir = jumping ? 1 : air[i];
+        newVy = newAir ? std::max(newVy - gravityStep, GameConstants::MAX_FALL_VELOCITY) : 0.0f;
+        vy[i] = sim[i] ? newVy : vy[i];
+        air[i] = sim[i] ? newAir : air[i];
+    }
+
+    // 4. 计算无碰撞时的下一位置
+    const float* __restrict px = posX.data();
+    const float* __restrict py = posY.data();
+    const float* __restrict pz = posZ.data();
+    float* __restrict nx = nextX.data();
+    float* __restrict ny = nextY.data();
+    float* __restrict nz = nextZ.data();
+    for (size_t i = 0; i < count; ++i) {
+        nx[i] = px[i] + vx[i] * deltaTime;
+        ny[i] = py[i] + vy[i] * deltaTime;
+        nz[i] = pz[i] + vz[i] * deltaTime;
+    }
+}
+
+void PlayerBatch::ApplyGroundAndCommit() {
+    const size_t count = Capacity();
+    const uint8_t* __restrict sim = simulate.data();
+    const uint8_t* __restrict hit = collided.data();
+    const float* __restrict nx = nextX.data();
+    const float* __restrict ny = nextY.data();
+    const float* __restrict nz = nextZ.data();
+    float* __restrict px = posX.data();
+    float* __restrict py = posY.data();
+    float* __restrict pz = posZ.data();
+    float* __restrict vy = velY.data();
+    uint8_t* __restrict air = isInAir.data();
+    for (size_t i = 0; i < count; ++i) {
+        // 检测与地面的碰撞：已在地面的直接夹取，刚接触地面的视为着陆
+        bool groundHit = ny[i] <= GameConstants::GROUND_LEVEL_Y && vy[i] <= 0.0f;
+        bool landed = groundHit && air[i];
+        float y = groundHit ? GameConstants::GROUND_LEVEL_Y : ny[i];
+        float newVy = landed ? 0.0f : vy[i];
+        bool newAir = landed ? false : air[i] != 0;
+        bool anyCollision = hit[i] || groundHit;
+
+        // 更新空中状态：本帧没有着陆（到地面或障碍物上），并且最终位置高于地面，则在空中
+        bool staysOnSurface = landed || (!newAir && anyCollision && newVy == 0.0f);
+        newAir = (!staysOnSurface && y > GameConstants::GROUND_LEVEL_Y) ? true : newAir;
+
+        px[i] = sim[i] ? nx[i] : px[i];
+        py[i] = sim[i] ? y : py[i];
+        pz[i] = sim[i] ? nz[i] : pz[i];
+        vy[i] = sim[i] ? newVy : vy[i];
+        air[i] = sim[i] ? static_cast<uint8_t>(newAir) : air[i];
+    }
+}
+
+void PlayerBatch::ClearFrameInputs() {
+    std::fill(jumpPressed.begin(), jumpPressed.end(), uint8_t{ 0 });
+}
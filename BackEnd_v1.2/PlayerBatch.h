@@ -0,0 +1,51 @@
+// PlayerBatch.h
+#pragma once
+
+#include "3DPos.h"
+#include <vector>
+#include <cstdint>
+
+// 结构数组(SoA)形式的玩家集合，一个房间内的所有玩家（竞速模式、观战幽灵等）在这里批量模拟
+// 每个分量单独连续存放，移动/重力/地面夹取这些逐玩家独立的步骤写成简单循环，便于编译器向量化
+// 槽位(slot)一经分配就保持不变，移除的槽位进入空闲列表等待复用
+class PlayerBatch {
+public:
+    uint32_t Add(const PlayerState& state = {});
+    // 在指定槽位加入玩家（槽位由调用方分配，例如网络层）；槽位已在用时不做任何事
+    void AddAt(uint32_t slot, const PlayerState& state = {});
+    void Remove(uint32_t slot);
+    void Clear();
+
+    bool IsActive(uint32_t slot) const { return slot < active.size() && active[slot] != 0; }
+    size_t Capacity() const { return active.size(); } // 槽位总数（包括空闲槽位）
+    size_t ActiveCount() const { return active.size() - freeSlots_.size(); }
+
+    PlayerState Get(uint32_t slot) const;
+    void Set(uint32_t slot, const PlayerState& state);
+    void SetInput(uint32_t slot, const PlayerInputState& input);
+
+    // 阶段一：根据输入计算水平速度、处理跳跃与重力，并得出无碰撞时的下一位置 next*
+    // 同时标记本帧参与模拟的玩家（在用且未胜利），清空碰撞标记
+    void IntegrateMovement(float deltaTime);
+    // 阶段三（碰撞处理之后）：地面夹取，写回最终位置并更新空中状态
+    void ApplyGroundAndCommit();
+    // 重置单帧输入事件（跳跃）
+    void ClearFrameInputs();
+
+    // 状态
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<uint8_t> isInAir, hasWon, active;
+    // 输入
+    std::vector<uint8_t> moveForward, moveBackward, moveLeft, moveRight, jumpPressed;
+    // 单帧临时数据
+    std::vector<float> nextX, nextY, nextZ;
+    std::vector<uint8_t> simulate; // 本帧是否参与模拟
+    std::vector<uint8_t> collided; // 本帧是否与障碍物发生过碰撞
+
+private:
+    // 在末尾追加一个未初始化的槽位，返回其下标
+    uint32_t AppendSlot();
+
+    std::vector<uint32_t> freeSlots_;
+};
@@ -0,0 +1,277 @@
+// QuantizedCodec.cpp
+
+#include "QuantizedCodec.h"
+#include "SnapshotDelta.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+    // 按位顺序写入，每个字节从低位开始填充；越界时记为失败而不是写出缓冲区
+    class BitWriter {
+    public:
+        explicit BitWriter(std::span<char> out) : out_(out) {}
+
+        void Bits(uint32_t value, uint32_t count) {
+            if (count == 0) {
+                return;
+            }
+            accumulator_ |= static_cast<uint64_t>(value & (count == 32 ? UINT32_MAX : (1u << count) - 1)) << pending_;
+            pending_ += count;
+            while (pending_ >= 8) {
+                Flush8();
+            }
+        }
+
+        void F32(float value) { Bits(std::bit_cast<uint32_t>(value), 32); }
+
+        // 写出不足一个字节的剩余位，返回总字节数；越界时返回 0
+        size_t Finish() {
+            if (pending_ > 0) {
+                Flush8();
+                pending_ = 0;
+            }
+            return ok_ ? size_ : 0;
+        }
+
+    private:
+        void Flush8() {
+            if (size_ < out_.size()) {
+                out_[size_++] = static_cast<char>(accumulator_ & 0xFF);
+            }
+            else {
+                ok_ = false;
+            }
+            accumulator_ >>= 8;
+            pending_ = pending_ >= 8 ? pending_ - 8 : 0;
+        }
+
+        std::span<char> out_;
+        uint64_t accumulator_ = 0;
+        uint32_t pending_ = 0;
+        size_t size_ = 0;
+        bool ok_ = true;
+    };
+
+    class BitReader {
+    public:
+        explicit BitReader(std::span<const char> data) : data_(data) {}
+
+        uint32_t Bits(uint32_t count) {
+            while (available_ < count) {
+                if (position_ >= data_.size()) {
+                    ok_ = false;
+                    return 0;
+                }
+                accumulator_ |= static_cast<uint64_t>(static_cast<uint8_t>(data_[position_++])) << available_;
+                available_ += 8;
+            }
+            const uint32_t value = static_cast<uint32_t>(accumulator_ & (count == 32 ? UINT32_MAX : (1ull << count) - 1));
+            accumulator_ >>= count;
+            available_ -= count;
+            return value;
+        }
+
+        float F32() { return std::bit_cast<float>(Bits(32)); }
+
+        // 全部读取成功，且只剩最后一个字节的填充位
+        bool Done() const { return ok_ && position_ == data_.size() && available_ < 8; }
+
+    private:
+        std::span<const char> data_;
+        uint64_t accumulator_ = 0;
+        uint32_t available_ = 0;
+        size_t position_ = 0;
+        bool ok_ = true;
+    };
+
+    constexpr uint32_t FRAME_BITS_WIDTH = 5;
+
+    float Component(const Struct3D& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    uint32_t MaxQuantized(uint8_t bits) {
+        return bits >= 32 ? UINT32_MAX : (1u << bits) - 1;
+    }
+
+    // 把 [low, low + range] 内的值量化为 bits 位整数；超出范围（或不是有限值）时返回 std::nullopt
+    std::optional<uint32_t> Quantize(float value, float low, float range, uint8_t bits) {
+        const float t = (value - low) / range;
+        if (!(t >= 0.0f && t <= 1.0f)) {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(static_cast<double>(t) * MaxQuantized(bits) + 0.5); // 四舍五入，t 非负
+    }
+
+    float Dequantize(uint32_t value, float low, float range, uint8_t bits) {
+        return low + static_cast<float>(static_cast<double>(value) / MaxQuantized(bits) * range);
+    }
+
+    // 实体的全部量化值（位置 x/y/z、速度 x/y/z），有任何分量超出范围时返回 std::nullopt
+    std::optional<std::array<uint32_t, 6>> QuantizeEntity(const QuantizationFrame& frame, const PlayerState& state) {
+        std::array<uint32_t, 6> values;
+        for (int axis = 0; axis < 3; ++axis) {
+            std::optional<uint32_t> position = Quantize(Component(state.pos, axis), Component(frame.origin, axis),
+                Component(frame.extent, axis), frame.positionBits[axis]);
+            std::optional<uint32_t> velocity = Quantize(Component(state.velocity, axis), -frame.maxSpeed,
+                2.0f * frame.maxSpeed, frame.velocityBits);
+            if (!position || !velocity) {
+                return std::nullopt;
+            }
+            values[axis] = *position;
+            values[3 + axis] = *velocity;
+        }
+        return values;
+    }
+
+    uint32_t SlotBits(std::span<const QuantizedEntity> entities) {
+        uint32_t maxSlot = 0;
+        for (const QuantizedEntity& entity : entities) {
+            maxSlot = std::max(maxSlot, entity.slot);
+        }
+        return static_cast<uint32_t>(std::bit_width(maxSlot));
+    }
+}
+
+QuantizationFrame MakeQuantizationFrame(const AABB& levelBounds) {
+    AABB range = ExpandAABB(levelBounds, QUANTIZED_LEVEL_MARGIN);
+    // 地面（GROUND_LEVEL_Y）以下留出一点，玩家不会低于地面
+    range.min.y = std::min(levelBounds.min.y, GameConstants::GROUND_LEVEL_Y) - 1.0f;
+
+    QuantizationFrame frame;
+    frame.origin = range.min;
+    frame.extent = range.max - range.min;
+    for (int axis = 0; axis < 3; ++axis) {
+        // 量化步长不超过 QUANTIZED_POSITION_PRECISION 所需的位数
+        const double steps = std::ceil(static_cast<double>(Component(frame.extent, axis)) / QUANTIZED_POSITION_PRECISION);
+        const uint8_t bits = static_cast<uint8_t>(std::bit_width(static_cast<uint64_t>(std::max(steps, 1.0))));
+        frame.positionBits[axis] = std::min(bits, QUANTIZED_MAX_POSITION_BITS);
+    }
+    return frame;
+}
+
+size_t QuantizedSnapshotMaxSize(size_t entityCount) {
+    const size_t headerBits = 8 + 8 + 8 + 1 + 7 * 32 + 4 * FRAME_BITS_WIDTH + 8 + 16;
+    const size_t entityBits = 32 + 1 + 6 * 32 + 2;
+    return (headerBits + entityCount * entityBits + 7) / 8;
+}
+
+size_t EncodeQuantizedSnapshot(uint8_t frameId, const QuantizationFrame& frame, bool includeFrame,
+    std::span<const QuantizedEntity> entities, std::span<char> out) {
+    if (entities.size() > UINT16_MAX) {
+        return 0;
+    }
+    BitWriter writer(out);
+    writer.Bits(SNAPSHOT_PACKET_MAGIC, 8);
+    writer.Bits(static_cast<uint8_t>(SnapshotPacketType::QuantizedState), 8);
+    writer.Bits(frameId, 8);
+    writer.Bits(includeFrame ? 1 : 0, 1);
+    if (includeFrame) {
+        for (int axis = 0; axis < 3; ++axis) {
+            writer.F32(Component(frame.origin, axis));
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            writer.F32(Component(frame.extent, axis));
+        }
+        writer.F32(frame.maxSpeed);
+        for (uint8_t bits : frame.positionBits) {
+            writer.Bits(bits, FRAME_BITS_WIDTH);
+        }
+        writer.Bits(frame.velocityBits, FRAME_BITS_WIDTH);
+    }
+
+    const uint32_t slotBits = SlotBits(entities);
+    writer.Bits(slotBits, 8);
+    writer.Bits(static_cast<uint32_t>(entities.size()), 16);
+    for (const QuantizedEntity& entity : entities) {
+        writer.Bits(entity.slot, slotBits);
+        const std::optional<std::array<uint32_t, 6>> values = QuantizeEntity(frame, entity.state);
+        writer.Bits(values ? 0 : 1, 1);
+        if (values) {
+            for (int axis = 0; axis < 3; ++axis) {
+                writer.Bits((*values)[axis], frame.positionBits[axis]);
+            }
+            for (int axis = 0; axis < 3; ++axis) {
+                writer.Bits((*values)[3 + axis], frame.velocityBits);
+            }
+        }
+        else {
+            writer.F32(entity.state.pos.x);
+            writer.F32(entity.state.pos.y);
+            writer.F32(entity.state.pos.z);
+            writer.F32(entity.state.velocity.x);
+            writer.F32(entity.state.velocity.y);
+            writer.F32(entity.state.velocity.z);
+        }
+        writer.Bits(entity.state.isInAir ? 1 : 0, 1);
+        writer.Bits(entity.state.hasWon ? 1 : 0, 1);
+    }
+    return writer.Finish();
+}
+
+QuantizedSnapshotDecoder::Result QuantizedSnapshotDecoder::Decode(std::span<const char> data, std::vector<QuantizedEntity>& out) {
+    BitReader reader(data);
+    if (reader.Bits(8) != SNAPSHOT_PACKET_MAGIC || reader.Bits(8) != static_cast<uint8_t>(SnapshotPacketType::QuantizedState)) {
+        return Result::Malformed;
+    }
+    const uint8_t frameId = static_cast<uint8_t>(reader.Bits(8));
+    if (reader.Bits(1) != 0) {
+        QuantizationFrame frame;
+        frame.origin = { reader.F32(), reader.F32(), reader.F32() };
+        frame.extent = { reader.F32(), reader.F32(), reader.F32() };
+        frame.maxSpeed = reader.F32();
+        for (uint8_t& bits : frame.positionBits) {
+            bits = static_cast<uint8_t>(reader.Bits(FRAME_BITS_WIDTH));
+        }
+        frame.velocityBits = static_cast<uint8_t>(reader.Bits(FRAME_BITS_WIDTH));
+        for (uint8_t bits : frame.positionBits) {
+            if (bits == 0 || bits > QUANTIZED_MAX_POSITION_BITS) {
+                return Result::Malformed;
+            }
+        }
+        if (frame.velocityBits == 0 || frame.velocityBits > 24) {
+            return Result::Malformed;
+        }
+        frame_ = frame;
+        frameId_ = frameId;
+    }
+    else if (frameId_ != frameId) {
+        return Result::UnknownFrame;
+    }
+
+    const uint32_t slotBits = reader.Bits(8);
+    const uint32_t count = reader.Bits(16);
+    if (slotBits > 32) {
+        return Result::Malformed;
+    }
+    const size_t first = out.size();
+    for (uint32_t i = 0; i < count; ++i) {
+        QuantizedEntity& entity = out.emplace_back();
+        entity.slot = reader.Bits(slotBits);
+        if (reader.Bits(1) == 0) {
+            float position[3];
+            float velocity[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                position[axis] = Dequantize(reader.Bits(frame_.positionBits[axis]), Component(frame_.origin, axis),
+                    Component(frame_.extent, axis), frame_.positionBits[axis]);
+            }
+            for (int axis = 0; axis < 3; ++axis) {
+                velocity[axis] = Dequantize(reader.Bits(frame_.velocityBits), -frame_.maxSpeed, 2.0f * frame_.maxSpeed, frame_.velocityBits);
+            }
+            entity.state.pos = { position[0], position[1], position[2] };
+            entity.state.velocity = { velocity[0], velocity[1], velocity[2] };
+        }
+        else {
+            entity.state.pos = { reader.F32(), reader.F32(), reader.F32() };
+            entity.state.velocity = { reader.F32(), reader.F32(), reader.F32() };
+        }
+        entity.state.isInAir = reader.Bits(1) != 0;
+        entity.state.hasWon = reader.Bits(1) != 0;
+    }
+    if (!reader.Done()) {
+        out.resize(first);
+        return Result::Malformed;
+    }
+    return Result::Ok;
+}
@@ -0,0 +1,75 @@
+// QuantizedCodec.h
+#pragma once
+
+#include "3DPos.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// 量化、按位打包的状态编码，作为 protobuf GameState 的替代，由客户端按需协商（见 SnapshotDelta.h 中的 CodecRequest）
+// 位置以关卡范围（向外扩展一定余量）为基准量化到 1 毫米，速度在 [-QUANTIZED_MAX_SPEED, QUANTIZED_MAX_SPEED] 内量化到约 1 毫米/秒，
+// is_in_air / has_won 各占 1 位。一个数据报可以打包多个实体（玩家），每个实体带自己的槽位号
+// 超出量化范围的实体（例如掉出关卡）整体退回原始 f32，仍然精确
+//
+// 数据报按位写入（每个字节从低位开始）：
+//   [0x07 : 8][4 : 8][量化框架编号 : 8][含量化框架 : 1][量化框架]?[槽位位数 : 8][实体数 : 16][实体...]
+//   量化框架  原点 3×f32、范围 3×f32、最大速度 f32、位置位数 3×5、速度位数 5
+//   实体      槽位[槽位位数][原始 : 1][原始 ? 6×f32 : 位置 x/y/z、速度 x/y/z 的量化值][is_in_air : 1][has_won : 1]
+// 量化框架只在客户端需要时随数据报发送（刚协商、关卡范围变化、客户端重新请求）；
+// 客户端收到编号未知的数据报时应当重新发送 CodecRequest，服务器会在下一个数据报中附带量化框架
+
+// 位置量化精度（米）
+const float QUANTIZED_POSITION_PRECISION = 0.001f;
+// 关卡范围向外扩展的余量（米）：玩家可以走出障碍物的范围，跳跃也会高出最高的平台
+const Struct3D QUANTIZED_LEVEL_MARGIN = { 32.0f, 16.0f, 32.0f };
+// 速度量化范围与位数：覆盖最大下落速度，精度约 1 毫米/秒
+const float QUANTIZED_MAX_SPEED = 32.0f;
+const uint8_t QUANTIZED_VELOCITY_BITS = 16;
+// 单个位置分量最多使用的位数（关卡特别大时精度随之降低）
+const uint8_t QUANTIZED_MAX_POSITION_BITS = 24;
+
+// 量化基准：把关卡范围映射到整数
+struct QuantizationFrame {
+    Struct3D origin;                              // 量化范围的最小角
+    Struct3D extent;                              // 量化范围的尺寸
+    float maxSpeed = QUANTIZED_MAX_SPEED;
+    std::array<uint8_t, 3> positionBits = {};     // x/y/z 各自的位数
+    uint8_t velocityBits = QUANTIZED_VELOCITY_BITS;
+
+    auto operator<=>(const QuantizationFrame&) const = default;
+};
+
+// 以关卡范围（GameHandler::LevelBounds）为基准生成量化框架
+QuantizationFrame MakeQuantizationFrame(const AABB& levelBounds);
+
+// 一个实体：玩家槽位及其状态
+struct QuantizedEntity {
+    uint32_t slot = 0;
+    PlayerState state;
+};
+
+// 编码一个数据报，返回写入的字节数；out 放不下时返回 0
+size_t EncodeQuantizedSnapshot(uint8_t frameId, const QuantizationFrame& frame, bool includeFrame,
+    std::span<const QuantizedEntity> entities, std::span<char> out);
+// 一个数据报最多占用的字节数（全部实体都退回原始 f32 时）
+size_t QuantizedSnapshotMaxSize(size_t entityCount);
+
+// 客户端一侧的参考解码器（客户端按同样的规则实现），保存最近收到的量化框架
+class QuantizedSnapshotDecoder {
+public:
+    enum class Result {
+        Ok,
+        UnknownFrame, // 没有该编号的量化框架：客户端应当重新请求
+        Malformed,
+    };
+
+    // 解码一个数据报，实体追加到 out 中
+    Result Decode(std::span<const char> data, std::vector<QuantizedEntity>& out);
+
+private:
+    std::optional<uint8_t> frameId_;
+    QuantizationFrame frame_;
+};
@@ -0,0 +1,26 @@
+// Room.cpp
+
+#include "Room.h"
+#include <algorithm>
+#include <chrono>
+
+Room::Room(size_t id, const std::string& mapFile, float fixedDeltaTime)
+    : id_(id), game_(mapFile), fixedDeltaTime_(fixedDeltaTime) {
+}
+
+void Room::Advance(float frameTime) {
+    accumulator_ += frameTime;
+    while (accumulator_ >= fixedDeltaTime_) {
+        auto start = std::chrono::steady_clock::now();
+        game_.Update(fixedDeltaTime_);
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        accumulator_ -= fixedDeltaTime_;
+
+        // 记录逐帧耗时
+        ++stats_.tickCount;
+        totalTickUs_ += elapsed.count();
+        stats_.lastTickUs = elapsed.count();
+        stats_.averageTickUs = totalTickUs_ / static_cast<double>(stats_.tickCount);
+        stats_.maxTickUs = std::max(stats_.maxTickUs, elapsed.count());
+    }
+}
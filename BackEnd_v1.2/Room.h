@@ -0,0 +1,43 @@
+// Room.h
+#pragma once
+
+#include "GameHandler.h"
+#include <string>
+
+// 房间逻辑帧耗时统计（微秒），每次 Update 记一次
+struct RoomTickStats {
+    uint64_t tickCount = 0;
+    double lastTickUs = 0.0;
+    double averageTickUs = 0.0;
+    double maxTickUs = 0.0;
+};
+
+// 一个独立的关卡实例：自己的 GameHandler、自己的固定步长累加器
+// Advance 可以在任意工作线程上调用，但同一时刻只能有一个线程操作同一个房间
+class Room {
+public:
+    Room(size_t id, const std::string& mapFile, float fixedDeltaTime);
+
+    Room(const Room&) = delete;
+    Room& operator=(const Room&) = delete;
+
+    // 把本帧经过的时间累加到累加器，并执行所有完整的固定步长更新
+    // 与原先单房间主循环的语义相同，剩余不足一个步长的时间留到下一帧
+    void Advance(float frameTime);
+
+    size_t Id() const { return id_; }
+    GameHandler& Game() { return game_; }
+    const GameHandler& Game() const { return game_; }
+    float Accumulator() const { return accumulator_; }
+
+    const RoomTickStats& TickStats() const { return stats_; }
+    void ResetTickStats() { stats_ = {}; totalTickUs_ = 0.0; }
+
+private:
+    size_t id_;
+    GameHandler game_;
+    float fixedDeltaTime_;
+    float accumulator_ = 0.0f;
+    RoomTickStats stats_;
+    double totalTickUs_ = 0.0;
+};
@@ -0,0 +1,194 @@
+// ServerConfig.cpp
+
+#include "ServerConfig.h"
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+    float ParseFloat(std::string_view name, std::string_view value) {
+        float result = 0.0f;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc() || end != value.data() + value.size()) {
+            throw std::invalid_argument("Invalid number for --" + std::string(name) + ": " + std::string(value));
+        }
+        return result;
+    }
+
+    size_t ParseCount(std::string_view name, std::string_view value) {
+        size_t result = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc() || end != value.data() + value.size()) {
+            throw std::invalid_argument("Invalid count for --" + std::string(name) + ": " + std::string(value));
+        }
+        return result;
+    }
+
+    bool ParseOnOff(std::string_view name, std::string_view value) {
+        if (value == "on") return true;
+        if (value == "off") return false;
+        throw std::invalid_argument("Expected on|off for --" + std::string(name) + ": " + std::string(value));
+    }
+}
+
+ServerConfig ParseServerConfig(int argc, char* argv[]) {
+    ServerConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.substr(0, 2) != "--" || eq == std::string_view::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + std::string(arg));
+        }
+        std::string_view name = arg.substr(2, eq - 2);
+        std::string_view value = arg.substr(eq + 1);
+
+        if (name == "broadphase") {
+            auto mode = ParseBroadphaseMode(value);
+            if (!mode) {
+                throw std::invalid_argument("Invalid broadphase mode: " + std::string(value));
+            }
+            config.broadphase = *mode;
+        }
+        else if (name == "tick-rate") {
+            config.tickRate = ParseFloat(name, value);
+            if (!(config.tickRate >= 1.0f && config.tickRate <= 1000.0f)) {
+                throw std::invalid_argument("--tick-rate must be between 1 and 1000");
+            }
+        }
+        else if (name == "ccd") {
+            config.continuousCollision = ParseOnOff(name, value);
+        }
+        else if (name == "rooms") {
+            config.roomCount = ParseCount(name, value);
+            if (config.roomCount < 1 || config.roomCount > 1024) {
+                throw std::invalid_argument("--rooms must be between 1 and 1024");
+            }
+        }
+        else if (name == "threads") {
+            config.threadCount = ParseCount(name, value);
+            if (config.threadCount > 256) {
+                throw std::invalid_argument("--threads must be at most 256");
+            }
+        }
+        else if (name == "maps") {
+            config.mapFiles.clear();
+            size_t start = 0;
+            while (true) {
+                size_t comma = value.find(',', start);
+                std::string_view file = value.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+                if (file.empty()) {
+                    throw std::invalid_argument("Empty map file name in --maps");
+                }
+                config.mapFiles.emplace_back(file);
+                if (comma == std::string_view::npos) {
+                    break;
+                }
+                start = comma + 1;
+            }
+        }
+        else if (name == "room-stats") {
+            config.roomStatsInterval = ParseFloat(name, value);
+            if (!(config.roomStatsInterval >= 0.0f)) {
+                throw std::invalid_argument("--room-stats must not be negative");
+            }
+        }
+        else if (name == "log-level") {
+            auto level = Log::ParseLevel(value);
+            if (!level) {
+                throw std::invalid_argument("Invalid log level: " + std::string(value));
+            }
+            config.logLevel = *level;
+        }
+        else if (name == "hot-reload") {
+            config.mapHotReload = ParseOnOff(name, value);
+        }
+        else if (name == "shards") {
+            config.shardCount = ParseCount(name, value);
+            if (config.shardCount > 256) {
+                throw std::invalid_argument("--shards must be at most 256");
+            }
+        }
+        else if (name == "batch-io") {
+            config.batchedIo = ParseOnOff(name, value);
+        }
+        else if (name == "recv-depth") {
+            config.receiveDepth = ParseCount(name, value);
+            if (config.receiveDepth < 1 || config.receiveDepth > 64) {
+                throw std::invalid_argument("--recv-depth must be between 1 and 64");
+            }
+        }
+        else if (name == "io-uring") {
+            config.ioUring = ParseOnOff(name, value);
+        }
+        else if (name == "send-rate") {
+            config.sendRate = ParseFloat(name, value);
+            if (!(config.sendRate >= 1.0f && config.sendRate <= 1000.0f)) {
+                throw std::invalid_argument("--send-rate must be between 1 and 1000");
+            }
+        }
+        else if (name == "pacer") {
+            auto mode = ParseTickPacerMode(value);
+            if (!mode) {
+                throw std::invalid_argument("Invalid tick pacer: " + std::string(value));
+            }
+            config.tickPacer = *mode;
+        }
+        else if (name == "spin-window") {
+            config.spinWindowUs = ParseFloat(name, value);
+            if (!(config.spinWindowUs >= 0.0f && config.spinWindowUs <= 10000.0f)) {
+                throw std::invalid_argument("--spin-window must be between 0 and 10000 microseconds");
+            }
+        }
+        else if (name == "pin-cpu") {
+            config.pinCpus.clear();
+            size_t start = 0;
+            while (true) {
+                size_t comma = value.find(',', start);
+                std::string_view cpu = value.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+                const size_t index = ParseCount(name, cpu);
+                if (index > 1023) {
+                    throw std::invalid_argument("--pin-cpu indices must be at most 1023");
+                }
+                config.pinCpus.push_back(static_cast<int>(index));
+                if (comma == std::string_view::npos) {
+                    break;
+                }
+                start = comma + 1;
+            }
+        }
+        else if (name == "net-thread") {
+            config.networkThread = ParseOnOff(name, value);
+        }
+        else {
+            throw std::invalid_argument("Unknown option: --" + std::string(name));
+        }
+    }
+    if (config.shardCount > config.roomCount) {
+        throw std::invalid_argument("--shards must not exceed --rooms (each shard owns at least one room)");
+    }
+    return config;
+}
+
+void PrintServerUsage(const char* programName) {
+    std::cerr << "Usage: " << programName << " [options]\n"
+        << "  --broadphase=linear|grid|bvh|simd   obstacle broadphase used by the physics step (default: bvh)\n"
+        << "  --tick-rate=HZ                      fixed simulation rate (default: 60)\n"
+        << "  --ccd=on|off                        swept continuous collision (default: on)\n"
+        << "  --rooms=N                           independent rooms hosted by this process, room i listens on port+i (default: 1)\n"
+        << "  --threads=N                         worker threads ticking the rooms, 0 = one per core (default: 0)\n"
+        << "  --maps=FILE[,FILE...]               map file per room, reused round-robin (default: map.txt)\n"
+        << "  --room-stats=SECONDS                print per-room tick latency every SECONDS, 0 = off (default: 0)\n"
+        << "  --hot-reload=on|off                 reload map files when they change on disk (default: off)\n"
+        << "  --shards=K                          K sockets share the port via SO_REUSEPORT, each with its own thread and rooms, 0 = off (default: 0)\n"
+        << "                                      clients are placed by address hash into a shard's least-loaded room and cannot pick a room or map\n"
+        << "  --batch-io=on|off                   batch UDP receives/sends with recvmmsg/sendmmsg, Linux only (default: off)\n"
+        << "  --recv-depth=N                      concurrent async receives per socket, each with its own MTU-sized buffer (default: 4)\n"
+        << "  --io-uring=on|off                   UDP I/O through io_uring (multishot receive, one submit per tick), Linux only, falls back to asio (default: off)\n"
+        << "  --send-rate=HZ                      state updates per client per second; unchanged states are skipped (default: 60)\n"
+        << "  --pacer=timer|spin                  wait for each tick on a timer, or sleep until --spin-window before it and spin (default: timer)\n"
+        << "  --spin-window=US                    spin time before each tick deadline with --pacer=spin (default: 250)\n"
+        << "  --pin-cpu=N[,N...]                  pin the tick thread of shard i to CPU N[i % count] (default: not pinned)\n"
+        << "  --net-thread=on|off                 run socket I/O on a dedicated thread, handing inputs/states to the tick loop via lock-free queues (default: off)\n"
+        << "  --log-level=debug|info|warn|error|off  runtime log level (default: info)\n";
+}
@@ -0,0 +1,37 @@
+// ServerConfig.h
+#pragma once
+
+#include "MapData.h"
+#include "Logger.h"
+#include "TickTimer.h"
+#include <string>
+#include <vector>
+
+// 服务器启动参数，由命令行解析得到，未指定的项使用默认值
+// 参数格式: --名称=值，例如 --broadphase=linear
+struct ServerConfig {
+    BroadphaseMode broadphase = BroadphaseMode::Bvh; // --broadphase=linear|grid|bvh|simd
+    float tickRate = 60.0f;                          // --tick-rate=Hz，游戏逻辑固定更新频率
+    bool continuousCollision = true;                 // --ccd=on|off，低tick率下防止穿过薄平台
+    size_t roomCount = 1;                            // --rooms=N，同一进程内的独立房间数，房间i监听 端口+i
+    size_t threadCount = 0;                          // --threads=N，推进房间的工作线程数，0 表示按CPU核数
+    std::vector<std::string> mapFiles;               // --maps=a.txt,b.txt，房间i使用第 i % 个数 张地图，为空时用默认地图
+    float roomStatsInterval = 0.0f;                  // --room-stats=秒，定期打印各房间的逻辑帧耗时，0 表示关闭
+    LogLevel logLevel = LogLevel::Info;              // --log-level=debug|info|warn|error|off，运行时日志级别
+    bool mapHotReload = false;                       // --hot-reload=on|off，地图文件变化时不重启服务器直接重新载入
+    size_t shardCount = 0;                           // --shards=K，K 个 SO_REUSEPORT 套接字共用端口，各带一个线程和 1/K 的房间，0 表示关闭；客户端按地址哈希分到分片内人数最少的房间，不能选择房间
+    bool batchedIo = false;                          // --batch-io=on|off，Linux 上用 recvmmsg/sendmmsg 批量收发数据报
+    size_t receiveDepth = 4;                         // --recv-depth=N，异步收发时同时投递的接收数，每个占用一个 MTU 大小的接收缓冲区
+    bool ioUring = false;                            // --io-uring=on|off，Linux 上用 io_uring 收发（多发接收 + 每帧一次提交），不可用时退回 asio
+    float sendRate = 60.0f;                          // --send-rate=Hz，每个客户端每秒最多收到的状态数，与主循环频率无关
+    TickPacerMode tickPacer = TickPacerMode::Timer;  // --pacer=timer|spin，主循环等待下一帧的方式，spin 在截止时间前自旋以减小帧开始抖动
+    float spinWindowUs = 250.0f;                     // --spin-window=微秒，spin 模式下截止时间前自旋的时长
+    std::vector<int> pinCpus;                        // --pin-cpu=N[,N...]，分片 i 的主循环线程绑定到第 i % 个数 个核心，为空时不绑定
+    bool networkThread = false;                      // --net-thread=on|off，收发在独立的网络线程上进行，与模拟线程之间通过无锁队列交换输入和状态
+};
+
+// 解析命令行参数；遇到未知参数或非法取值时抛出 std::invalid_argument
+ServerConfig ParseServerConfig(int argc, char* argv[]);
+
+// 打印可用参数
+void PrintServerUsage(const char* programName);
@@ -0,0 +1,260 @@
+// SnapshotDelta.cpp
+
+#include "SnapshotDelta.h"
+#include <bit>
+
+namespace {
+    constexpr uint8_t FIELD_FLAGS = 1u << 6;
+    constexpr uint8_t FLAG_IN_AIR = 1u << 0;
+    constexpr uint8_t FLAG_HAS_WON = 1u << 1;
+
+    // 六个浮点分量按掩码位的顺序排列
+    std::array<float, 6> Components(const PlayerState& state) {
+        return { state.pos.x, state.pos.y, state.pos.z, state.velocity.x, state.velocity.y, state.velocity.z };
+    }
+
+    uint8_t Flags(const PlayerState& state) {
+        return (state.isInAir ? FLAG_IN_AIR : 0) | (state.hasWon ? FLAG_HAS_WON : 0);
+    }
+
+    // 按位比较：客户端得到的必须与服务器的值逐位相同
+    bool SameBits(float a, float b) {
+        return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+    }
+
+    // state 与基线不同的分量
+    uint8_t ChangedFields(const PlayerState& state, const PlayerState& baseline) {
+        uint8_t mask = 0;
+        const std::array<float, 6> current = Components(state);
+        const std::array<float, 6> previous = Components(baseline);
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (!SameBits(current[i], previous[i])) {
+                mask |= 1u << i;
+            }
+        }
+        if (Flags(state) != Flags(baseline)) {
+            mask |= FIELD_FLAGS;
+        }
+        return mask;
+    }
+
+    // 顺序写入/读取小端序整数，越界时记为失败而不是写出缓冲区
+    class Writer {
+    public:
+        explicit Writer(std::span<char> out) : out_(out) {}
+
+        void U8(uint8_t value) {
+            if (size_ + 1 > out_.size()) {
+                ok_ = false;
+                return;
+            }
+            out_[size_++] = static_cast<char>(value);
+        }
+
+        void U32(uint32_t value) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                U8(static_cast<uint8_t>(value >> shift));
+            }
+        }
+
+        void F32(float value) { U32(std::bit_cast<uint32_t>(value)); }
+
+        void VarU32(uint32_t value) {
+            while (value >= 0x80) {
+                U8(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            U8(static_cast<uint8_t>(value));
+        }
+
+        size_t Size() const { return ok_ ? size_ : 0; }
+
+    private:
+        std::span<char> out_;
+        size_t size_ = 0;
+        bool ok_ = true;
+    };
+
+    class Reader {
+    public:
+        explicit Reader(std::span<const char> data) : data_(data) {}
+
+        uint8_t U8() {
+            if (position_ + 1 > data_.size()) {
+                ok_ = false;
+                return 0;
+            }
+            return static_cast<uint8_t>(data_[position_++]);
+        }
+
+        uint32_t U32() {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                value |= static_cast<uint32_t>(U8()) << shift;
+            }
+            return value;
+        }
+
+        float F32() { return std::bit_cast<float>(U32()); }
+
+        uint32_t VarU32() {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                const uint8_t byte = U8();
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            ok_ = false;
+            return 0;
+        }
+
+        // 全部读取成功且恰好读完
+        bool Done() const { return ok_ && position_ == data_.size(); }
+
+    private:
+        std::span<const char> data_;
+        size_t position_ = 0;
+        bool ok_ = true;
+    };
+
+    void WriteFields(Writer& writer, uint8_t mask, const PlayerState& state) {
+        writer.U8(mask);
+        const std::array<float, 6> components = Components(state);
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (mask & (1u << i)) {
+                writer.F32(components[i]);
+            }
+        }
+        if (mask & FIELD_FLAGS) {
+            writer.U8(Flags(state));
+        }
+    }
+
+    // 把数据包中的分量覆盖到 state 上（state 为基线；完整快照的基线是默认状态）
+    void ReadFields(Reader& reader, PlayerState& state) {
+        const uint8_t mask = reader.U8();
+        std::array<float, 6> components = Components(state);
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (mask & (1u << i)) {
+                components[i] = reader.F32();
+            }
+        }
+        state.pos = { components[0], components[1], components[2] };
+        state.velocity = { components[3], components[4], components[5] };
+        if (mask & FIELD_FLAGS) {
+            const uint8_t flags = reader.U8();
+            state.isInAir = (flags & FLAG_IN_AIR) != 0;
+            state.hasWon = (flags & FLAG_HAS_WON) != 0;
+        }
+    }
+}
+
+size_t EncodeSnapshotAck(uint32_t sequence, std::span<char> out) {
+    Writer writer(out);
+    writer.U8(SNAPSHOT_PACKET_MAGIC);
+    writer.U8(static_cast<uint8_t>(SnapshotPacketType::Ack));
+    writer.VarU32(sequence);
+    return writer.Size();
+}
+
+std::optional<uint32_t> ParseSnapshotAck(std::span<const char> data) {
+    Reader reader(data);
+    if (reader.U8() != SNAPSHOT_PACKET_MAGIC || reader.U8() != static_cast<uint8_t>(SnapshotPacketType::Ack)) {
+        return std::nullopt;
+    }
+    const uint32_t sequence = reader.VarU32();
+    if (!reader.Done()) {
+        return std::nullopt;
+    }
+    return sequence;
+}
+
+size_t EncodeCodecRequest(StateCodec codec, std::span<char> out) {
+    Writer writer(out);
+    writer.U8(SNAPSHOT_PACKET_MAGIC);
+    writer.U8(static_cast<uint8_t>(SnapshotPacketType::CodecRequest));
+    writer.U8(static_cast<uint8_t>(codec));
+    return writer.Size();
+}
+
+std::optional<StateCodec> ParseCodecRequest(std::span<const char> data) {
+    Reader reader(data);
+    if (reader.U8() != SNAPSHOT_PACKET_MAGIC || reader.U8() != static_cast<uint8_t>(SnapshotPacketType::CodecRequest)) {
+        return std::nullopt;
+    }
+    const uint8_t codec = reader.U8();
+    if (!reader.Done() || codec > static_cast<uint8_t>(StateCodec::Quantized)) {
+        return std::nullopt;
+    }
+    return static_cast<StateCodec>(codec);
+}
+
+void DeltaSnapshotChannel::Acknowledge(uint32_t sequence) {
+    if (sequence > ackedSequence_ && sequence < nextSequence_) {
+        ackedSequence_ = sequence;
+    }
+}
+
+size_t DeltaSnapshotChannel::Encode(const PlayerState& state, std::span<char> out) {
+    const uint32_t sequence = nextSequence_;
+    // 基线仍在历史中（没有被之后的快照覆盖）时才能用它
+    const Entry& baseline = history_[ackedSequence_ % SNAPSHOT_HISTORY_SIZE];
+    const bool useBaseline = ackedSequence_ != 0 && baseline.sequence == ackedSequence_;
+
+    Writer writer(out);
+    writer.U8(SNAPSHOT_PACKET_MAGIC);
+    if (useBaseline) {
+        writer.U8(static_cast<uint8_t>(SnapshotPacketType::Delta));
+        writer.VarU32(sequence);
+        writer.U8(static_cast<uint8_t>(sequence - ackedSequence_)); // 基线在历史窗口内，差值不超过 SNAPSHOT_HISTORY_SIZE
+        WriteFields(writer, ChangedFields(state, baseline.state), state);
+    }
+    else {
+        writer.U8(static_cast<uint8_t>(SnapshotPacketType::Full));
+        writer.VarU32(sequence);
+        WriteFields(writer, ChangedFields(state, PlayerState{}), state);
+    }
+
+    const size_t size = writer.Size();
+    if (size == 0) {
+        return 0;
+    }
+    history_[sequence % SNAPSHOT_HISTORY_SIZE] = { sequence, state };
+    ++nextSequence_;
+    lastWasDelta_ = useBaseline;
+    return size;
+}
+
+std::optional<PlayerState> DeltaSnapshotReceiver::Decode(std::span<const char> data, uint32_t& sequence) {
+    Reader reader(data);
+    if (reader.U8() != SNAPSHOT_PACKET_MAGIC) {
+        return std::nullopt;
+    }
+    const uint8_t type = reader.U8();
+    sequence = reader.VarU32();
+    PlayerState state;
+    if (type == static_cast<uint8_t>(SnapshotPacketType::Delta)) {
+        const uint8_t offset = reader.U8();
+        const uint32_t baselineSequence = sequence - offset;
+        const Entry& baseline = history_[baselineSequence % SNAPSHOT_HISTORY_SIZE];
+        if (offset == 0 || offset > sequence || baseline.sequence != baselineSequence) {
+            return std::nullopt;
+        }
+        state = baseline.state;
+    }
+    else if (type != static_cast<uint8_t>(SnapshotPacketType::Full)) {
+        return std::nullopt;
+    }
+    ReadFields(reader, state);
+    if (!reader.Done() || sequence == 0) {
+        return std::nullopt;
+    }
+    // 乱序到达的旧快照不覆盖同一位置上更新的快照
+    Entry& entry = history_[sequence % SNAPSHOT_HISTORY_SIZE];
+    if (sequence >= entry.sequence) {
+        entry = { sequence, state };
+    }
+    return state;
+}
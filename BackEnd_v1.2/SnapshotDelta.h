@@ -0,0 +1,100 @@
+// SnapshotDelta.h
+#pragma once
+
+#include "3DPos.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// 差量状态快照
+// 客户端发送一个确认包(Ack)即表示支持差量快照，之后服务器发给它的状态不再是 protobuf 的 ServerToClient，而是下面的二进制格式：
+// 每份快照带递增的序号，客户端每收到一份就回送它的序号；服务器以客户端最近确认的那一份为基线，只发送与基线不同的分量。
+// 基线已经不在服务器的历史窗口中（确认长时间丢失）或还没有确认时，发送完整快照
+//
+// 这些数据包的第一个字节是 SNAPSHOT_PACKET_MAGIC (0x07)：字段号 0、线路类型 7，不可能是合法 protobuf 消息的开头，
+// 因此与 protobuf 消息共用同一个端口，按第一个字节区分。序号为 varint（与 protobuf 相同的 LEB128），浮点数为小端序
+//
+//   完整快照  [0x07][1][序号 varint][分量掩码 u8][分量...]                  （基线为默认的 PlayerState{}）
+//   差量快照  [0x07][2][序号 varint][序号 - 基线序号 u8][分量掩码 u8][分量...]
+//   确认      [0x07][3][序号 varint]                     （客户端 -> 服务器，序号 0 表示还没有收到任何快照）
+//   量化状态  [0x07][4]...                                （按位打包，格式见 QuantizedCodec.h）
+//   编码请求  [0x07][5][StateCodec u8]                    （客户端 -> 服务器，选择之后发给它的状态编码）
+//
+// 分量掩码第 0~2 位为位置 x/y/z，第 3~5 位为速度 x/y/z（各一个 f32），第 6 位为标志字节（第 0 位 is_in_air，第 1 位 has_won）
+// 只有与基线不同的分量才出现在数据包中
+
+const uint8_t SNAPSHOT_PACKET_MAGIC = 0x07;
+// 服务器为每个客户端保留的已发送快照数；确认落后超过这么多份时退回完整快照
+const size_t SNAPSHOT_HISTORY_SIZE = 32;
+// 单份快照的最大字节数（完整快照）
+const size_t SNAPSHOT_PACKET_MAX_SIZE = 2 + 5 + 1 + 1 + 6 * 4 + 1;
+
+enum class SnapshotPacketType : uint8_t {
+    Full = 1,
+    Delta = 2,
+    Ack = 3,
+    QuantizedState = 4,
+    CodecRequest = 5,
+};
+
+// 发给客户端的状态编码；客户端默认收到 protobuf，发送确认包即切换到差量快照，发送编码请求可以选择任意一种
+enum class StateCodec : uint8_t {
+    Protobuf = 0,
+    Delta = 1,
+    Quantized = 2,
+};
+
+// 数据包是否属于快照协议（而不是 protobuf 消息）
+inline bool IsSnapshotPacket(std::span<const char> data) {
+    return !data.empty() && static_cast<uint8_t>(data[0]) == SNAPSHOT_PACKET_MAGIC;
+}
+
+// 确认包的编码与解析；解析失败返回 std::nullopt
+size_t EncodeSnapshotAck(uint32_t sequence, std::span<char> out);
+std::optional<uint32_t> ParseSnapshotAck(std::span<const char> data);
+// 编码请求的编码与解析；未知的编码返回 std::nullopt
+size_t EncodeCodecRequest(StateCodec codec, std::span<char> out);
+std::optional<StateCodec> ParseCodecRequest(std::span<const char> data);
+
+// 服务器一侧：一个客户端的快照历史
+class DeltaSnapshotChannel {
+public:
+    // 客户端确认收到了 sequence；比已确认的更旧或者从未发送过的序号被忽略
+    void Acknowledge(uint32_t sequence);
+    // 编码下一份快照并记入历史：有可用基线时为差量快照，否则为完整快照。返回写入的字节数，out 太小时返回 0
+    size_t Encode(const PlayerState& state, std::span<char> out);
+
+    uint32_t LastSequence() const { return nextSequence_ - 1; }
+    uint32_t AckedSequence() const { return ackedSequence_; }
+    // 上一次 Encode 是否编码成了差量快照
+    bool LastWasDelta() const { return lastWasDelta_; }
+
+private:
+    struct Entry {
+        uint32_t sequence = 0;
+        PlayerState state;
+    };
+
+    bool lastWasDelta_ = false;
+    uint32_t nextSequence_ = 1;
+    uint32_t ackedSequence_ = 0;
+    std::array<Entry, SNAPSHOT_HISTORY_SIZE> history_;
+};
+
+// 客户端一侧的参考解码器（客户端按同样的规则实现；服务器自身不使用，基准测试用它验证编码）
+class DeltaSnapshotReceiver {
+public:
+    // 解码一份快照：成功时返回完整状态，并把序号写入 sequence；基线不在本地历史中或数据包损坏时返回 std::nullopt
+    // 比已收到的最新快照更旧的（乱序到达）也会被正常解码，调用方自行决定是否使用
+    std::optional<PlayerState> Decode(std::span<const char> data, uint32_t& sequence);
+
+private:
+    struct Entry {
+        uint32_t sequence = 0;
+        PlayerState state;
+    };
+
+    std::array<Entry, SNAPSHOT_HISTORY_SIZE> history_;
+};
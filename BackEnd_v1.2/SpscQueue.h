@@ -0,0 +1,74 @@
+// SpscQueue.h
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+// 有界无锁单生产者单消费者队列
+// 容量在构造时确定（向上取整到2的幂），元素存放在预先分配的数组中，入队出队都不分配内存
+// 生产者和消费者各自缓存对方的下标，只有缓存显示队列已满/已空时才去读对方的原子变量，减少缓存行来回传递
+// BeginPush/EndPush 允许生产者直接在槽位中构造数据（例如把状态直接序列化进去），Front/Pop 允许消费者原地读取
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(std::bit_ceil(capacity < 2 ? size_t(2) : capacity)),
+        mask_(slots_.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t Capacity() const { return slots_.size(); }
+
+    // 生产者：取得下一个可写槽位，队列已满时返回 nullptr。写完后调用 EndPush 发布
+    T* BeginPush() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == slots_.size()) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == slots_.size()) {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+
+    void EndPush() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool TryPush(const T& value) {
+        T* slot = BeginPush();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = value;
+        EndPush();
+        return true;
+    }
+
+    // 消费者：队首元素，队列为空时返回 nullptr。用完后调用 Pop 归还槽位
+    T* Front() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    void Pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> slots_;
+    const size_t mask_;
+    alignas(64) std::atomic<size_t> head_{ 0 }; // 消费者下一次读取的位置
+    size_t cachedTail_ = 0;                     // 消费者缓存的 tail_
+    alignas(64) std::atomic<size_t> tail_{ 0 }; // 生产者下一次写入的位置
+    size_t cachedHead_ = 0;                     // 生产者缓存的 head_
+};
@@ -0,0 +1,63 @@
+// SweptAABB.cpp
+
+#include "SweptAABB.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // 计算单个轴上的进入/离开时刻；该轴上永远不会重叠时返回 false
+    bool AxisInterval(float movingMin, float movingMax, float d, float targetMin, float targetMax,
+        float& entry, float& exit) {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        if (d == 0.0f) {
+            // 该轴上没有运动：必须一直保持重叠（与 CheckAABBCollision 一样使用严格比较）
+            if (movingMax <= targetMin || movingMin >= targetMax) {
+                return false;
+            }
+            entry = -inf;
+            exit = inf;
+            return true;
+        }
+        const float invD = 1.0f / d;
+        if (d > 0.0f) {
+            entry = (targetMin - movingMax) * invD;
+            exit = (targetMax - movingMin) * invD;
+        }
+        else {
+            entry = (targetMax - movingMin) * invD;
+            exit = (targetMin - movingMax) * invD;
+        }
+        return true;
+    }
+}
+
+SweepHit SweepAABB(const AABB& moving, const Struct3D& displacement, const AABB& target) {
+    SweepHit result;
+    float entryX, exitX, entryY, exitY, entryZ, exitZ;
+    if (!AxisInterval(moving.min.x, moving.max.x, displacement.x, target.min.x, target.max.x, entryX, exitX) ||
+        !AxisInterval(moving.min.y, moving.max.y, displacement.y, target.min.y, target.max.y, entryY, exitY) ||
+        !AxisInterval(moving.min.z, moving.max.z, displacement.z, target.min.z, target.max.z, entryZ, exitZ)) {
+        return result;
+    }
+
+    // 三个轴都进入后才算接触，任意一个轴离开就分离
+    const float entry = std::max({ entryX, entryY, entryZ });
+    const float exit = std::min({ exitX, exitY, exitZ });
+    if (entry >= exit || entry < 0.0f || entry > 1.0f) {
+        return result; // 不相交、起始已重叠、或本帧位移内到不了
+    }
+
+    result.hit = true;
+    result.time = entry;
+    // 最晚进入的轴就是接触面所在的轴；恰好落在棱上时优先认为是Y轴（着陆/撞头）
+    if (entry == entryY) {
+        result.normal.y = displacement.y > 0.0f ? -1.0f : 1.0f;
+    }
+    else if (entry == entryX) {
+        result.normal.x = displacement.x > 0.0f ? -1.0f : 1.0f;
+    }
+    else {
+        result.normal.z = displacement.z > 0.0f ? -1.0f : 1.0f;
+    }
+    return result;
+}
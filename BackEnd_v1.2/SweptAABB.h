@@ -0,0 +1,16 @@
+// SweptAABB.h
+#pragma once
+
+#include "3DPos.h"
+
+// 扫掠AABB的求解结果
+struct SweepHit {
+    bool hit = false;
+    float time = 1.0f;   // 首次接触的时刻，用位移的比例表示，范围 [0, 1]
+    Struct3D normal;     // 接触面法线，指向移动物体一侧（只有一个分量非零）
+};
+
+// 连续碰撞检测：计算 moving 沿 displacement 平移的过程中与静止的 target 最早接触的时刻和法线
+// 使用分离轴上的进入/离开时刻（slab方法）求解，因此无论位移多大都不会穿过薄障碍物
+// 起始时已经重叠的情况不算命中，交给离散的重叠处理；仅擦边滑过（接触面平行于位移）也不算命中
+SweepHit SweepAABB(const AABB& moving, const Struct3D& displacement, const AABB& target);
@@ -0,0 +1,104 @@
+// TickScheduler.cpp
+
+#include "TickScheduler.h"
+#include <algorithm>
+
+TickScheduler::TickScheduler(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    // 0 号队列属于调用 RunBatch 的线程，只为其余队列创建后台线程
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers_.emplace_back(&TickScheduler::WorkerLoop, this, i);
+    }
+}
+
+TickScheduler::~TickScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    wakeWorkers_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void TickScheduler::RunBatch(size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+    currentTask_ = &task;
+    pending_.store(taskCount);
+
+    // 轮流分配到各个队列作为初始划分，之后的负载均衡交给窃取
+    const size_t queueCount = queues_.size();
+    for (size_t q = 0; q < queueCount && q < taskCount; ++q) {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        for (size_t i = q; i < taskCount; i += queueCount) {
+            queues_[q]->tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        ++batchGeneration_;
+    }
+    wakeWorkers_.notify_all();
+
+    Drain(0);
+
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    batchDone_.wait(lock, [this] { return pending_.load() == 0; });
+    currentTask_ = nullptr;
+}
+
+void TickScheduler::WorkerLoop(size_t self) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            wakeWorkers_.wait(lock, [&] { return stopping_ || batchGeneration_ != seenGeneration; });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = batchGeneration_;
+        }
+        Drain(self);
+    }
+}
+
+bool TickScheduler::TryTake(size_t self, size_t& task) {
+    {
+        WorkerQueue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    const size_t queueCount = queues_.size();
+    for (size_t offset = 1; offset < queueCount; ++offset) {
+        WorkerQueue& victim = *queues_[(self + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TickScheduler::Drain(size_t self) {
+    size_t task = 0;
+    while (TryTake(self, task)) {
+        (*currentTask_)(task);
+        if (pending_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            batchDone_.notify_all();
+        }
+    }
+}
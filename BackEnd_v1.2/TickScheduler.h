@@ -0,0 +1,54 @@
+// TickScheduler.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取(work-stealing)线程池，用于在多个核心上推进多个房间的逻辑帧
+// 每个线程有自己的任务队列：自己从队尾取，空闲线程从其他队列的队首窃取，
+// 这样负载不均（某些房间玩家多、障碍物多）时也能把工作摊开
+// 调用 RunBatch 的线程本身也作为 0 号工作线程参与执行，因此 threadCount = 1 时不创建后台线程
+class TickScheduler {
+public:
+    explicit TickScheduler(size_t threadCount);
+    ~TickScheduler();
+
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    // 对 [0, taskCount) 中的每个下标调用一次 task，阻塞直到全部完成
+    // 同一批次内每个下标只会被一个线程执行，批次之间按调用顺序串行
+    void RunBatch(size_t taskCount, const std::function<void(size_t)>& task);
+
+    size_t ThreadCount() const { return queues_.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void WorkerLoop(size_t self);
+    // 先从自己的队尾取任务，没有时依次从其他队列的队首窃取
+    bool TryTake(size_t self, size_t& task);
+    void Drain(size_t self);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    const std::function<void(size_t)>* currentTask_ = nullptr;
+    std::atomic<size_t> pending_{ 0 }; // 本批次尚未完成的任务数
+
+    std::mutex stateMutex_;
+    std::condition_variable wakeWorkers_;
+    std::condition_variable batchDone_;
+    uint64_t batchGeneration_ = 0; // 每个批次加一，唤醒后台线程
+    bool stopping_ = false;
+};
@@ -0,0 +1,163 @@
+// TickTimer.cpp
+
+#include "TickTimer.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace {
+    // 自旋等待时提示 CPU 降低功耗、让出流水线给同一核心上的另一个超线程
+    inline void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+}
+
+TickDeadlines::TickDeadlines(Clock::duration period, Clock::time_point start)
+    : period_(std::max<Clock::duration>(period, Clock::duration(1))),
+    next_(start + period_),
+    maxCatchUpTicks_(static_cast<uint32_t>(std::max<Clock::duration::rep>(1, MAX_TICK_CATCH_UP / period_))) {
+}
+
+TickDeadlines::TickStart TickDeadlines::Start(Clock::time_point now) {
+    TickStart start;
+    while (next_ <= now && start.ticks < maxCatchUpTicks_) {
+        next_ += period_;
+        ++start.ticks;
+    }
+    if (next_ <= now) {
+        next_ = now + period_;
+        start.clamped = true;
+    }
+    return start;
+}
+
+void TickJitterHistogram::Record(std::chrono::steady_clock::duration lateness) {
+    const double us = std::max(0.0, std::chrono::duration<double, std::micro>(lateness).count());
+    size_t bucket = 0;
+    while (bucket < BUCKET_LIMITS_US.size() && us > BUCKET_LIMITS_US[bucket]) {
+        ++bucket;
+    }
+    ++buckets_[bucket];
+    ++count_;
+    maxUs_ = std::max(maxUs_, us);
+}
+
+double TickJitterHistogram::PercentileUs(double p) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * static_cast<double>(count_) + 0.5));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_LIMITS_US.size(); ++bucket) {
+        seen += buckets_[bucket];
+        if (seen >= rank) {
+            return std::min<double>(BUCKET_LIMITS_US[bucket], maxUs_);
+        }
+    }
+    return maxUs_;
+}
+
+std::string TickJitterHistogram::Format() const {
+    std::string text;
+    char item[32];
+    for (size_t bucket = 0; bucket < buckets_.size(); ++bucket) {
+        if (buckets_[bucket] == 0) {
+            continue;
+        }
+        if (bucket < BUCKET_LIMITS_US.size()) {
+            std::snprintf(item, sizeof(item), "<=%uus:%llu", BUCKET_LIMITS_US[bucket], static_cast<unsigned long long>(buckets_[bucket]));
+        }
+        else {
+            std::snprintf(item, sizeof(item), ">%uus:%llu", BUCKET_LIMITS_US.back(), static_cast<unsigned long long>(buckets_[bucket]));
+        }
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += item;
+    }
+    return text;
+}
+
+std::chrono::microseconds ThreadCpuTime() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(ts.tv_nsec));
+    }
+#endif
+    return std::chrono::microseconds(0);
+}
+
+bool PinCurrentThreadToCpu(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+std::optional<TickPacerMode> ParseTickPacerMode(std::string_view name) {
+    if (name == "timer") return TickPacerMode::Timer;
+    if (name == "spin") return TickPacerMode::Spin;
+    return std::nullopt;
+}
+
+const char* TickPacerModeName(TickPacerMode mode) {
+    switch (mode) {
+    case TickPacerMode::Timer: return "timer";
+    case TickPacerMode::Spin: return "spin";
+    }
+    return "unknown";
+}
+
+TickTimer::TickTimer(asio::io_context& io_context, TickPacerMode mode, std::chrono::steady_clock::duration spinWindow)
+    : io_context_(io_context),
+    timer_(io_context),
+    mode_(mode),
+    spinWindow_(spinWindow) {
+}
+
+void TickTimer::WaitUntil(std::chrono::steady_clock::time_point deadline) {
+    if (mode_ == TickPacerMode::Timer) {
+        Sleep(deadline);
+        return;
+    }
+    // 先睡到截止时间前 spinWindow，再自旋到截止时间
+    Sleep(deadline - spinWindow_);
+    while (std::chrono::steady_clock::now() < deadline) {
+        CpuRelax();
+    }
+}
+
+void TickTimer::Sleep(std::chrono::steady_clock::time_point wake) {
+    if (std::chrono::steady_clock::now() >= wake) {
+        return;
+    }
+    bool expired = false;
+    timer_.expires_at(wake);
+    timer_.async_wait([&expired](const asio::error_code&) { expired = true; });
+    while (!expired) {
+        // 一次执行一个处理：收到的数据包立即处理，定时器到期后马上返回开始下一帧
+        if (io_context_.run_one() == 0) {
+            io_context_.restart(); // io_context 被停止过，恢复后继续等待
+        }
+    }
+}
@@ -0,0 +1,112 @@
+// TickTimer.h
+#pragma once
+
+#ifndef ASIO_STANDALONE
+#define ASIO_STANDALONE
+#endif
+#include <asio.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// 落后超过这么久时不再补帧，从当前时间重新对齐（与原先单帧时间最多 0.25 秒的限制作用相同）
+const auto MAX_TICK_CATCH_UP = std::chrono::milliseconds(250);
+
+// 主循环节拍的截止时间：第 k 帧应在 start + k × period 开始
+// 截止时间是绝对的，某一帧开始得晚不会把之后的帧一起推后，模拟时间与真实时间之间没有累积漂移
+class TickDeadlines {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct TickStart {
+        uint32_t ticks = 0;  // 已经到期的截止时间个数（正常为 1），本帧推进 ticks × period 的模拟时间
+        bool clamped = false; // 落后超过 MAX_TICK_CATCH_UP：多出的部分被丢弃，截止时间从 now 重新对齐
+    };
+
+    TickDeadlines(Clock::duration period, Clock::time_point start);
+
+    // 下一帧的截止时间
+    Clock::time_point Next() const { return next_; }
+    // 在 now 开始一帧，截止时间前移到 now 之后
+    TickStart Start(Clock::time_point now);
+    Clock::duration Period() const { return period_; }
+
+private:
+    Clock::duration period_;
+    Clock::time_point next_;
+    uint32_t maxCatchUpTicks_;
+};
+
+// 帧开始时间相对截止时间的延迟分布，按固定区间计数（微秒）
+class TickJitterHistogram {
+public:
+    // 各区间的上限，最后一个区间之外的延迟计入溢出区间
+    static constexpr std::array<uint32_t, 10> BUCKET_LIMITS_US = { 5, 10, 25, 50, 100, 250, 500, 1000, 2000, 5000 };
+
+    void Record(std::chrono::steady_clock::duration lateness);
+    void Reset() { *this = TickJitterHistogram(); }
+
+    uint64_t Count() const { return count_; }
+    double MaxUs() const { return maxUs_; }
+    // p 分位延迟所在区间的上限（落在溢出区间时为最大值）
+    double PercentileUs(double p) const;
+    // 非空区间的计数，形如 "<=5us:118 <=10us:2"
+    std::string Format() const;
+
+private:
+    std::array<uint64_t, BUCKET_LIMITS_US.size() + 1> buckets_ = {};
+    uint64_t count_ = 0;
+    double maxUs_ = 0.0;
+};
+
+// 当前线程占用的 CPU 时间（用户态 + 内核态），用于统计主循环的 CPU 占用；不支持的平台返回 0
+std::chrono::microseconds ThreadCpuTime();
+// 把当前线程绑定到第 cpu 个核心上（只在 Linux 上可用），失败时返回 false
+bool PinCurrentThreadToCpu(int cpu);
+
+// 等待截止时间的方式
+// Timer：阻塞在定时器上直到截止时间，空闲时不占用 CPU，帧开始时间取决于内核的唤醒延迟（通常几十到几百微秒）
+// Spin：定时器只等到截止时间前 spinWindow，剩下的时间在本线程上自旋读取 steady_clock，到点立即开始。
+//       用于对输入延迟敏感的房间：每帧多占用 spinWindow 的 CPU，最好配合把线程绑定到一个空闲核心上
+enum class TickPacerMode {
+    Timer,
+    Spin,
+};
+
+std::optional<TickPacerMode> ParseTickPacerMode(std::string_view name);
+const char* TickPacerModeName(TickPacerMode mode);
+
+// 自旋模式下默认的自旋时长：要覆盖绝大部分定时器唤醒延迟
+const auto DEFAULT_TICK_SPIN_WINDOW = std::chrono::microseconds(250);
+
+// 等待下一帧截止时间的定时器，基于 asio::steady_timer（Linux 上由 timerfd 实现，精度到微秒，
+// 不受 epoll_wait 毫秒超时的限制）
+// 等待期间 io_context 上就绪的处理（收包、会话清理等）在到达时立即执行，没有事件时线程阻塞在 epoll 中，不占用 CPU
+// 自旋模式下最后 spinWindow 不再运行 io_context：这段时间到达的数据包由帧开始时的 poll 处理，仍然赶得上本帧
+class TickTimer {
+public:
+    explicit TickTimer(asio::io_context& io_context, TickPacerMode mode = TickPacerMode::Timer,
+        std::chrono::steady_clock::duration spinWindow = DEFAULT_TICK_SPIN_WINDOW);
+
+    TickTimer(const TickTimer&) = delete;
+    TickTimer& operator=(const TickTimer&) = delete;
+
+    // 运行 io_context 直到 deadline；deadline 已过时立即返回
+    void WaitUntil(std::chrono::steady_clock::time_point deadline);
+
+    TickPacerMode Mode() const { return mode_; }
+    std::chrono::steady_clock::duration SpinWindow() const { return spinWindow_; }
+
+private:
+    // 阻塞在定时器上直到 wake
+    void Sleep(std::chrono::steady_clock::time_point wake);
+
+    asio::io_context& io_context_;
+    asio::steady_timer timer_;
+    TickPacerMode mode_;
+    std::chrono::steady_clock::duration spinWindow_;
+};
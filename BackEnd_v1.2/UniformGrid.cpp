@@ -0,0 +1,138 @@
+// UniformGrid.cpp
+
+#include "UniformGrid.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+    // 网格格子总数上限，防止地图范围很大而障碍物很小时内存爆掉
+    constexpr size_t MAX_GRID_CELLS = size_t{ 1 } << 21;
+}
+
+void UniformGrid::Clear() {
+    origin_ = {};
+    cellSize_ = 1.0f;
+    invCellSize_ = 1.0f;
+    dims_[0] = dims_[1] = dims_[2] = 0;
+    cellStart_.clear();
+    cellItems_.clear();
+}
+
+void UniformGrid::Build(const std::vector<AABB>& boxes, float cellSize) {
+    Clear();
+    if (boxes.empty()) {
+        return;
+    }
+
+    // 计算所有障碍物的总包围盒
+    AABB bounds = boxes.front();
+    float extentSum = 0.0f;
+    for (const auto& box : boxes) {
+        bounds.min.x = std::min(bounds.min.x, box.min.x);
+        bounds.min.y = std::min(bounds.min.y, box.min.y);
+        bounds.min.z = std::min(bounds.min.z, box.min.z);
+        bounds.max.x = std::max(bounds.max.x, box.max.x);
+        bounds.max.y = std::max(bounds.max.y, box.max.y);
+        bounds.max.z = std::max(bounds.max.z, box.max.z);
+        extentSum += std::max({ box.max.x - box.min.x, box.max.y - box.min.y, box.max.z - box.min.z });
+    }
+
+    // 自动选择格子尺寸：障碍物的平均最大边长，但不小于玩家尺寸
+    if (cellSize <= 0.0f) {
+        cellSize = std::max(extentSum / static_cast<float>(boxes.size()), GameConstants::PLAYER_WIDTH);
+    }
+
+    Struct3D extent = bounds.max - bounds.min;
+    auto countCells = [&](float size) {
+        return std::array<int, 3>{
+            std::max(1, static_cast<int>(std::ceil(extent.x / size))),
+            std::max(1, static_cast<int>(std::ceil(extent.y / size))),
+            std::max(1, static_cast<int>(std::ceil(extent.z / size)))
+        };
+    };
+    auto dims = countCells(cellSize);
+    // 格子过多时按比例放大格子尺寸
+    while (static_cast<size_t>(dims[0]) * dims[1] * dims[2] > MAX_GRID_CELLS) {
+        cellSize *= 1.5f;
+        dims = countCells(cellSize);
+    }
+
+    origin_ = bounds.min;
+    cellSize_ = cellSize;
+    invCellSize_ = 1.0f / cellSize;
+    dims_[0] = dims[0];
+    dims_[1] = dims[1];
+    dims_[2] = dims[2];
+
+    const size_t cellCount = static_cast<size_t>(dims_[0]) * dims_[1] * dims_[2];
+    cellStart_.assign(cellCount + 1, 0);
+
+    // 第一遍：统计每个格子的条目数
+    for (const auto& box : boxes) {
+        int x0, x1, y0, y1, z0, z1;
+        if (!CellRange(box.min.x, box.max.x, 0, x0, x1) ||
+            !CellRange(box.min.y, box.max.y, 1, y0, y1) ||
+            !CellRange(box.min.z, box.max.z, 2, z0, z1)) {
+            continue;
+        }
+        for (int cz = z0; cz <= z1; ++cz)
+            for (int cy = y0; cy <= y1; ++cy)
+                for (int cx = x0; cx <= x1; ++cx)
+                    ++cellStart_[CellIndex(cx, cy, cz) + 1];
+    }
+    // 前缀和得到每个格子的起始位置
+    for (size_t i = 1; i <= cellCount; ++i) {
+        cellStart_[i] += cellStart_[i - 1];
+    }
+
+    // 第二遍：填入障碍物下标
+    cellItems_.resize(cellStart_.back());
+    std::vector<uint32_t> cursor(cellStart_.begin(), cellStart_.end() - 1);
+    for (uint32_t index = 0; index < boxes.size(); ++index) {
+        const AABB& box = boxes[index];
+        int x0, x1, y0, y1, z0, z1;
+        if (!CellRange(box.min.x, box.max.x, 0, x0, x1) ||
+            !CellRange(box.min.y, box.max.y, 1, y0, y1) ||
+            !CellRange(box.min.z, box.max.z, 2, z0, z1)) {
+            continue;
+        }
+        for (int cz = z0; cz <= z1; ++cz)
+            for (int cy = y0; cy <= y1; ++cy)
+                for (int cx = x0; cx <= x1; ++cx)
+                    cellItems_[cursor[CellIndex(cx, cy, cz)]++] = index;
+    }
+}
+
+bool UniformGrid::CellRange(float minV, float maxV, int axis, int& first, int& last) const {
+    float originV = axis == 0 ? origin_.x : (axis == 1 ? origin_.y : origin_.z);
+    float lo = (minV - originV) * invCellSize_;
+    float hi = (maxV - originV) * invCellSize_;
+    // 先在浮点域里判断/夹取，避免超大坐标转换为int时溢出
+    if (!(hi >= 0.0f) || !(lo < static_cast<float>(dims_[axis]))) {
+        return false;
+    }
+    first = lo <= 0.0f ? 0 : static_cast<int>(lo);
+    last = std::min(dims_[axis] - 1, static_cast<int>(std::min(hi, static_cast<float>(dims_[axis] - 1))));
+    return first <= last;
+}
+
+void UniformGrid::Query(const AABB& box, std::vector<uint32_t>& out) const {
+    if (cellItems_.empty()) {
+        return;
+    }
+    int x0, x1, y0, y1, z0, z1;
+    if (!CellRange(box.min.x, box.max.x, 0, x0, x1) ||
+        !CellRange(box.min.y, box.max.y, 1, y0, y1) ||
+        !CellRange(box.min.z, box.max.z, 2, z0, z1)) {
+        return;
+    }
+    for (int cz = z0; cz <= z1; ++cz) {
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                size_t cell = CellIndex(cx, cy, cz);
+                out.insert(out.end(), cellItems_.begin() + cellStart_[cell], cellItems_.begin() + cellStart_[cell + 1]);
+            }
+        }
+    }
+}
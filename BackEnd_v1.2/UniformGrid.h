@@ -0,0 +1,39 @@
+// UniformGrid.h
+#pragma once
+
+#include "3DPos.h"
+#include <vector>
+#include <cstdint>
+
+// 均匀网格：静态障碍物的宽相位(broadphase)加速结构
+// 地图加载后构建一次，每个格子记录与其相交的障碍物下标
+// 使用CSR布局(cellStart_ + cellItems_)存储，查询时不分配内存
+class UniformGrid {
+public:
+    // 根据障碍物列表构建网格。cellSize <= 0 时根据障碍物平均尺寸自动选择
+    void Build(const std::vector<AABB>& boxes, float cellSize = 0.0f);
+    void Clear();
+
+    // 将与 box 所覆盖格子相关的障碍物下标追加到 out 中
+    // 跨越多个格子的障碍物会被重复追加，由调用方去重
+    void Query(const AABB& box, std::vector<uint32_t>& out) const;
+
+    bool Empty() const { return cellItems_.empty(); }
+    float CellSize() const { return cellSize_; }
+    size_t CellCount() const { return cellStart_.empty() ? 0 : cellStart_.size() - 1; }
+
+private:
+    // 把世界坐标范围 [minV, maxV] 转换为某个轴上被夹取后的格子坐标范围
+    // 完全落在网格外时返回 false
+    bool CellRange(float minV, float maxV, int axis, int& first, int& last) const;
+    size_t CellIndex(int cx, int cy, int cz) const {
+        return (static_cast<size_t>(cz) * dims_[1] + cy) * dims_[0] + cx;
+    }
+
+    Struct3D origin_;          // 网格最小角
+    float cellSize_ = 1.0f;
+    float invCellSize_ = 1.0f;
+    int dims_[3] = { 0, 0, 0 }; // 各轴格子数
+    std::vector<uint32_t> cellStart_; // 大小为格子数+1，第i个格子的条目区间为 [cellStart_[i], cellStart_[i+1])
+    std::vector<uint32_t> cellItems_; // 按格子连续存放的障碍物下标
+};
@@ -1,129 +1,370 @@
 // main.cpp
 
-#include "AsioNetworkManager.h"            // ʹûAsio
-#include "GameHandler.h"        // Ϸ߼
-#include <chrono>               // ʱ
-#include <thread>               // ߳ (std::this_thread::sleep_for)LLM飩
+#include "AsioNetworkManager.h"            // 使用基于Asio的网络管理器
+#include "GameHandler.h"        // 包含游戏逻辑处理器
+#include "ServerConfig.h"       // 命令行参数
+#include "Room.h"               // 多房间：每个房间一个 GameHandler
+#include "TickScheduler.h"      // 推进房间的工作窃取线程池
+#include "TickTimer.h"          // 主循环节拍：绝对截止时间与定时器
+#include "Logger.h"             // 异步日志
+#include <algorithm>
+#include <atomic>
+#include <chrono>               // 用于时间计算
+#include <cstdlib>
+#include <thread>               // 用于线程休眠 (std::this_thread::sleep_for)（LLM建议）
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <vector>
 
-// Ķ˿ں
+// 定义服务器监听的端口号
 constexpr short SERVER_PORT = 12034;
-// ĿϷ߼Ƶ (磬ÿ 60 )
-constexpr float TARGET_UPDATES_PER_SECOND = 60.0f;
-// ÿι̶µʱ䲽 (delta time)
-constexpr float TARGET_DELTA_TIME = 1.0f / TARGET_UPDATES_PER_SECOND;
 
-int main() {
-    try {
-        // 1.ʼAsio
-        // AsioĺI/OĶ󣬸첽
+namespace {
+    // 一组房间及服务它们的网络管理器，整组由同一个线程驱动
+    // 普通模式下只有一组：包含全部房间，房间 i 有自己的网络管理器，监听 SERVER_PORT + i
+    // 分片模式(--shards)下每个分片一组：分片自己的 io_context、一个绑定 SERVER_PORT 的 SO_REUSEPORT 套接字和分到的房间，
+    // 在自己的线程上运行。内核按客户端地址把数据报固定分给某个分片的套接字，客户端的房间也属于该分片，
+    // 因此接收、推进、发送全程只在分片线程内进行，分片之间不共享可变状态，不需要加锁
+    // 代价是客户端不能选择房间：分片由地址哈希决定，再分到分片内会话最少的房间（普通模式下按端口选择房间和地图）
+    struct ServerShard {
+        size_t id = 0;
         asio::io_context io_context;
-        // 2. ʼϷ߼
-        GameHandler gameHandler;
-        // 3. ʼ
-        // ʹstd::make_sharedAsioNetworkManagerĹָ룬첽(ͨweak_ptr/shared_ptr)
-        //  io_context, ˿ں, Լ gameHandler ôݸ캯
-        auto networkManager = std::make_shared<AsioNetworkManager>(io_context, SERVER_PORT, gameHandler);
-        // Ƿɹʼ (˿Ƿռ֮)
-        if (!networkManager->IsInitialized()) {
-            std::cerr << "[Main] Error: Network manager failed to initialize. Exiting." << std::endl;
-            return 1; // ʼʧܣ˳
-        }
-
-        std::cout << "\n[Main] Backend server started using Asio." << std::endl;
-        std::cout << "[Main] Waiting for messages on UDP port " << SERVER_PORT << "..." << std::endl;
-        // 4. 
-        // StartReceive()ʼ첽Կͻ˵ϢأʵʵĽշio_contextĺ̨
-        networkManager->StartReceive();
-        // 5. ʼѭ
-        // ڴ洢һЧͨŵĿͻ˶˵Ϣ
-        std::optional<asio::ip::udp::endpoint> last_client_endpoint;
-        // ѭļʱ
-        auto last_update_time = std::chrono::high_resolution_clock::now(); // ϴθµʱ
-        float accumulator = 0.0f; // ʱۼ洢ϴθʱ
-
-        // 6. ѭ
-        while (true) { // ѭֱж
-            // ֡ʱ
-            auto current_time = std::chrono::high_resolution_clock::now(); // ȡǰʱ
-            // ϴѭʱ
-            std::chrono::duration<float> frame_duration = current_time - last_update_time;
-            last_update_time = current_time;                               // ϴʱ
-            float frame_time = frame_duration.count();                     // ȡʾ֡ʱ
-            // Ƶ֡ʱ䣬ۼ˵һִд
-            if (frame_time > 0.25f) {
-                frame_time = 0.25f;
-                std::cerr << "[Main] Warning: Frame time > 0.25s, clamping." << std::endl;
+        std::vector<Room*> rooms;
+        std::vector<std::shared_ptr<AsioNetworkManager>> networkManagers;
+        // 第 i 个房间由哪个网络管理器服务，以及它在该网络管理器房间列表中的下标
+        std::vector<std::pair<AsioNetworkManager*, size_t>> roomNetworks;
+    };
+
+    // 在分片线程、网络线程上遇到致命错误时结束进程
+    // 先停止日志写线程并写出缓冲区中的日志：否则 exit 析构仍可结合(joinable)的写线程会调用 std::terminate，进程异常终止且日志丢失
+    // 多个线程同时出错时只有第一个执行退出，其余的停在这里等进程结束
+    [[noreturn]] void ExitOnFatalError() {
+        static std::atomic<bool> exiting{ false };
+        if (exiting.exchange(true)) {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+        }
+        Log::Stop();
+        std::exit(1);
+    }
+
+    // 运行 io_context 的网络线程；析构时（主循环因异常退出）停止 io_context 并等待线程结束
+    class NetworkThread {
+    public:
+        NetworkThread(asio::io_context& io_context, size_t shardId)
+            : io_context_(io_context),
+            thread_([this, shardId] {
+                try {
+                    auto work = asio::make_work_guard(io_context_);
+                    io_context_.run();
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "[Main] Fatal Error: Network thread of shard " << shardId << " stopped: " << e.what() << std::endl;
+                    ExitOnFatalError();
+                }
+            }) {}
+
+        ~NetworkThread() {
+            io_context_.stop();
+            thread_.join();
+        }
+
+        NetworkThread(const NetworkThread&) = delete;
+        NetworkThread& operator=(const NetworkThread&) = delete;
+
+    private:
+        asio::io_context& io_context_;
+        std::thread thread_;
+    };
+
+    // 主循环：处理网络事件、推进房间、发送状态，不会返回
+    // 网络线程模式(--net-thread)下 io_context 由单独的网络线程运行，本循环只通过网络管理器的无锁队列取输入、交出状态，
+    // 收包突发时的处理开销不再落在逻辑帧上
+    void RunServerLoop(ServerShard& shard, TickScheduler& scheduler, const ServerConfig& config, float targetDeltaTime) {
+        asio::io_context& io_context = shard.io_context;
+        std::vector<Room*>& rooms = shard.rooms;
+        std::vector<std::shared_ptr<AsioNetworkManager>>& networkManagers = shard.networkManagers;
+
+        // 启动网络接收
+        // 调用StartReceive()开始异步监听来自客户端的消息，这里会立即返回，实际的接收发生在io_context的后台
+        // 超时会话由网络管理器每秒自行清理，释放它们的玩家槽位
+        for (auto& networkManager : networkManagers) {
+            networkManager->StartReceive();
+            networkManager->StartSessionSweep();
+        }
+        // 接收缓冲区池在 StartReceive 时按收发方式分配，此时才能得到每个套接字占用的内存
+        LOG_INFO("[Main] Shard %zu: %zu socket(s), %.1f KiB network memory per socket (receive pool %.1f KiB).", shard.id,
+            networkManagers.size(), networkManagers.front()->MemoryFootprint() / 1024.0, networkManagers.front()->ReceivePoolBytes() / 1024.0);
+        std::optional<NetworkThread> networkThread;
+        if (config.networkThread) {
+            networkThread.emplace(io_context, shard.id);
+        }
+        // 主循环节拍：第 k 帧在 start + k × 步长开始（绝对截止时间），由定时器唤醒，不再 poll + 休眠 1 毫秒
+        // 两帧之间线程阻塞在 tick_timer 上：普通模式下等待的就是 io_context，数据包在到达时立即处理，没有事件时不占用 CPU；
+        // 网络线程模式下 io_context 由网络线程运行，本线程只等待一个私有 io_context 上的定时器
+        // --pacer=spin 时定时器只等到截止时间前 --spin-window，剩下的时间自旋，帧开始时间不再受内核唤醒延迟影响
+        asio::io_context tick_io_context;
+        TickTimer tick_timer(networkThread ? tick_io_context : io_context, config.tickPacer,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(config.spinWindowUs)));
+        // 把主循环线程绑定到指定核心（推进房间的工作线程不绑定）
+        if (!config.pinCpus.empty()) {
+            const int cpu = config.pinCpus[shard.id % config.pinCpus.size()];
+            if (PinCurrentThreadToCpu(cpu)) {
+                LOG_INFO("[Main] Shard %zu tick thread pinned to CPU %d.", shard.id, cpu);
             }
-            // ֡ʱۼӵۼ
-            accumulator += frame_time;
-            // ¼
-            // io_context.poll() еǰѾ첽¼GameHandler::ProcessInputܻᱻãgameHandler״̬
-            io_context.poll();
-            // ȡͻ˵ַ
-            // NetworkManagerȡһγɹյϢĿͻ˵ַԺϷ״̬»ȥ
-            last_client_endpoint = networkManager->GetLastClientEndpoint();
-            // ̶ʱ䲽Ϸ߼
-            // ʹwhileѭȷʹ֡ʲϷ߼ҲԽӽ㶨ʸ
-            while (accumulator >= TARGET_DELTA_TIME) {
-                // ۼӵʱ㹻һι̶ĸ
-                //  GameHandler::Update()̶ʱ䲽 TARGET_DELTA_TIME
-                gameHandler.Update(TARGET_DELTA_TIME);
-                // ۼмȥһʱ
-                accumulator -= TARGET_DELTA_TIME;
+            else {
+                LOG_WARN("[Main] Warning: Failed to pin the tick thread of shard %zu to CPU %d.", shard.id, cpu);
             }
-            // ѭaccumulator ʣµǲһʱ䣬ۼӵһ֡
-            // Ϸ״̬ؿͻˡǷ֪Ҫĸͻ˷״̬ (ǷյЧϢ)
-            if (last_client_endpoint) {
-                // л
-                // GameHandlerȡǰ״̬лĶ
-                std::optional<std::string> state_data = gameHandler.GetStateDataForNetwork();
-                // лǷɹ
-                if (state_data) {
-                    // ɹNetworkManagerSendTo첽
-                    networkManager->SendTo(*state_data, *last_client_endpoint);
-                    // ע⣡ûƵƣܻԷǳߵƵʷ״̬ҪҪƷʡ
+        }
+        const auto tick_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(targetDeltaTime));
+        TickDeadlines deadlines(tick_period, std::chrono::steady_clock::now());
+        // 统计：帧开始时间相对截止时间的延迟分布，以及本线程的 CPU 占用
+        TickJitterHistogram tick_jitter;
+        auto last_stats_time = std::chrono::steady_clock::now();         // 上次打印房间统计的时间点
+        auto last_stats_cpu = ThreadCpuTime();                           // 上次打印统计时本线程的 CPU 时间
+        std::vector<uint64_t> last_received(networkManagers.size(), 0);  // 上次打印统计时各套接字收到的数据包数
+
+        while (true) { // 循环直到程序被中断
+            // 等到本帧的截止时间
+            const auto deadline = deadlines.Next();
+            tick_timer.WaitUntil(deadline);
+            const auto current_time = std::chrono::steady_clock::now();
+            tick_jitter.Record(current_time - deadline);
+            // 本帧推进的时间为到期的步长个数 × 步长（正常为一个步长），每个房间恰好执行对应次数的固定步长更新
+            // 落后太多时（例如进程被挂起）不再补帧，避免累加器爆了导致一次性执行大量更新
+            const TickDeadlines::TickStart tick = deadlines.Start(current_time);
+            if (tick.clamped) {
+                LOG_WARN_RATE(1, "[Main] Warning: Frame time > 0.25s, clamping.");
+            }
+            const float frame_time = static_cast<float>(tick.ticks) * targetDeltaTime;
+            // 处理网络事件
+            // 调用io_context.poll() 来处理等待期间最后到达、尚未执行的完成事件。GameHandler::ProcessInput可能会被调用，更新各房间的输入状态。
+            // 网络事件只在驱动这组房间的线程上处理，并且与房间推进分阶段进行，因此 GameHandler 不需要加锁
+            // 网络线程模式下改为取出网络线程放进队列的加入/离开/输入事件，同样在推进之前、本线程上作用到 GameHandler
+            if (networkThread) {
+                for (auto& networkManager : networkManagers) {
+                    networkManager->DrainEvents();
                 }
-                else {
-                    // лʧܣӡ
-                    std::cerr << "[Main] Warning: Failed to serialize state, not sending update." << std::endl;
+            }
+            else {
+                io_context.poll();
+            }
+            // 固定时间步长更新游戏逻辑
+            // 每个房间把本帧经过的时间累加到自己的累加器中，并执行所有完整的固定步长更新
+            // 剩下的不足一个步长的时间会累加到下一帧；RunBatch 返回时所有房间都已推进完毕
+            scheduler.RunBatch(rooms.size(), [&](size_t i) {
+                rooms[i]->Advance(frame_time);
+            });
+            // 把每个客户端自己的玩家状态发回给它
+            // 发送频率由广播调度控制（--send-rate），与主循环频率无关：状态没变时跳过，胜利等事件立即发送
+            // 普通模式下 GameHandler 把状态直接序列化到网络层发送缓冲区池中的缓冲区再发送；网络线程模式下序列化进快照队列，由网络线程发送
+            const auto broadcast_time = std::chrono::steady_clock::now();
+            for (auto& networkManager : networkManagers) {
+                networkManager->BroadcastStates(broadcast_time);
+            }
+
+            // 定期打印各房间的逻辑帧耗时
+            if (config.roomStatsInterval > 0.0f) {
+                std::chrono::duration<float> since_stats = current_time - last_stats_time;
+                if (since_stats.count() >= config.roomStatsInterval) {
+                    last_stats_time = current_time;
+                    for (size_t i = 0; i < rooms.size(); ++i) {
+                        Room* room = rooms[i];
+                        const RoomTickStats& stats = room->TickStats();
+                        const auto [network, networkRoom] = shard.roomNetworks[i];
+                        LOG_INFO("[Main] Room %zu: %zu clients, %llu ticks, avg %.1f us, max %.1f us, last %.1f us", room->Id(),
+                            network->RoomSessionCount(networkRoom),
+                            static_cast<unsigned long long>(stats.tickCount), stats.averageTickUs, stats.maxTickUs, stats.lastTickUs);
+                        room->ResetTickStats();
+                        // 状态广播：每个客户端每秒收到的状态数、带宽，以及广播在本线程上花的时间
+                        const BroadcastStats broadcast = network->TakeBroadcastStats(networkRoom);
+                        const double clients = static_cast<double>(std::max<size_t>(1, network->RoomSessionCount(networkRoom)));
+                        const double seconds = since_stats.count();
+                        LOG_INFO("[Main] Room %zu broadcast: %.1f states/s, %.2f KB/s, %.1f us CPU/s per client; %llu event sends, %llu deltas, %llu unchanged skipped",
+                            room->Id(), broadcast.sent / seconds / clients, broadcast.bytes / 1024.0 / seconds / clients,
+                            broadcast.cpuUs / seconds / clients, static_cast<unsigned long long>(broadcast.eventSent),
+                            static_cast<unsigned long long>(broadcast.deltaSent), static_cast<unsigned long long>(broadcast.skippedUnchanged));
+                    }
+                    // 主循环：CPU 占用与帧开始延迟分布
+                    const auto cpu = ThreadCpuTime();
+                    LOG_INFO("[Main] Shard %zu loop: %.1f%% CPU, tick start jitter p50 <=%.0f us, p99 <=%.0f us, max %.0f us (%s)", shard.id,
+                        std::chrono::duration<double>(cpu - last_stats_cpu).count() * 100.0 / since_stats.count(),
+                        tick_jitter.PercentileUs(0.5), tick_jitter.PercentileUs(0.99), tick_jitter.MaxUs(), tick_jitter.Format().c_str());
+                    last_stats_cpu = cpu;
+                    tick_jitter.Reset();
+                    // 各套接字每秒收到并解析的数据包数
+                    for (size_t n = 0; n < networkManagers.size(); ++n) {
+                        const uint64_t received = networkManagers[n]->ReceivedPacketCount();
+                        LOG_INFO("[Main] Shard %zu socket %zu: %.0f packets/s received", shard.id, n,
+                            (received - last_received[n]) / since_stats.count());
+                        last_received[n] = received;
+                    }
                 }
             }
+        }
+    }
+}
 
-            // ֹCPUæ
-            // ѭе÷ǳͶһСʱ䣬CPUʱø̣ת˷Դ
-            auto loop_end_time = std::chrono::high_resolution_clock::now();            // ȡѭʱ
-            std::chrono::duration<float> loop_duration = loop_end_time - current_time; // 㱾ѭʱ
-            // 򵥵ۼСұѭʱҲܶ
-            if (accumulator < TARGET_DELTA_TIME / 2.0f && loop_duration.count() < (TARGET_DELTA_TIME / 2.0f)) {
-                // 1
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+int main(int argc, char* argv[]) {
+    try {
+        // 0. 解析命令行参数
+        ServerConfig config = ParseServerConfig(argc, argv);
+        // 启动后台日志写线程，主循环和网络回调中的日志不再同步写控制台
+        Log::SetLevel(config.logLevel);
+        Log::ScopedWriter logWriter;
+        // 目标游戏逻辑更新频率由 --tick-rate 指定 (默认每秒 60 次)
+        // 计算出每次固定更新的时间步长 (delta time)
+        const float targetDeltaTime = 1.0f / config.tickRate;
+        // 1. 初始化各个房间的游戏逻辑处理器
+        // 每个房间是一个独立的关卡实例
+        std::vector<std::unique_ptr<Room>> rooms;
+        for (size_t i = 0; i < config.roomCount; ++i) {
+            const std::string& mapFile = config.mapFiles.empty()
+                ? GameConstants::DEFAULT_MAP_FILE
+                : config.mapFiles[i % config.mapFiles.size()];
+            auto room = std::make_unique<Room>(i, mapFile, targetDeltaTime);
+            room->Game().SetBroadphaseMode(config.broadphase);
+            room->Game().SetContinuousCollision(config.continuousCollision);
+            room->Game().SetMapHotReload(config.mapHotReload);
+            rooms.push_back(std::move(room));
+        }
+
+        // 2. 把房间分组，并初始化Asio与网络管理器
+        // 每组有自己的io_context（Asio的核心I/O上下文对象，负责调度所有异步操作）
+        // 使用std::make_shared创建AsioNetworkManager的共享指针，将其生命周期与异步操作绑定(通过weak_ptr/shared_ptr)
+        const bool sharded = config.shardCount > 0;
+        std::vector<std::unique_ptr<ServerShard>> shards;
+        if (sharded) {
+            // 分片模式：房间 i 属于分片 i % K，每个分片一个绑定 SERVER_PORT 的 SO_REUSEPORT 套接字，服务自己的全部房间
+            for (size_t s = 0; s < config.shardCount; ++s) {
+                auto shard = std::make_unique<ServerShard>();
+                shard->id = s;
+                std::vector<NetworkRoom> networkRooms;
+                for (size_t i = s; i < rooms.size(); i += config.shardCount) {
+                    shard->rooms.push_back(rooms[i].get());
+                    networkRooms.push_back({ rooms[i]->Id(), &rooms[i]->Game() });
+                }
+                auto networkManager = std::make_shared<AsioNetworkManager>(shard->io_context, SERVER_PORT, std::move(networkRooms), true);
+                for (size_t r = 0; r < shard->rooms.size(); ++r) {
+                    shard->roomNetworks.emplace_back(networkManager.get(), r);
+                }
+                shard->networkManagers.push_back(std::move(networkManager));
+                shards.push_back(std::move(shard));
+            }
+        }
+        else {
+            // 普通模式：房间 i 监听 SERVER_PORT + i，客户端协议不变
+            auto shard = std::make_unique<ServerShard>();
+            for (auto& room : rooms) {
+                const short port = static_cast<short>(SERVER_PORT + room->Id());
+                shard->rooms.push_back(room.get());
+                shard->networkManagers.push_back(std::make_shared<AsioNetworkManager>(shard->io_context, port,
+                    std::vector<NetworkRoom>{ { room->Id(), &room->Game() } }));
+                shard->roomNetworks.emplace_back(shard->networkManagers.back().get(), 0);
+            }
+            shards.push_back(std::move(shard));
+        }
+        bool ioUring = config.ioUring;
+        for (auto& shard : shards) {
+            for (auto& networkManager : shard->networkManagers) {
+                networkManager->SetReceiveDepth(config.receiveDepth);
+                networkManager->SetBatchedIo(config.batchedIo);
+                if (config.ioUring) {
+                    ioUring = networkManager->SetIoUring(true) && ioUring; // 失败时已打印原因，退回 asio
+                }
+                networkManager->SetNetworkThread(config.networkThread);
+                networkManager->SetSendRate(config.sendRate);
+                // 检查网络管理器是否成功初始化 (端口是否被占用之类的)
+                if (!networkManager->IsInitialized()) {
+                    LOG_ERROR("[Main] Error: Network manager for shard %zu failed to initialize. Exiting.", shard->id);
+                    return 1; // 初始化失败，程序退出
+                }
             }
         }
 
+        // 房间由工作窃取线程池并行推进；线程数不超过房间数
+        // 分片模式下每个分片线程推进自己的房间，线程数在各分片之间平分
+        size_t threadCount = config.threadCount != 0 ? config.threadCount : std::thread::hardware_concurrency();
+        const size_t threadsPerShard = std::max<size_t>(1, threadCount / shards.size());
+
+        LOG_INFO("\n[Main] Backend server started using Asio.");
+        LOG_INFO("[Main] Network I/O: %s, %s",
+            ioUring ? "io_uring (multishot recvmsg, one submit per tick)" : (config.batchedIo ? "batched (recvmmsg/sendmmsg)" : "async"),
+            config.networkThread ? "dedicated network thread per shard" : "on the tick thread");
+        LOG_INFO("[Main] State broadcast: up to %.0f Hz per client, changed states and events only.", config.sendRate);
+        if (config.tickPacer == TickPacerMode::Spin) {
+            LOG_INFO("[Main] Tick pacer: spin (timer until %.0f us before each tick, then spin on steady_clock).", config.spinWindowUs);
+        }
+        else {
+            LOG_INFO("[Main] Tick pacer: timer (blocks until each tick deadline).");
+        }
+        if (sharded) {
+            LOG_INFO("[Main] Hosting %zu room(s) on %zu shard(s), %zu thread(s) per shard.", rooms.size(), shards.size(), threadsPerShard);
+            LOG_INFO("[Main] Waiting for messages on UDP port %d (SO_REUSEPORT, %zu sockets)...", SERVER_PORT, shards.size());
+            if (config.mapFiles.size() > 1) {
+                LOG_WARN("[Main] Warning: With --shards, clients are placed by address hash into the least-loaded room of a shard; they cannot choose a room or map from --maps.");
+            }
+        }
+        else if (rooms.size() > 1) {
+            LOG_INFO("[Main] Hosting %zu room(s) on %zu thread(s).", rooms.size(), std::clamp<size_t>(threadCount, 1, rooms.size()));
+            LOG_INFO("[Main] Waiting for messages on UDP ports %d-%d...", SERVER_PORT, static_cast<int>(SERVER_PORT + rooms.size() - 1));
+        }
+        else {
+            LOG_INFO("[Main] Hosting %zu room(s) on %zu thread(s).", rooms.size(), std::clamp<size_t>(threadCount, 1, rooms.size()));
+            LOG_INFO("[Main] Waiting for messages on UDP port %d...", SERVER_PORT);
+        }
+
+        // 3. 主循环
+        if (!sharded) {
+            TickScheduler scheduler(std::clamp<size_t>(threadCount, 1, rooms.size()));
+            RunServerLoop(*shards.front(), scheduler, config, targetDeltaTime);
+        }
+        else {
+            // 分片 0 由主线程驱动，其余分片各自一个线程。某个分片出错时整个进程退出，不让其余分片继续使用已失效的状态
+            auto runShard = [&](size_t s) {
+                try {
+                    TickScheduler scheduler(std::min(threadsPerShard, shards[s]->rooms.size()));
+                    RunServerLoop(*shards[s], scheduler, config, targetDeltaTime);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "[Main] Fatal Error: Shard " << s << " stopped: " << e.what() << std::endl;
+                    ExitOnFatalError();
+                }
+            };
+            std::vector<std::thread> shardThreads;
+            for (size_t s = 1; s < shards.size(); ++s) {
+                shardThreads.emplace_back(runShard, s);
+            }
+            runShard(0);
+        }
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << "[Main] Invalid argument: " << e.what() << std::endl;
+        PrintServerUsage(argv[0]);
+        return 1;
     }
-    // catchģ鲶˿ռô
+    // 增加catch模块捕获端口占用错误
     catch (const std::runtime_error& e) {
         std::cerr << "[Main] Runtime Error: " << e.what() << std::endl;
-        std::cerr << "Please ensure that port " << SERVER_PORT << " is not in use by another application." << std::endl;
+        std::cerr << "Please ensure that port " << SERVER_PORT << " (and port+i for room i) is not in use by another application." << std::endl;
         return 1;
     }
     catch (const std::exception& e) {
-        // ׼⼰Asio׳쳣 (˿ڰʧ)
+        // 捕获标准库及Asio可能抛出的异常 (端口绑定失败)
         std::cerr << "[Main] Fatal Error: Exception caught: " << e.what() << std::endl;
-        return 1; // طʾ˳
+        return 1; // 返回非零表示错误退出
     }
     catch (...) {
-        // ͵δ֪쳣
+        // 捕获所有其他类型的未知异常
         std::cerr << "[Main] Fatal Error: Unknown exception caught." << std::endl;
         return 1;
     }
 
-    // ϲִеѭĳַʽж
+    // 理论上不会执行到这里，除非循环被某种方式中断
     std::cout << "[Main] Server shutting down." << std::endl;
-    //  main ʱnetworkManager(shared_ptr)Զ٣
-    // ḺرsocketԴ(AsioԶ)
-    return 0; // ˳
-}
\ No newline at end of file
+    // 当 main 函数结束时，networkManager(shared_ptr)会自动销毁，
+    // 其析构函数会负责关闭socket和清理资源(Asio对象自动管理)。
+    return 0; // 正常退出
+}